@@ -167,6 +167,7 @@ struct CODEC2 * codec2_create(int mode)
     c2->prev_f0_enc = 1/P_MAX_S;
     c2->bg_est = 0.0;
     c2->ex_phase = 0.0;
+    c2->rand_seed = 1;
 
     for(l=1; l<=MAX_AMP; l++)
 	c2->prev_model_dec.A[l] = 0.0;
@@ -1179,7 +1180,7 @@ void codec2_encode_1300(struct CODEC2 *c2, unsigned char * bits, short speech[])
   Decodes frames of 52 bits into 320 samples (40ms) of speech.
 
 \*---------------------------------------------------------------------------*/
-static int frames;
+
 void codec2_decode_1300(struct CODEC2 *c2, short speech[], const unsigned char * bits, float ber_est)
 {
     MODEL   model[4];
@@ -1196,7 +1197,6 @@ void codec2_decode_1300(struct CODEC2 *c2, short speech[], const unsigned char *
     PROFILE_VAR(recover_start);
 
     assert(c2 != NULL);
-    frames+= 4;
     /* only need to zero these out due to (unused) snr calculation */
 
     for(i=0; i<4; i++)
@@ -2365,17 +2365,17 @@ void synthesise_one_frame(struct CODEC2 *c2, short speech[], MODEL *model, COMP
     if (c2->mode == CODEC2_MODE_700C ||c2->mode == CODEC2_MODE_450 ||c2->mode == CODEC2_MODE_450PWB  ) {
         /* newamp1/2, we've already worked out rate L phase */
         COMP *H = Aw;
-        phase_synth_zero_order(c2->n_samp, model, &c2->ex_phase, H);       
+        phase_synth_zero_order(c2->n_samp, model, &c2->ex_phase, H, &c2->rand_seed);       
     } else {
         /* LPC based phase synthesis */
         COMP H[MAX_AMP+1];
         sample_phase(model, H, Aw);
-        phase_synth_zero_order(c2->n_samp, model, &c2->ex_phase, H);
+        phase_synth_zero_order(c2->n_samp, model, &c2->ex_phase, H, &c2->rand_seed);
     }
 
     PROFILE_SAMPLE_AND_LOG(pf_start, phase_start, "    phase_synth");
 
-    postfilter(model, &c2->bg_est);
+    postfilter(model, &c2->bg_est, &c2->rand_seed);
 
     PROFILE_SAMPLE_AND_LOG(synth_start, pf_start, "    postfilter");
 
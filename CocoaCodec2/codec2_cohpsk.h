@@ -68,4 +68,8 @@ float *cohpsk_get_rx_bits_lower(struct COHPSK *coh);
 float *cohpsk_get_rx_bits_upper(struct COHPSK *coh);
 void cohpsk_set_carrier_ampl(struct COHPSK *coh, int c, float ampl);
 
+/* carrier frequencies in Hz, freq_hz[] must hold COHPSK_NC*COHPSK_ND */
+
+int cohpsk_get_carrier_freqs(struct COHPSK *coh, float freq_hz[]);
+
 #endif
@@ -57,6 +57,7 @@ extern "C" {
 
 #include "comp.h"
 #include "modem_stats.h"
+#include "modem_io.h"
 
 #define FDMDV_NC                      14  /* default number of data carriers                                */
 #define FDMDV_NC_MAX                  20  /* maximum number of data carriers                                */
@@ -83,9 +84,12 @@ void           fdmdv_use_old_qpsk_mapping(struct FDMDV *fdmdv_state);
 int            fdmdv_bits_per_frame(struct FDMDV *fdmdv_state);
 float          fdmdv_get_fsep(struct FDMDV *fdmdv_state);
 void           fdmdv_set_fsep(struct FDMDV *fdmdv_state, float fsep);
+int            fdmdv_get_carrier_freqs(struct FDMDV *fdmdv_state, float freq_hz[]);
 
 void           fdmdv_mod(struct FDMDV *fdmdv_state, COMP tx_fdm[], int tx_bits[], int *sync_bit);
 void           fdmdv_demod(struct FDMDV *fdmdv_state, int rx_bits[], int *reliable_sync_bit, COMP rx_fdm[], int *nin);
+void           fdmdv_demod_io(struct FDMDV *fdmdv_state, int rx_bits[], int *reliable_sync_bit,
+                              const void *rx_fdm, const struct MODEM_IO *io, int *nin);
 
 void           fdmdv_get_test_bits(struct FDMDV *fdmdv_state, int tx_bits[]);
 int            fdmdv_error_pattern_size(struct FDMDV *fdmdv_state);
@@ -99,6 +103,8 @@ void           fdmdv_16_to_8(float out8k[], float in16k[], int n);
 void           fdmdv_16_to_8_short(short out8k[], short in16k[], int n);
 
 void           fdmdv_freq_shift(COMP rx_fdm_fcorr[], COMP rx_fdm[], float foff, COMP *foff_phase_rect, int nin);
+void           fdmdv_freq_shift_io(COMP rx_fdm_fcorr[], const void *rx_fdm, const struct MODEM_IO *io, float foff,
+                                   COMP *foff_phase_rect, int nin);
 
 /* debug/development function(s) */
 
@@ -29,6 +29,8 @@
 #define __CODEC2_FM__
 
 #include "comp.h"
+#include "filter.h"
+#include "kiss_fft.h"
 
 struct FM {
     float  Fs;               /* setme: sample rate                  */
@@ -36,16 +38,28 @@ struct FM {
     float  fd;               /* setme: maximum deviation            */
     float  fc;               /* setme: carrier frequency            */
     COMP  *rx_bb;
+    struct quisk_cfFilter rx_bb_filt;  /* input FIR filter           */
     COMP   rx_bb_filt_prev;
-    float *rx_dem_mem;
     float  tx_phase;
     int    nsam;
     COMP   lo_phase;
+
+    /* fm_set_fast_demod() states, NULL when the direct demod is used */
+
+    COMP  *lo_table;         /* lo_table[i] = exp(-j*wc*(i+1))      */
+    float  lo_table_wc;      /* wc lo_table was built for           */
+    kiss_fft_cfg fwd_cfg;
+    kiss_fft_cfg inv_cfg;
+    COMP  *os_H;             /* FFT of input FIR filter, scaled     */
+    COMP  *os_in;            /* filter history then new samples     */
+    COMP  *os_freq;
+    COMP  *os_out;
 };
 
 struct FM *fm_create(int nsam);
 void fm_destroy(struct FM *fm_states);
 void fm_demod(struct FM *fm, float rx_out[], float rx[]);
+void fm_set_fast_demod(struct FM *fm, int enable);
 void fm_mod(struct FM *fm, float tx_in[], float tx_out[]);
 void fm_mod_comp(struct FM *fm_states, float tx_in[], COMP tx_out[]);
 
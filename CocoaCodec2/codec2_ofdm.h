@@ -39,6 +39,7 @@ extern "C" {
     
 #include "comp.h"
 #include "modem_stats.h"
+#include "modem_io.h"
 
 /* Defines */
 
@@ -61,6 +62,13 @@ void ofdm_destroy(struct OFDM *);
 void ofdm_mod(struct OFDM *, COMP *, const int *);
 void ofdm_demod(struct OFDM *, int *, COMP *);
 int  ofdm_sync_search(struct OFDM *ofdm, COMP *rxbuf_in);
+void ofdm_sync_idle(struct OFDM *ofdm, COMP *rxbuf_in);
+
+/* as above, with the input samples in the caller's format */
+
+void ofdm_demod_io(struct OFDM *, int *, const void *, const struct MODEM_IO *);
+int  ofdm_sync_search_io(struct OFDM *ofdm, const void *rxbuf_in, const struct MODEM_IO *io);
+void ofdm_sync_idle_io(struct OFDM *ofdm, const void *rxbuf_in, const struct MODEM_IO *io);
 void ofdm_sync_state_machine(struct OFDM *ofdm, int *rx_uw);
 
 /* getters */
@@ -70,6 +78,7 @@ int ofdm_get_nin(struct OFDM *);
 int ofdm_get_samples_per_frame(void);
 int ofdm_get_max_samples_per_frame(void);
 int ofdm_get_bits_per_frame();
+int ofdm_get_carrier_freqs(struct OFDM *, float *);
 void ofdm_get_demod_stats(struct OFDM *ofdm, struct MODEM_STATS *stats);
 
 /* option setters */
@@ -129,6 +129,13 @@ struct COHPSK *cohpsk_create(void)
         coh->ch_fdm_frame_buf[i].imag = 0.0;
     }
 
+    /* quisk_cfDecim() convolves with its taps, the rx filter has always
+       correlated with them, and they aren't symmetric about the middle
+       tap, so give it them reversed */
+
+    for(i=0; i<COHPSK_NFILTER; i++)
+        coh->rx_filter_coeff[i] = gt_alpha5_root_coh[COHPSK_NFILTER-1-i];
+
     /* set up fdmdv states so we can use those modem functions */
 
     fdmdv = fdmdv_create(COHPSK_NC*ND - 1);
@@ -146,10 +153,7 @@ struct COHPSK *cohpsk_create(void)
  	fdmdv->freq_pol[c]  = 2.0*M_PI*freq_hz/COHPSK_FS;
 
         //printf("c: %d %f %f\n",c,freq_hz,fdmdv->freq_pol[c]);
-        for(i=0; i<COHPSK_NFILTER; i++) {
-            coh->rx_filter_memory[c][i].real = 0.0;
-            coh->rx_filter_memory[c][i].imag = 0.0;
-        }
+        quisk_filt_cfInit(&coh->rx_filter_state[c], coh->rx_filter_coeff, COHPSK_NFILTER);
 
         /* optional per-carrier amplitude weighting for testing */
 
@@ -207,7 +211,11 @@ struct COHPSK *cohpsk_create(void)
 
 void cohpsk_destroy(struct COHPSK *coh)
 {
+    int c;
+
     assert(coh != NULL);
+    for(c=0; c<COHPSK_NC*ND; c++)
+        quisk_filt_destroy(&coh->rx_filter_state[c]);
     fdmdv_destroy(coh->fdmdv);
     free(coh);
 }
@@ -808,42 +816,17 @@ void fdm_downconvert_coh(COMP rx_baseband[COHPSK_NC][COHPSK_M+COHPSK_M/P], int N
 \*---------------------------------------------------------------------------*/
 
 
-void rx_filter_coh(COMP rx_filt[COHPSK_NC+1][P+1], int Nc, COMP rx_baseband[COHPSK_NC+1][COHPSK_M+COHPSK_M/P], COMP rx_filter_memory[COHPSK_NC+1][+COHPSK_NFILTER], int nin)
+void rx_filter_coh(COMP rx_filt[COHPSK_NC+1][P+1], int Nc, COMP rx_baseband[COHPSK_NC+1][COHPSK_M+COHPSK_M/P], struct quisk_cfFilter rx_filter_state[COHPSK_NC+1], int nin)
 {
-    int c, i,j,k;
-    int n=COHPSK_M/P;
-    COMP acc;
+    int c, j = 0;
 
     /* rx filter each symbol, generate P filtered output samples for
        each symbol.  Note we keep filter memory at rate M, it's just
-       the filter output at rate P */
-
-    for(i=0, j=0; i<nin; i+=n,j++) {
+       the filter output at rate P, so only every M/P'th output is
+       computed */
 
-		/* latest input sample */
-
-		for(c=0; c<Nc; c++){
-			k=COHPSK_NFILTER-n;
-			memcpy(&rx_filter_memory[c][k],&rx_baseband[c][i],n*sizeof(COMP));
-		}
-		/* convolution (filtering) */
-
-		for(c=0; c<Nc; c++) {
-			/* Cast into const so the compiler doesn't expect aliasing */
-			const COMP * rx_filt_lc = &rx_filter_memory[c][0];
-			acc.real = 0.0f;
-			acc.imag = 0.0f;
-			for(k=0; k<COHPSK_NFILTER; k++){
-				acc = cadd(acc, fcmult(gt_alpha5_root_coh[k], rx_filt_lc[k]));
-			}
-			rx_filt[c][j] = acc;
-		}
-
-		/* make room for next input sample */
-		for(c=0; c<Nc; c++){
-			memcpy(&rx_filter_memory[c][0],&rx_filter_memory[c][n],(COHPSK_NFILTER-n)*sizeof(COMP));
-		}
-    }
+    for(c=0; c<Nc; c++)
+        j = quisk_cfDecim((complex float *)rx_baseband[c], (complex float *)rx_filt[c], nin, &rx_filter_state[c], COHPSK_M/P);
 
     assert(j <= (P+1)); /* check for any over runs */
 }
@@ -901,7 +884,7 @@ void rate_Fs_rx_processing(struct COHPSK *coh, COMP ch_symb[][COHPSK_NC*ND], COM
         fdmdv_freq_shift_coh(rx_fdm_frame_bb, &ch_fdm_frame[ch_fdm_frame_index], -(*f_est), COHPSK_FS, &fdmdv->fbb_phase_rx, nin);
         ch_fdm_frame_index += nin;
         fdm_downconvert_coh(rx_baseband, COHPSK_NC*ND, rx_fdm_frame_bb, fdmdv->phase_rx, fdmdv->freq, nin);
-        rx_filter_coh(rx_filt, COHPSK_NC*ND, rx_baseband, coh->rx_filter_memory, nin);
+        rx_filter_coh(rx_filt, COHPSK_NC*ND, rx_baseband, coh->rx_filter_state, nin);
         rx_timing = rx_est_timing(rx_onesym, fdmdv->Nc, rx_filt, fdmdv->rx_filter_mem_timing, env, nin, COHPSK_M);
 
         for(c=0; c<COHPSK_NC*ND; c++) {
@@ -1382,6 +1365,16 @@ float *cohpsk_get_rx_bits_upper(struct COHPSK *coh) {
     return coh->rx_bits_upper;
 }
 
+/* centre frequency of each carrier, returns COHPSK_NC*ND */
+
+int cohpsk_get_carrier_freqs(struct COHPSK *coh, float freq_hz[]) {
+    int c;
+
+    for(c=0; c<COHPSK_NC*ND; c++)
+        freq_hz[c] = FDMDV_FCENTRE + coh->fdmdv->freq_pol[c]*COHPSK_FS/(2.0*M_PI);
+    return COHPSK_NC*ND;
+}
+
 void cohpsk_set_carrier_ampl(struct COHPSK *coh, int c, float ampl) {
     assert(c < COHPSK_NC*ND);
     coh->carrier_ampl[c] = ampl;
@@ -49,7 +49,8 @@ struct COHPSK {
     float        amp_[NSYMROW][COHPSK_NC*ND];           /* amplitude estimates for this frame of rx data symbols */
     COMP         rx_symb[NSYMROWPILOT][COHPSK_NC*ND];   /* demodulated symbols                                   */
     float        f_est;
-    COMP         rx_filter_memory[COHPSK_NC*ND][COHPSK_NFILTER];
+    struct quisk_cfFilter rx_filter_state[COHPSK_NC*ND];   /* rx filter delay lines, one per carrier                */
+    float        rx_filter_coeff[COHPSK_NFILTER];       /* gt_alpha5_root_coh reversed, see rx_filter_coh()      */
     COMP         ct_symb_buf[NCT_SYMB_BUF][COHPSK_NC*ND];
     int          ct;                                    /* coarse timing offset in symbols                       */
     float        rx_timing;                             /* fine timing for last symbol in frame                  */
@@ -117,7 +118,7 @@ void tx_filter_and_upconvert_coh(COMP tx_fdm[], int Nc, const COMP tx_symbols[],
                                  COMP phase_tx[], COMP freq[],
                                  COMP *fbb_phase, COMP fbb_rect);
 void fdm_downconvert_coh(COMP rx_baseband[COHPSK_NC][COHPSK_M+COHPSK_M/P], int Nc, COMP rx_fdm[], COMP phase_rx[], COMP freq[], int nin);
-void rx_filter_coh(COMP rx_filt[COHPSK_NC+1][P+1], int Nc, COMP rx_baseband[COHPSK_NC+1][COHPSK_M+COHPSK_M/P], COMP rx_filter_memory[COHPSK_NC+1][COHPSK_NFILTER], int nin);
+void rx_filter_coh(COMP rx_filt[COHPSK_NC+1][P+1], int Nc, COMP rx_baseband[COHPSK_NC+1][COHPSK_M+COHPSK_M/P], struct quisk_cfFilter rx_filter_state[COHPSK_NC+1], int nin);
 void frame_sync_fine_freq_est(struct COHPSK *coh, COMP ch_symb[][COHPSK_NC*COHPSK_ND], int sync, int *next_sync);
 void fine_freq_correct(struct COHPSK *coh, int sync, int next_sync);
 int sync_state_machine(struct COHPSK *coh, int sync, int next_sync);
@@ -169,10 +169,7 @@ struct FDMDV * fdmdv_create(int Nc)
     f->pilot_lut_index = 0;
     f->prev_pilot_lut_index = 3*M_FAC;
 
-    for(i=0; i<NRXDECMEM; i++) {
-        f->rxdec_lpf_mem[i].real = 0.0;
-        f->rxdec_lpf_mem[i].imag = 0.0;
-    }
+    quisk_filt_cfInit(&f->rxdec_lpf, rxdec_coeff, NRXDEC);
 
     for(i=0; i<NPILOTLPF; i++) {
 	f->pilot_lpf1[i].real = f->pilot_lpf2[i].real = 0.0;
@@ -219,6 +216,7 @@ void fdmdv_destroy(struct FDMDV *fdmdv)
 {
     assert(fdmdv != NULL);
     codec2_fft_free(fdmdv->fft_pilot_cfg);
+    quisk_filt_destroy(&fdmdv->rxdec_lpf);
     free(fdmdv->rx_test_bits_mem);
     free(fdmdv);
 }
@@ -264,6 +262,17 @@ float fdmdv_get_fsep(struct FDMDV *f)
     return f->fsep;
 }
 
+/* centre frequency of each carrier then the pilot, returns Nc+1 */
+
+int fdmdv_get_carrier_freqs(struct FDMDV *f, float freq_hz[])
+{
+    int c;
+
+    for(c=0; c<=f->Nc; c++)
+        freq_hz[c] = FDMDV_FCENTRE + f->freq_pol[c]*FS/(2.0*PI);
+    return f->Nc+1;
+}
+
 void fdmdv_set_fsep(struct FDMDV *f, float fsep) {
     int   c;
     float carrier_freq;
@@ -907,6 +916,27 @@ void fdmdv_freq_shift(COMP rx_fdm_fcorr[], COMP rx_fdm[], float foff,
     foff_phase_rect->imag /= mag;
 }
 
+/* as fdmdv_freq_shift(), reading the input in the caller's format */
+
+void fdmdv_freq_shift_io(COMP rx_fdm_fcorr[], const void *rx_fdm, const struct MODEM_IO *io, float foff,
+                         COMP *foff_phase_rect, int nin)
+{
+    COMP  foff_rect;
+    float mag;
+    int   i;
+
+    foff_rect.real = COSF(2.0*PI*foff/FS);
+    foff_rect.imag = SINF(2.0*PI*foff/FS);
+    for(i=0; i<nin; i++) {
+	*foff_phase_rect = cmult(*foff_phase_rect, foff_rect);
+	rx_fdm_fcorr[i] = cmult(modem_io_get(io, rx_fdm, i), *foff_phase_rect);
+    }
+
+    mag = cabsolute(*foff_phase_rect);
+    foff_phase_rect->real /= mag;
+    foff_phase_rect->imag /= mag;
+}
+
 /*---------------------------------------------------------------------------*\
 
   FUNCTION....: fdm_downconvert
@@ -957,39 +987,24 @@ void fdm_downconvert(COMP rx_baseband[NC+1][M_FAC+M_FAC/P], int Nc, COMP rx_fdm[
   occasionally adjusted to compensate for timing slips due to
   different tx and rx sample clocks.
 
+  quisk_cfDecim() convolves, so set up rx_filter_state[] with
+  gt_alpha5_root[] reversed for the correlation with gt_alpha5_root[]
+  this filter has always done (the taps aren't symmetric about the
+  middle tap), as cohpsk_create() does for rx_filter_coh().
+
 \*---------------------------------------------------------------------------*/
 
-void rx_filter(COMP rx_filt[NC+1][P+1], int Nc, COMP rx_baseband[NC+1][M_FAC+M_FAC/P], COMP rx_filter_memory[NC+1][NFILTER], int nin)
+void rx_filter(COMP rx_filt[NC+1][P+1], int Nc, COMP rx_baseband[NC+1][M_FAC+M_FAC/P], struct quisk_cfFilter rx_filter_state[NC+1], int nin)
 {
-    int c, i,j,k,l;
-    int n=M_FAC/P;
+    int c, j = 0;
 
     /* rx filter each symbol, generate P filtered output samples for
        each symbol.  Note we keep filter memory at rate M_FAC, it's just
-       the filter output at rate P */
+       the filter output at rate P, so only every M_FAC/P'th output is
+       computed */
 
-    for(i=0, j=0; i<nin; i+=n,j++) {
-
-	/* latest input sample */
-
-	for(c=0; c<Nc+1; c++)
-	    for(k=NFILTER-n,l=i; k<NFILTER; k++,l++)
-		rx_filter_memory[c][k] = rx_baseband[c][l];
-
-	/* convolution (filtering) */
-
-	for(c=0; c<Nc+1; c++) {
-	    rx_filt[c][j].real = 0.0; rx_filt[c][j].imag = 0.0;
-	    for(k=0; k<NFILTER; k++)
-		rx_filt[c][j] = cadd(rx_filt[c][j], fcmult(gt_alpha5_root[k], rx_filter_memory[c][k]));
-	}
-
-	/* make room for next input sample */
-
-	for(c=0; c<Nc+1; c++)
-	    for(k=0,l=n; k<NFILTER-n; k++,l++)
-		rx_filter_memory[c][k] = rx_filter_memory[c][l];
-    }
+    for(c=0; c<Nc+1; c++)
+        j = quisk_cfDecim((complex float *)rx_baseband[c], (complex float *)rx_filt[c], nin, &rx_filter_state[c], M_FAC/P);
 
     assert(j <= (P+1)); /* check for any over runs */
 }
@@ -1005,117 +1020,8 @@ void rx_filter(COMP rx_filt[NC+1][P+1], int Nc, COMP rx_baseband[NC+1][M_FAC+M_F
 
 \*---------------------------------------------------------------------------*/
 
-void rxdec_filter(COMP rx_fdm_filter[], COMP rx_fdm[], COMP rxdec_lpf_mem[], int nin) {
-    int i,j,k,st;
-
-    for(i=0; i<NRXDECMEM-nin; i++)
-        rxdec_lpf_mem[i] = rxdec_lpf_mem[i+nin];
-    for(i=0, j=NRXDECMEM-nin; i<nin; i++,j++)
-        rxdec_lpf_mem[j] = rx_fdm[i];
-
-    st = NRXDECMEM - nin - NRXDEC + 1;
-    for(i=0; i<nin; i++) {
-        rx_fdm_filter[i].real = 0.0;
-        for(k=0; k<NRXDEC; k++)
-            rx_fdm_filter[i].real += rxdec_lpf_mem[st+i+k].real * rxdec_coeff[k];
-        rx_fdm_filter[i].imag = 0.0;
-        for(k=0; k<NRXDEC; k++)
-            rx_fdm_filter[i].imag += rxdec_lpf_mem[st+i+k].imag * rxdec_coeff[k];
-    }
-}
-
-/*---------------------------------------------------------------------------*\
-
-  FUNCTION....: fir_filter2()
-  AUTHOR......: Danilo Beuche
-  DATE CREATED: August 2016
-
-  Ths version submitted by Danilo for the STM32F4 platform.  The idea
-  is to avoid reading the same value from the STM32F4 "slow" flash
-  twice. 2-4ms of savings per frame were measured by Danilo and the mcHF
-  team.
-
-\*---------------------------------------------------------------------------*/
-
-static void fir_filter2(float acc[2], float mem[], const float coeff[], const unsigned int dec_rate) {
-    acc[0] = 0.0;
-    acc[1] = 0.0;
-
-    float c1,c2,c3,c4,c5,m1,m2,m3,m4,m5,m6,m7,m8,m9,m10,a1,a2;
-    float* inpCmplx = &mem[0];
-    const float* coeffPtr = &coeff[0];
-
-    int m;
-
-    // this manual loop unrolling gives significant boost on STM32 machines
-    // reduction from avg 3.2ms to 2.4ms in tfdmv.c test
-    // 5 was the sweet spot, with 6 it took longer again
-    // and should not harm other, more powerful machines
-    // no significant difference in output, only rounding (which was to be expected)
-    // TODO: try to move coeffs to RAM and check if it makes a significant difference
-    if (NFILTER%(dec_rate*5) == 0) {
-        for(m=0; m<NFILTER; m+=dec_rate*5) {
-            c1 = *coeffPtr;
-
-            m1 = inpCmplx[0];
-            m2 = inpCmplx[1];
-
-            inpCmplx+= dec_rate*2;
-            coeffPtr+= dec_rate;
-
-            c2 = *coeffPtr;
-            m3 = inpCmplx[0];
-            m4 = inpCmplx[1];
-
-            inpCmplx+= dec_rate*2;
-            coeffPtr+= dec_rate;
-
-            c3 = *coeffPtr;
-            m5 = inpCmplx[0];
-            m6 = inpCmplx[1];
-
-            inpCmplx+= dec_rate*2;
-            coeffPtr+= dec_rate;
-
-            c4 = *coeffPtr;
-            m7 = inpCmplx[0];
-            m8 = inpCmplx[1];
-
-            inpCmplx+= dec_rate*2;
-            coeffPtr+= dec_rate;
-
-            c5 = *coeffPtr;
-            m9 = inpCmplx[0];
-            m10 = inpCmplx[1];
-
-            inpCmplx+= dec_rate*2;
-            coeffPtr+= dec_rate;
-
-            a1 = c1 * m1 + c2 * m3 + c3 * m5 + c4 * m7 + c5 * m9;
-            a2 = c1 * m2 + c2 * m4 + c3 * m6 + c4 * m8 + c5 * m10;
-            acc[0] += a1;
-            acc[1] += a2;
-        }
-    }
-    else
-    {
-        for(m=0; m<NFILTER; m+=dec_rate) {
-            c1 = *coeffPtr;
-
-            m1 = inpCmplx[0];
-            m2 = inpCmplx[1];
-
-            inpCmplx+= dec_rate*2;
-            coeffPtr+= dec_rate;
-
-            a1 = c1 * m1;
-            a2 = c1 * m2;
-            acc[0] += a1;
-            acc[1] += a2;
-        }
-    }
-    acc[0] *= dec_rate;
-    acc[1] *= dec_rate;
+void rxdec_filter(COMP rx_fdm_filter[], COMP rx_fdm[], struct quisk_cfFilter *rxdec_lpf, int nin) {
+    quisk_cfDecim((complex float *)rx_fdm, (complex float *)rx_fdm_filter, nin, rxdec_lpf, 1);
 }
 
 /*---------------------------------------------------------------------------*\
@@ -1142,11 +1048,20 @@ void down_convert_and_rx_filter(COMP rx_filt[NC+1][P+1], int Nc, COMP rx_fdm[],
                                 COMP rx_fdm_mem[], COMP phase_rx[], COMP freq[],
                                 float freq_pol[], int nin, int dec_rate)
 {
-    int i,k,c,st,Nval;
+    int i,j,k,c,st,Nval,ntaps;
     float windback_phase, mag;
     COMP  windback_phase_rect;
     COMP  rx_baseband[NRX_FDM_MEM];
     COMP  f_rect;
+    float gt_dec[NFILTER];
+
+    /* Only every dec_rate'th baseband sample is computed, so filter a
+       compacted copy of those with the matching decimated taps.  The
+       taps are scaled by dec_rate to keep the gain of the full filter. */
+
+    ntaps = (NFILTER + dec_rate - 1)/dec_rate;
+    for(j=0; j<ntaps; j++)
+        gt_dec[j] = gt_alpha5_root[j*dec_rate]*dec_rate;
 
     //PROFILE_VAR(windback_start,  downconvert_start, filter_start);
 
@@ -1204,9 +1119,9 @@ void down_convert_and_rx_filter(COMP rx_filt[NC+1][P+1], int Nc, COMP rx_fdm[],
         for(i=0; i<dec_rate-1; i++)
             f_rect = cmult(f_rect,freq[c]);
 
-        for(i=st; i<NRX_FDM_MEM; i+=dec_rate) {
+        for(i=st, j=0; i<NRX_FDM_MEM; i+=dec_rate, j++) {
             phase_rx[c]    = cmult(phase_rx[c], f_rect);
-            rx_baseband[i] = cmult(rx_fdm_mem[i],cconj(phase_rx[c]));
+            rx_baseband[j] = cmult(rx_fdm_mem[i],cconj(phase_rx[c]));
         }
         //PROFILE_SAMPLE_AND_LOG(filter_start, downconvert_start, "        downconvert");
 
@@ -1214,16 +1129,9 @@ void down_convert_and_rx_filter(COMP rx_filt[NC+1][P+1], int Nc, COMP rx_fdm[],
 
         Nval=M_FAC/P;
         for(i=0, k=0; i<nin; i+=Nval, k++) {
-#ifdef ORIG
-            rx_filt[c][k].real = 0.0; rx_filt[c][k].imag = 0.0;
-
-            for(m=0; m<NFILTER; m++)
-                rx_filt[c][k] = cadd(rx_filt[c][k], fcmult(gt_alpha5_root[m], rx_baseband[st+i+m]));
-#else
-            // rx_filt[c][k].real = fir_filter(&rx_baseband[st+i].real, (float*)gt_alpha5_root, dec_rate);
-            // rx_filt[c][k].imag = fir_filter(&rx_baseband[st+i].imag, (float*)gt_alpha5_root, dec_rate);
-            fir_filter2(&rx_filt[c][k].real,&rx_baseband[st+i].real, gt_alpha5_root, dec_rate);
-#endif
+            complex float acc = quisk_dot_cf((complex float *)&rx_baseband[i/dec_rate], gt_dec, ntaps);
+            rx_filt[c][k].real = crealf(acc);
+            rx_filt[c][k].imag = cimagf(acc);
         }
         //PROFILE_SAMPLE_AND_LOG2(filter_start, "        filter");
 
@@ -1628,13 +1536,37 @@ int freq_state(int *reliable_sync_bit, int sync_bit, int *state, int *timer, int
 
 \*---------------------------------------------------------------------------*/
 
+static void fdmdv_demod_bb(struct FDMDV *fdmdv, int rx_bits[],
+		           int *reliable_sync_bit, COMP rx_fdm_bb[], int *nin);
+
 void fdmdv_demod(struct FDMDV *fdmdv, int rx_bits[],
 		 int *reliable_sync_bit, COMP rx_fdm[], int *nin)
+{
+    COMP          rx_fdm_bb[M_FAC+M_FAC/P];
+
+    /* shift down to complex baseband */
+
+    fdmdv_freq_shift(rx_fdm_bb, rx_fdm, -FDMDV_FCENTRE, &fdmdv->fbb_phase_rx, *nin);
+    fdmdv_demod_bb(fdmdv, rx_bits, reliable_sync_bit, rx_fdm_bb, nin);
+}
+
+/* fdmdv_demod() with the input in the caller's format, converted as it is shifted to baseband */
+
+void fdmdv_demod_io(struct FDMDV *fdmdv, int rx_bits[],
+		    int *reliable_sync_bit, const void *rx_fdm, const struct MODEM_IO *io, int *nin)
+{
+    COMP          rx_fdm_bb[M_FAC+M_FAC/P];
+
+    fdmdv_freq_shift_io(rx_fdm_bb, rx_fdm, io, -FDMDV_FCENTRE, &fdmdv->fbb_phase_rx, *nin);
+    fdmdv_demod_bb(fdmdv, rx_bits, reliable_sync_bit, rx_fdm_bb, nin);
+}
+
+static void fdmdv_demod_bb(struct FDMDV *fdmdv, int rx_bits[],
+		           int *reliable_sync_bit, COMP rx_fdm_bb[], int *nin)
 {
     float         foff_coarse, foff_fine;
     COMP          rx_fdm_fcorr[M_FAC+M_FAC/P];
     COMP          rx_fdm_filter[M_FAC+M_FAC/P];
-    COMP          rx_fdm_bb[M_FAC+M_FAC/P];
     COMP          rx_filt[NC+1][P+1];
     COMP          rx_symbols[NC+1];
     float         env[NT*P];
@@ -1642,10 +1574,6 @@ void fdmdv_demod(struct FDMDV *fdmdv, int rx_bits[],
     PROFILE_VAR(demod_start, fdmdv_freq_shift_start, down_convert_and_rx_filter_start);
     PROFILE_VAR(rx_est_timing_start, qpsk_to_bits_start, snr_update_start, freq_state_start);
 
-    /* shift down to complex baseband */
-
-    fdmdv_freq_shift(rx_fdm_bb, rx_fdm, -FDMDV_FCENTRE, &fdmdv->fbb_phase_rx, *nin);
-
     /* freq offset estimation and correction */
 
     PROFILE_SAMPLE(demod_start);
@@ -1659,7 +1587,7 @@ void fdmdv_demod(struct FDMDV *fdmdv, int rx_bits[],
 
     /* baseband processing */
 
-    rxdec_filter(rx_fdm_filter, rx_fdm_fcorr, fdmdv->rxdec_lpf_mem, *nin);
+    rxdec_filter(rx_fdm_filter, rx_fdm_fcorr, &fdmdv->rxdec_lpf, *nin);
     down_convert_and_rx_filter(rx_filt, fdmdv->Nc, rx_fdm_filter, fdmdv->rx_fdm_mem, fdmdv->phase_rx, fdmdv->freq,
                                fdmdv->freq_pol, *nin, M_FAC/Q);
     PROFILE_SAMPLE_AND_LOG(rx_est_timing_start, down_convert_and_rx_filter_start, "    down_convert_and_rx_filter");
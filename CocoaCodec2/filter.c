@@ -5,6 +5,14 @@
 #include "filter.h"
 #include "filter_coef.h"
 
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#endif
+
 /*
  This is a library of filter functions. They were copied from Quisk and converted to single precision.
 */
@@ -37,18 +45,38 @@
 
 \*---------------------------------------------------------------------------*/
 
-void quisk_filt_cfInit(struct quisk_cfFilter * filter, float * coefs, int taps)
+void quisk_filt_cfInit(struct quisk_cfFilter * filter, const float * coefs, int taps)
 {    // Prepare a new filter using coefs and taps.  Samples are complex. Coefficients can
      // be real or complex.
+    int i;
+
     filter->dCoefs = coefs;
     filter->cpxCoefs = NULL;
-    filter->cSamples = (complex float *)malloc(taps * sizeof(complex float));
-    memset(filter->cSamples, 0, taps * sizeof(complex float));
+    filter->cSamples = (complex float *)malloc(2 * taps * sizeof(complex float));
+    memset(filter->cSamples, 0, 2 * taps * sizeof(complex float));
     filter->ptcSamp = filter->cSamples;
     filter->nTaps = taps;
     filter->cBuf = NULL;
     filter->nBuf = 0;
     filter->decim_index = 0;
+    filter->dRevCoefs = (float *)malloc(taps * sizeof(float));
+    for (i = 0; i < taps; i++)
+        filter->dRevCoefs[i] = coefs[taps - 1 - i];
+    filter->cpxRevCoefs = NULL;
+    filter->dPolyCoefs = NULL;
+    filter->nPolyInterp = 0;
+}
+
+/* Add one sample to the delay line and return a pointer to the most recent
+   nTaps samples, oldest first.  The newest sample is at [nTaps - 1]. */
+
+static inline complex float * quisk_cfPut(struct quisk_cfFilter * filter, complex float sample)
+{
+    filter->ptcSamp[0] = sample;
+    filter->ptcSamp[filter->nTaps] = sample;
+    if (++filter->ptcSamp >= filter->cSamples + filter->nTaps)
+        filter->ptcSamp = filter->cSamples;
+    return filter->ptcSamp;
 }
 
 /*---------------------------------------------------------------------------*\
@@ -76,6 +104,37 @@ void quisk_filt_destroy(struct quisk_cfFilter * filter)
         free(filter->cpxCoefs);
         filter->cpxCoefs = NULL;
     }
+    if (filter->dRevCoefs) {
+        free(filter->dRevCoefs);
+        filter->dRevCoefs = NULL;
+    }
+    if (filter->cpxRevCoefs) {
+        free(filter->cpxRevCoefs);
+        filter->cpxRevCoefs = NULL;
+    }
+    if (filter->dPolyCoefs) {
+        free(filter->dPolyCoefs);
+        filter->dPolyCoefs = NULL;
+    }
+    filter->nPolyInterp = 0;
+}
+
+/* Split the coefficients into interp phases of nTaps / interp taps each.  Phase p
+   holds dCoefs[p], dCoefs[p + interp], ... reversed to match the oldest-first
+   delay line, with the interp gain folded in. */
+
+static void quisk_cfPolyInit(struct quisk_cfFilter * filter, int interp)
+{
+    int p, j, nPhase;
+
+    nPhase = filter->nTaps / interp;
+    if (filter->dPolyCoefs)
+        free(filter->dPolyCoefs);
+    filter->dPolyCoefs = (float *)malloc(interp * nPhase * sizeof(float));
+    for (p = 0; p < interp; p++)
+        for (j = 0; j < nPhase; j++)
+            filter->dPolyCoefs[p * nPhase + j] = filter->dCoefs[p + (nPhase - 1 - j) * interp] * interp;
+    filter->nPolyInterp = interp;
 }
 
 /*---------------------------------------------------------------------------*\
@@ -95,10 +154,10 @@ void quisk_filt_destroy(struct quisk_cfFilter * filter)
 int quisk_cfInterpDecim(complex float * cSamples, int count, struct quisk_cfFilter * filter, int interp, int decim)
 {   // Interpolate by interp, and then decimate by decim.
     // This uses the float coefficients of filter (not the complex).  Samples are complex.
-    int i, k, nOut;
-    float * ptCoef;
+    // Polyphase: only the outputs that survive decimation are computed, each with
+    // the nTaps / interp coefficients of its own phase.
+    int i, nOut, nPhase;
     complex float * ptSample;
-    complex float csample;
 
     if (count > filter->nBuf) {    // increase size of sample buffer
         filter->nBuf = count * 2;
@@ -106,31 +165,53 @@ int quisk_cfInterpDecim(complex float * cSamples, int count, struct quisk_cfFilt
             free(filter->cBuf);
         filter->cBuf = (complex float *)malloc(filter->nBuf * sizeof(complex float));
     }
+    if (filter->nPolyInterp != interp)
+        quisk_cfPolyInit(filter, interp);
+    nPhase = filter->nTaps / interp;
     memcpy(filter->cBuf, cSamples, count * sizeof(complex float));
     nOut = 0;
     for (i = 0; i < count; i++) {
-        // Put samples into buffer left to right.  Use samples right to left.
-        *filter->ptcSamp = filter->cBuf[i];
+        // Put samples into buffer left to right.  The newest nPhase samples are used.
+        ptSample = quisk_cfPut(filter, filter->cBuf[i]) + filter->nTaps - nPhase;
         while (filter->decim_index < interp) {
-            ptSample = filter->ptcSamp;
-            ptCoef = filter->dCoefs + filter->decim_index;
-            csample = 0;
-            for (k = 0; k < filter->nTaps / interp; k++, ptCoef += interp) {
-                csample += *ptSample * *ptCoef;
-                if (--ptSample < filter->cSamples)
-                    ptSample = filter->cSamples + filter->nTaps - 1;
-            }
-            cSamples[nOut] = csample * interp;
+            cSamples[nOut] = quisk_dot_cf(ptSample, filter->dPolyCoefs + filter->decim_index * nPhase, nPhase);
             nOut++;
             filter->decim_index += decim;
         }
-        if (++filter->ptcSamp >= filter->cSamples + filter->nTaps)
-            filter->ptcSamp = filter->cSamples;
         filter->decim_index = filter->decim_index - interp;
     }
     return nOut;
 }
 
+/*---------------------------------------------------------------------------*\
+
+  FUNCTIONS...: quisk_cfDecim
+  DATE CREATED: October 2026
+
+  Filter count complex samples with the real coefficients of filter and keep
+  every decim'th output, so only the kept outputs are computed.  The state
+  carries over between calls, so count need not be a multiple of decim.  Use
+  decim = 1 for a plain FIR filter.  inSamples and outSamples may be the same
+  array.  Returns the number of output samples.
+
+\*---------------------------------------------------------------------------*/
+
+int quisk_cfDecim(complex float * inSamples, complex float * outSamples, int count, struct quisk_cfFilter * filter, int decim)
+{
+    int i, nOut;
+    complex float * ptSample;
+
+    nOut = 0;
+    for (i = 0; i < count; i++) {
+        ptSample = quisk_cfPut(filter, inSamples[i]);
+        if (++filter->decim_index >= decim) {
+            filter->decim_index = 0;
+            outSamples[nOut++] = quisk_dot_cf(ptSample, filter->dRevCoefs, filter->nTaps);
+        }
+    }
+    return nOut;
+}
+
 /*---------------------------------------------------------------------------*\
 
   FUNCTIONS...: quisk_ccfInterpDecim
@@ -164,22 +245,16 @@ int quisk_ccfInterpDecim(complex float * cSamples, int count, struct quisk_cfFil
     nOut = 0;
     for (i = 0; i < count; i++) {
         // Put samples into buffer left to right.  Use samples right to left.
-        *filter->ptcSamp = filter->cBuf[i];
+        ptSample = quisk_cfPut(filter, filter->cBuf[i]) + filter->nTaps - 1;
         while (filter->decim_index < interp) {
-            ptSample = filter->ptcSamp;
             ptCoef = filter->cpxCoefs + filter->decim_index;
             csample = 0;
-            for (k = 0; k < filter->nTaps / interp; k++, ptCoef += interp) {
-                csample += *ptSample * *ptCoef;
-                if (--ptSample < filter->cSamples)
-                    ptSample = filter->cSamples + filter->nTaps - 1;
-            }
+            for (k = 0; k < filter->nTaps / interp; k++, ptCoef += interp)
+                csample += ptSample[-k] * *ptCoef;
             cSamples[nOut] = csample * interp;
             nOut++;
             filter->decim_index += decim;
         }
-        if (++filter->ptcSamp >= filter->cSamples + filter->nTaps)
-            filter->ptcSamp = filter->cSamples;
         filter->decim_index = filter->decim_index - interp;
     }
     return nOut;
@@ -207,10 +282,14 @@ void quisk_cfTune(struct quisk_cfFilter * filter, float freq)
 
     if ( ! filter->cpxCoefs)
         filter->cpxCoefs = (complex float *)malloc(filter->nTaps * sizeof(complex float));
+    if ( ! filter->cpxRevCoefs)
+        filter->cpxRevCoefs = (complex float *)malloc(filter->nTaps * sizeof(complex float));
     tune = I * 2.0 * M_PI * freq;
     D = (filter->nTaps - 1.0) / 2.0;
     for (i = 0; i < filter->nTaps; i++)
         filter->cpxCoefs[i] = cexpf(tune * (i - D)) * filter->dCoefs[i];
+    for (i = 0; i < filter->nTaps; i++)
+        filter->cpxRevCoefs[i] = filter->cpxCoefs[filter->nTaps - 1 - i];
 }
 
 /*---------------------------------------------------------------------------*\
@@ -228,24 +307,267 @@ void quisk_cfTune(struct quisk_cfFilter * filter, float freq)
 
 void quisk_ccfFilter(complex float * inSamples, complex float * outSamples, int count, struct quisk_cfFilter * filter)
 {
-    int i, k;
+    int i;
     complex float * ptSample;
-    complex float * ptCoef;
-    complex float accum;
 
     for (i = 0; i < count; i++) {
-        *filter->ptcSamp = inSamples[i];
-        accum = 0;
-        ptSample = filter->ptcSamp;
-        ptCoef = filter->cpxCoefs;
-        for (k = 0; k < filter->nTaps; k++, ptCoef++) {
-            accum += *ptSample  *  *ptCoef;
-            if (--ptSample < filter->cSamples)
-                ptSample = filter->cSamples + filter->nTaps - 1;
+        ptSample = quisk_cfPut(filter, inSamples[i]);
+        outSamples[i] = quisk_dot_cc(ptSample, filter->cpxRevCoefs, filter->nTaps);
+    }
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTIONS...: quisk_filt_fInit
+  DATE CREATED: October 2026
+
+  Initialize a FIR filter that has real samples and real coefficients.  The
+  coefficients are copied, so they need not outlive the filter.
+
+\*---------------------------------------------------------------------------*/
+
+void quisk_filt_fInit(struct quisk_fFilter * filter, const float * coefs, int taps)
+{
+    int i;
+
+    filter->nTaps = taps;
+    filter->dRevCoefs = (float *)malloc(taps * sizeof(float));
+    for (i = 0; i < taps; i++)
+        filter->dRevCoefs[i] = coefs[taps - 1 - i];
+    filter->dSamples = (float *)malloc(2 * taps * sizeof(float));
+    memset(filter->dSamples, 0, 2 * taps * sizeof(float));
+    filter->index = 0;
+    filter->decim_index = 0;
+}
+
+void quisk_filt_fDestroy(struct quisk_fFilter * filter)
+{
+    if (filter->dSamples) {
+        free(filter->dSamples);
+        filter->dSamples = NULL;
+    }
+    if (filter->dRevCoefs) {
+        free(filter->dRevCoefs);
+        filter->dRevCoefs = NULL;
+    }
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTIONS...: quisk_fDecim
+  DATE CREATED: October 2026
+
+  Real sample version of quisk_cfDecim().  Filters count samples, keeping
+  every decim'th output.  inSamples and outSamples may be the same array.
+  Returns the number of output samples.
+
+\*---------------------------------------------------------------------------*/
+
+int quisk_fDecim(float * inSamples, float * outSamples, int count, struct quisk_fFilter * filter, int decim)
+{
+    int i, nOut;
+
+    nOut = 0;
+    for (i = 0; i < count; i++) {
+        quisk_fDelayPut(filter->dSamples, filter->nTaps, &filter->index, &inSamples[i], 1);
+        if (++filter->decim_index >= decim) {
+            filter->decim_index = 0;
+            outSamples[nOut++] = quisk_dot_ff(filter->dSamples + filter->index, filter->dRevCoefs, filter->nTaps);
         }
-        outSamples[i] = accum;
-        if (++filter->ptcSamp >= filter->cSamples + filter->nTaps)
-            filter->ptcSamp = filter->cSamples;
     }
+    return nOut;
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTIONS...: quisk_fDelayPut
+  DATE CREATED: October 2026
+
+  Append count samples to a double-length delay line.  The line holds 2*len
+  floats and *index is the position of the oldest sample, so after the call
+  the most recent len samples are line[*index] ... line[*index + len - 1].
+  Initialise the line to zero and *index to 0.
+
+\*---------------------------------------------------------------------------*/
+
+void quisk_fDelayPut(float * line, int len, int * index, const float * samples, int count)
+{
+    int i, n;
+
+    n = *index;
+    for (i = 0; i < count; i++) {
+        line[n] = samples[i];
+        line[n + len] = samples[i];
+        if (++n >= len)
+            n = 0;
+    }
+    *index = n;
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTIONS...: quisk_dot_ff, quisk_dot_cf, quisk_dot_cc
+  DATE CREATED: October 2026
+
+  Inner products used by the filters above, vectorised with NEON, AVX or SSE
+  where available.  quisk_dot_cf multiplies complex samples by real
+  coefficients, and quisk_dot_cc complex samples by complex coefficients.
+
+\*---------------------------------------------------------------------------*/
+
+float quisk_dot_ff(const float * x, const float * c, int n)
+{
+    int k = 0;
+    float sum;
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    float32x2_t acc2;
+    for ( ; k + 4 <= n; k += 4)
+        acc = vmlaq_f32(acc, vld1q_f32(x + k), vld1q_f32(c + k));
+    acc2 = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    sum = vget_lane_f32(vpadd_f32(acc2, acc2), 0);
+#elif defined(__AVX__)
+    __m256 acc = _mm256_setzero_ps();
+    float tmp[8];
+    for ( ; k + 8 <= n; k += 8)
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(x + k), _mm256_loadu_ps(c + k)));
+    _mm256_storeu_ps(tmp, acc);
+    sum = ((tmp[0] + tmp[4]) + (tmp[2] + tmp[6])) + ((tmp[1] + tmp[5]) + (tmp[3] + tmp[7]));
+#elif defined(__SSE__) || defined(__x86_64__)
+    __m128 acc = _mm_setzero_ps();
+    float tmp[4];
+    for ( ; k + 4 <= n; k += 4)
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(x + k), _mm_loadu_ps(c + k)));
+    _mm_storeu_ps(tmp, acc);
+    sum = (tmp[0] + tmp[2]) + (tmp[1] + tmp[3]);
+#else
+    sum = 0.0f;
+#endif
+    for ( ; k < n; k++)
+        sum += x[k] * c[k];
+    return sum;
 }
 
+complex float quisk_dot_cf(const complex float * x, const float * c, int n)
+{
+    int k = 0;
+    float re, im;
+    const float * px = (const float *)x;
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    float32x4_t acc_re = vdupq_n_f32(0.0f);
+    float32x4_t acc_im = vdupq_n_f32(0.0f);
+    float32x4x2_t v;
+    float32x4_t vc;
+    float32x2_t t;
+    for ( ; k + 4 <= n; k += 4) {
+        v = vld2q_f32(px + 2 * k);          // de-interleave real and imag
+        vc = vld1q_f32(c + k);
+        acc_re = vmlaq_f32(acc_re, v.val[0], vc);
+        acc_im = vmlaq_f32(acc_im, v.val[1], vc);
+    }
+    t = vadd_f32(vget_low_f32(acc_re), vget_high_f32(acc_re));
+    re = vget_lane_f32(vpadd_f32(t, t), 0);
+    t = vadd_f32(vget_low_f32(acc_im), vget_high_f32(acc_im));
+    im = vget_lane_f32(vpadd_f32(t, t), 0);
+#elif defined(__AVX__)
+    __m256 acc = _mm256_setzero_ps();
+    __m128 vc;
+    float tmp[8];
+    for ( ; k + 4 <= n; k += 4) {
+        vc = _mm_loadu_ps(c + k);          // c0 c1 c2 c3 becomes c0 c0 c1 c1 c2 c2 c3 c3
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(px + 2 * k),
+            _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_unpacklo_ps(vc, vc)), _mm_unpackhi_ps(vc, vc), 1)));
+    }
+    _mm256_storeu_ps(tmp, acc);            // re im re im re im re im
+    re = (tmp[0] + tmp[4]) + (tmp[2] + tmp[6]);
+    im = (tmp[1] + tmp[5]) + (tmp[3] + tmp[7]);
+#elif defined(__SSE__) || defined(__x86_64__)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    __m128 vc;
+    float tmp[4];
+    for ( ; k + 4 <= n; k += 4) {
+        vc = _mm_loadu_ps(c + k);          // c0 c1 c2 c3
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(px + 2 * k), _mm_unpacklo_ps(vc, vc)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(px + 2 * k + 4), _mm_unpackhi_ps(vc, vc)));
+    }
+    _mm_storeu_ps(tmp, _mm_add_ps(acc0, acc1));   // re im re im
+    re = tmp[0] + tmp[2];
+    im = tmp[1] + tmp[3];
+#else
+    re = im = 0.0f;
+#endif
+    for ( ; k < n; k++) {
+        re += px[2 * k] * c[k];
+        im += px[2 * k + 1] * c[k];
+    }
+    return re + I * im;
+}
+
+complex float quisk_dot_cc(const complex float * x, const complex float * c, int n)
+{
+    int k = 0;
+    float re, im;
+    const float * px = (const float *)x;
+    const float * pc = (const float *)c;
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    float32x4_t acc_re = vdupq_n_f32(0.0f);
+    float32x4_t acc_im = vdupq_n_f32(0.0f);
+    float32x4x2_t vx, vc;
+    float32x2_t t;
+    for ( ; k + 4 <= n; k += 4) {
+        vx = vld2q_f32(px + 2 * k);         // de-interleave real and imag
+        vc = vld2q_f32(pc + 2 * k);
+        acc_re = vmlaq_f32(acc_re, vx.val[0], vc.val[0]);
+        acc_re = vmlsq_f32(acc_re, vx.val[1], vc.val[1]);
+        acc_im = vmlaq_f32(acc_im, vx.val[0], vc.val[1]);
+        acc_im = vmlaq_f32(acc_im, vx.val[1], vc.val[0]);
+    }
+    t = vadd_f32(vget_low_f32(acc_re), vget_high_f32(acc_re));
+    re = vget_lane_f32(vpadd_f32(t, t), 0);
+    t = vadd_f32(vget_low_f32(acc_im), vget_high_f32(acc_im));
+    im = vget_lane_f32(vpadd_f32(t, t), 0);
+#elif defined(__AVX__)
+    // acc_r collects xr*cr, xi*cr and acc_i collects xr*ci, xi*ci
+    __m256 acc_r = _mm256_setzero_ps();
+    __m256 acc_i = _mm256_setzero_ps();
+    __m256 vx, vc;
+    float tr[8], ti[8];
+    for ( ; k + 4 <= n; k += 4) {
+        vx = _mm256_loadu_ps(px + 2 * k);
+        vc = _mm256_loadu_ps(pc + 2 * k);
+        acc_r = _mm256_add_ps(acc_r, _mm256_mul_ps(vx, _mm256_moveldup_ps(vc)));
+        acc_i = _mm256_add_ps(acc_i, _mm256_mul_ps(vx, _mm256_movehdup_ps(vc)));
+    }
+    _mm256_storeu_ps(tr, acc_r);
+    _mm256_storeu_ps(ti, acc_i);
+    re = ((tr[0] + tr[4]) + (tr[2] + tr[6])) - ((ti[1] + ti[5]) + (ti[3] + ti[7]));
+    im = ((tr[1] + tr[5]) + (tr[3] + tr[7])) + ((ti[0] + ti[4]) + (ti[2] + ti[6]));
+#elif defined(__SSE__) || defined(__x86_64__)
+    // acc_r collects xr*cr, xi*cr and acc_i collects xr*ci, xi*ci
+    __m128 acc_r = _mm_setzero_ps();
+    __m128 acc_i = _mm_setzero_ps();
+    __m128 vx, vc;
+    float tr[4], ti[4];
+    for ( ; k + 2 <= n; k += 2) {
+        vx = _mm_loadu_ps(px + 2 * k);
+        vc = _mm_loadu_ps(pc + 2 * k);
+        acc_r = _mm_add_ps(acc_r, _mm_mul_ps(vx, _mm_shuffle_ps(vc, vc, _MM_SHUFFLE(2, 2, 0, 0))));
+        acc_i = _mm_add_ps(acc_i, _mm_mul_ps(vx, _mm_shuffle_ps(vc, vc, _MM_SHUFFLE(3, 3, 1, 1))));
+    }
+    _mm_storeu_ps(tr, acc_r);
+    _mm_storeu_ps(ti, acc_i);
+    re = (tr[0] + tr[2]) - (ti[1] + ti[3]);
+    im = (tr[1] + tr[3]) + (ti[0] + ti[2]);
+#else
+    re = im = 0.0f;
+#endif
+    for ( ; k < n; k++) {
+        re += px[2 * k] * pc[2 * k] - px[2 * k + 1] * pc[2 * k + 1];
+        im += px[2 * k] * pc[2 * k + 1] + px[2 * k + 1] * pc[2 * k];
+    }
+    return re + I * im;
+}
@@ -20,23 +20,52 @@
   along with this program; if not, see <http://www.gnu.org/licenses/>.
 */
 
+/*
+  The FIR filters below keep their sample history in a double-length circular
+  delay line: each new sample is written at index and index+nTaps, so the most
+  recent nTaps samples are always contiguous (oldest first) and the inner
+  product never has to test for wrap around.
+*/
+
 struct quisk_cfFilter {        // Structure to hold the static data for FIR filters
-    float * dCoefs;    // real filter coefficients
+    const float * dCoefs;    // real filter coefficients
     complex float * cpxCoefs;   // complex filter coefficients
     int nBuf;          // dimension of cBuf
     int nTaps;         // dimension of dSamples, cSamples, dCoefs
     int decim_index;   // index of next sample for decimation
-    complex float * cSamples;   // storage for old samples
+    complex float * cSamples;   // storage for old samples, double-length delay line of 2*nTaps
     complex float * ptcSamp;    // next available position in cSamples
     complex float * cBuf;       // auxillary buffer for interpolation
+    float * dRevCoefs;          // dCoefs reversed to match the oldest-first delay line
+    complex float * cpxRevCoefs;  // cpxCoefs reversed to match the oldest-first delay line
+    float * dPolyCoefs;         // polyphase bank of dCoefs for quisk_cfInterpDecim
+    int nPolyInterp;            // interp the polyphase bank was made for, or zero
+} ;
+
+struct quisk_fFilter {         // FIR filter for real samples with real coefficients
+    float * dRevCoefs;  // filter coefficients reversed, oldest sample first
+    int nTaps;          // number of coefficients
+    int decim_index;    // number of samples since the last decimated output
+    int index;          // position of the oldest sample in dSamples
+    float * dSamples;   // double-length delay line of 2*nTaps
 } ;
 
 extern int quisk_cfInterpDecim(complex float *, int, struct quisk_cfFilter *, int, int);
-extern void quisk_filt_cfInit(struct quisk_cfFilter *, float *, int);
+extern int quisk_cfDecim(complex float *, complex float *, int, struct quisk_cfFilter *, int);
+extern void quisk_filt_cfInit(struct quisk_cfFilter *, const float *, int);
 extern void quisk_filt_destroy(struct quisk_cfFilter *);
 extern void quisk_cfTune(struct quisk_cfFilter *, float);
 extern void quisk_ccfFilter(complex float *, complex float *, int, struct quisk_cfFilter *);
 
+extern void quisk_filt_fInit(struct quisk_fFilter *, const float *, int);
+extern void quisk_filt_fDestroy(struct quisk_fFilter *);
+extern int quisk_fDecim(float *, float *, int, struct quisk_fFilter *, int);
+
+extern void quisk_fDelayPut(float *, int, int *, const float *, int);
+extern float quisk_dot_ff(const float *, const float *, int);
+extern complex float quisk_dot_cf(const complex float *, const float *, int);
+extern complex float quisk_dot_cc(const complex float *, const complex float *, int);
+
 extern float quiskFilt120t480[480];
 extern float filtP750S1040[106];
 extern float filtP550S750[160];
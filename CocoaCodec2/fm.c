@@ -33,6 +33,7 @@
 \*---------------------------------------------------------------------------*/
 
 #define FILT_MEM 200
+#define FM_OS_NFFT 512       /* overlap-save FFT size for the fast demod */
 
 /*---------------------------------------------------------------------------*\
 
@@ -75,8 +76,9 @@ struct FM *fm_create(int nsam)
     fm = (struct FM*)malloc(sizeof(struct FM));
     if (fm == NULL)
 	return NULL;
-    fm->rx_bb = (COMP*)malloc(sizeof(COMP)*(FILT_MEM+nsam));
+    fm->rx_bb = (COMP*)malloc(sizeof(COMP)*nsam);
     assert(fm->rx_bb != NULL);
+    quisk_filt_cfInit(&fm->rx_bb_filt, bin + FILT_MEM/4, FILT_MEM/2);
 
     fm->rx_bb_filt_prev.real = 0.0;
     fm->rx_bb_filt_prev.imag = 0.0;
@@ -85,22 +87,183 @@ struct FM *fm_create(int nsam)
 
     fm->tx_phase = 0;
 
-    fm->rx_dem_mem = (float*)malloc(sizeof(float)*(FILT_MEM+nsam));
-    assert(fm->rx_dem_mem != NULL);
-
     fm->nsam = nsam;
 
+    fm->lo_table = NULL;
+    fm->lo_table_wc = 0.0;
+    fm->fwd_cfg = fm->inv_cfg = NULL;
+    fm->os_H = fm->os_in = fm->os_freq = fm->os_out = NULL;
+
     return fm;
 }
 
 
 void fm_destroy(struct FM *fm_states)
 {
+    fm_set_fast_demod(fm_states, 0);
     free(fm_states->rx_bb);
-    free(fm_states->rx_dem_mem);
+    quisk_filt_destroy(&fm_states->rx_bb_filt);
     free(fm_states);
 }
 
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: fm_set_fast_demod
+  DATE CREATED: October 2026
+
+  Switches fm_demod() between the direct per sample demodulator and a
+  block version that mixes from a table of LO values, filters by
+  overlap-save FFT and uses a polynomial atan2 that the compiler can
+  vectorise.  The two agree to within the 1E-5 radian error of the
+  atan2 approximation, but changing mode part way through a stream
+  restarts the input filter.
+
+\*---------------------------------------------------------------------------*/
+
+void fm_set_fast_demod(struct FM *fm, int enable)
+{
+    kiss_fft_cpx h[FM_OS_NFFT];
+    int i, ntaps = FILT_MEM/2;
+
+    if (enable && (fm->lo_table == NULL)) {
+        fm->lo_table = (COMP*)malloc(sizeof(COMP)*fm->nsam);
+        fm->os_H = (COMP*)malloc(sizeof(COMP)*FM_OS_NFFT);
+        fm->os_in = (COMP*)calloc(FM_OS_NFFT, sizeof(COMP));
+        fm->os_freq = (COMP*)malloc(sizeof(COMP)*FM_OS_NFFT);
+        fm->os_out = (COMP*)malloc(sizeof(COMP)*FM_OS_NFFT);
+        fm->fwd_cfg = kiss_fft_alloc(FM_OS_NFFT, 0, NULL, NULL);
+        fm->inv_cfg = kiss_fft_alloc(FM_OS_NFFT, 1, NULL, NULL);
+        assert((fm->lo_table != NULL) && (fm->os_H != NULL) && (fm->os_in != NULL));
+        assert((fm->os_freq != NULL) && (fm->os_out != NULL));
+        assert((fm->fwd_cfg != NULL) && (fm->inv_cfg != NULL));
+
+        /* built on first use, as Fs and fc may not be set yet */
+
+        fm->lo_table_wc = 0.0;
+
+        /* same taps as rx_bb_filt, with the 1/N of the inverse FFT folded in */
+
+        for(i=0; i<FM_OS_NFFT; i++) {
+            h[i].r = (i < ntaps) ? bin[FILT_MEM/4 + i]/FM_OS_NFFT : 0.0;
+            h[i].i = 0.0;
+        }
+        kiss_fft(fm->fwd_cfg, h, (kiss_fft_cpx *)fm->os_H);
+    }
+
+    if (!enable && (fm->lo_table != NULL)) {
+        free(fm->lo_table);
+        free(fm->os_H);
+        free(fm->os_in);
+        free(fm->os_freq);
+        free(fm->os_out);
+        KISS_FFT_FREE(fm->fwd_cfg);
+        KISS_FFT_FREE(fm->inv_cfg);
+        fm->lo_table = NULL;
+        fm->fwd_cfg = fm->inv_cfg = NULL;
+        fm->os_H = fm->os_in = fm->os_freq = fm->os_out = NULL;
+    }
+}
+
+
+/*
+  atan2f() to about 1E-5 radians.  Written without branches so the
+  discriminator loop vectorises.
+*/
+
+static inline float fast_atan2f(float y, float x)
+{
+    float ax = fabsf(x), ay = fabsf(y);
+    float mx = (ax > ay) ? ax : ay;
+    float mn = (ax > ay) ? ay : ax;
+    float a = mn/(mx + 1E-30f);
+    float s = a*a;
+    float r = ((-0.0464964749f*s + 0.15931422f)*s - 0.327622764f)*s*a + a;
+
+    r = (ay > ax) ? (float)(M_PI/2) - r : r;
+    r = (x < 0.0f) ? (float)M_PI - r : r;
+    return copysignf(r, y);
+}
+
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: fm_demod_fast
+  DATE CREATED: October 2026
+
+  Block version of fm_demod().  Each FM_OS_NFFT point FFT filters up
+  to FM_OS_NFFT-ntaps+1 new samples, which are mixed straight into the
+  FFT input after the ntaps-1 samples of filter history.
+
+\*---------------------------------------------------------------------------*/
+
+static void fm_demod_fast(struct FM *fm, float rx_out[], float rx[])
+{
+  float  wc = 2*M_PI*fm->fc/fm->Fs;
+  float  wd = 2*M_PI*fm->fd/fm->Fs;
+  float  one_on_wd = 1/wd;
+  int    nsam = fm->nsam;
+  int    nhist = FILT_MEM/2 - 1;
+  int    nstep = FM_OS_NFFT - nhist;
+  COMP  *lo_table = fm->lo_table;
+  COMP  *os_in = fm->os_in;
+  COMP  *os_out = fm->os_out;
+  COMP   lo, diff;
+  float  rx_dem, mag;
+  int    i, n, j;
+
+  if (wc != fm->lo_table_wc) {
+      for(i=0; i<nsam; i++) {
+          lo_table[i].real = cosf(wc*(i+1));
+          lo_table[i].imag = -sinf(wc*(i+1));
+      }
+      fm->lo_table_wc = wc;
+  }
+
+  for(n=0; n<nsam; n+=nstep) {
+      j = (nsam - n < nstep) ? nsam - n : nstep;
+
+      /* down to complex baseband, lo_table[] is relative to the start of the frame */
+
+      for(i=0; i<j; i++) {
+          lo = cmult(fm->lo_phase, lo_table[n+i]);
+          os_in[nhist+i] = fcmult(rx[n+i], lo);
+      }
+      for(i=nhist+j; i<FM_OS_NFFT; i++)
+          os_in[i].real = os_in[i].imag = 0.0;
+
+      /* overlap-save input FIR filter, the first nhist outputs are circular
+         convolution wrap around and are discarded */
+
+      kiss_fft(fm->fwd_cfg, (kiss_fft_cpx *)os_in, (kiss_fft_cpx *)fm->os_freq);
+      for(i=0; i<FM_OS_NFFT; i++)
+          fm->os_freq[i] = cmult(fm->os_freq[i], fm->os_H[i]);
+      kiss_fft(fm->inv_cfg, (kiss_fft_cpx *)fm->os_freq, (kiss_fft_cpx *)os_out);
+      memmove(os_in, &os_in[j], sizeof(COMP)*nhist);
+
+      /* discriminator, same limiter as fm_demod().  The last filter output of
+         the previous block goes in a discarded slot so the loop has no special
+         first case */
+
+      os_out[nhist-1] = fm->rx_bb_filt_prev;
+      for(i=0; i<j; i++) {
+          diff = cmult(os_out[nhist+i], cconj(os_out[nhist+i-1]));
+          rx_dem = fast_atan2f(diff.imag, diff.real);
+          rx_dem = (rx_dem > wd) ? wd : rx_dem;
+          rx_dem = (rx_dem < -wd) ? -wd : rx_dem;
+          rx_out[n+i] = rx_dem*one_on_wd;
+      }
+      fm->rx_bb_filt_prev = os_out[nhist+j-1];
+  }
+
+  /* advance the LO by the whole frame, then normalise as in fm_demod() */
+
+  fm->lo_phase = cmult(fm->lo_phase, lo_table[nsam-1]);
+  mag = cabsolute(fm->lo_phase);
+  fm->lo_phase.real /= mag;
+  fm->lo_phase.imag /= mag;
+}
+
 /*---------------------------------------------------------------------------*\
 
   FUNCTION....: fm_demod
@@ -118,39 +281,36 @@ void fm_demod(struct FM *fm_states, float rx_out[], float rx[])
   float  wc = 2*M_PI*fc/Fs;
   float  fd = fm_states->fd;
   float  wd = 2*M_PI*fd/Fs;
-  COMP  *rx_bb = fm_states->rx_bb + FILT_MEM;
+  COMP  *rx_bb = fm_states->rx_bb;
   COMP   wc_rect, rx_bb_filt, rx_bb_diff;
   float  rx_dem;
-  /*
-  float acc;
-  */
-  float *rx_dem_mem = fm_states->rx_dem_mem + FILT_MEM;
   int    nsam = fm_states->nsam;
   float  mag;
-  int    i,k;
+  int    i;
 
-  wc_rect.real = cosf(wc); wc_rect.imag = -sinf(wc);
+  if (fm_states->lo_table != NULL) {
+      fm_demod_fast(fm_states, rx_out, rx);
+      return;
+  }
 
-  for(i=0; i<nsam; i++) {
+  wc_rect.real = cosf(wc); wc_rect.imag = -sinf(wc);
 
-      /* down to complex baseband */
+  /* down to complex baseband */
 
+  for(i=0; i<nsam; i++) {
       fm_states->lo_phase = cmult(fm_states->lo_phase, wc_rect);
       rx_bb[i] = fcmult(rx[i], fm_states->lo_phase);
+  }
 
-      /* input FIR filter */
+  /* input FIR filter, in place */
 
-      rx_bb_filt.real = 0.0; rx_bb_filt.imag = 0.0;
+  quisk_cfDecim((complex float *)rx_bb, (complex float *)rx_bb, nsam, &fm_states->rx_bb_filt, 1);
 
-      for(k=0; k<FILT_MEM/2; k++) {
-          rx_bb_filt.real += rx_bb[i-k].real * bin[k+FILT_MEM/4];
-          rx_bb_filt.imag += rx_bb[i-k].imag * bin[k+FILT_MEM/4];
-      }
+  for(i=0; i<nsam; i++) {
+      rx_bb_filt = rx_bb[i];
 
-      //rx_bb_filt = rx_bb[i];
       //printf("%f %f %f\n", rx[i], wc_rect.real, wc_rect.imag);
       //printf("%f %f %f\n", rx[i], fm_states->lo_phase.real, fm_states->lo_phase.imag);
-      //printf("%f %f %f\n", rx[i], rx_bb[i].real, rx_bb[i].imag);
       //printf("%f %f\n", rx_bb_filt.real, rx_bb_filt.imag);
       /*
          Differentiate first, in rect domain, then find angle, this
@@ -172,25 +332,9 @@ void fm_demod(struct FM *fm_states, float rx_out[], float rx[])
 
       rx_dem *= (1/wd);
       //printf("%f %f\n", rx_bb_diff.real, rx_bb_diff.imag);
-      rx_dem_mem[i] = rx_dem;
-      /*
-      acc = 0;
-        for(k=0; k<FILT_MEM; k++) {
-          acc += rx_dem_mem[i-k] * bout[k];
-      }
-      */
       rx_out[i] = rx_dem;
   }
 
-  /* update filter memories */
-
-  rx_bb      -= FILT_MEM;
-  rx_dem_mem -= FILT_MEM;
-  for(i=0; i<FILT_MEM; i++) {
-      rx_bb[i] = rx_bb[i+nsam];
-      rx_dem_mem[i] = rx_dem_mem[i+nsam];
-  }
-
   /* normalise digital oscillator as the magnitude can drift over time */
 
   mag = cabsolute(fm_states->lo_phase);
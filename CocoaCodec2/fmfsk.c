@@ -63,6 +63,7 @@ struct FMFSK * fmfsk_create(int Fs,int Rb){
     fmfsk->Ts = Fs/fmfsk->Rs;
     fmfsk->N = nbits*2*fmfsk->Ts;
     fmfsk->nmem = fmfsk->N+(fmfsk->Ts*4);
+    fmfsk->nfilt = fmfsk->nmem-fmfsk->Ts+1;
     fmfsk->nsym = nbits*2;
     fmfsk->nbit = nbits;
     
@@ -70,20 +71,27 @@ struct FMFSK * fmfsk_create(int Fs,int Rb){
     fmfsk->lodd = 0;
     fmfsk->nin = fmfsk->N;
     fmfsk->snr_mean = 0;
+    fmfsk->norm_rx_timing = 0;
+    fmfsk->ppm = 0;
     
-    float *oldsamps = malloc(sizeof(float)*fmfsk->nmem);
-    if(oldsamps == NULL){
-        free(fmfsk);
+    /* Demod buffers, allocated once here rather than on every call */
+    fmfsk->integ_mem = calloc(fmfsk->Ts, sizeof(float));
+    fmfsk->integ_out = malloc(sizeof(float)*(fmfsk->N+fmfsk->Ts));
+    fmfsk->rx_filt = calloc(2*fmfsk->nfilt, sizeof(float));
+    fmfsk->rx_filt_index = 0;
+    fmfsk->ft_sum = malloc(sizeof(float)*fmfsk->Ts);
+    fmfsk->ft_table = malloc(sizeof(COMP)*fmfsk->Ts);
+    fmfsk->stats = (struct MODEM_STATS*)malloc(sizeof(struct MODEM_STATS));
+    if(fmfsk->integ_mem == NULL || fmfsk->integ_out == NULL || fmfsk->rx_filt == NULL ||
+       fmfsk->ft_sum == NULL || fmfsk->ft_table == NULL || fmfsk->stats == NULL){
+        fmfsk_destroy(fmfsk);
         return NULL;
     }
     
-    fmfsk->oldsamps = oldsamps;
-
-    fmfsk->stats = (struct MODEM_STATS*)malloc(sizeof(struct MODEM_STATS));
-    if (fmfsk->stats == NULL) {
-        free(oldsamps);
-        free(fmfsk);
-        return NULL;
+    /* As Ts = Fs/Rs the Rs fine timing line repeats every Ts samples */
+    for(int i=0; i<fmfsk->Ts; i++){
+        fmfsk->ft_table[i].real = cos(2*M_PI*(double)i/fmfsk->Ts);
+        fmfsk->ft_table[i].imag = sin(2*M_PI*(double)i/fmfsk->Ts);
     }
     
     return fmfsk;
@@ -93,7 +101,12 @@ struct FMFSK * fmfsk_create(int Fs,int Rb){
  * Destroys an fmfsk modem and deallocates memory
  */
 void fmfsk_destroy(struct FMFSK *fmfsk){
-    free(fmfsk->oldsamps);
+    free(fmfsk->integ_mem);
+    free(fmfsk->integ_out);
+    free(fmfsk->rx_filt);
+    free(fmfsk->ft_sum);
+    free(fmfsk->ft_table);
+    free(fmfsk->stats);
     free(fmfsk);
 }
 
@@ -168,17 +181,11 @@ void fmfsk_mod(struct FMFSK *fmfsk, float fmfsk_out[],uint8_t bits_in[]){
 void fmfsk_demod(struct FMFSK *fmfsk, uint8_t rx_bits[],float fmfsk_in[]){
     int i,j,k;
     int Ts          = fmfsk->Ts;
-    int Fs          = fmfsk->Fs;
-    int Rs          = fmfsk->Rs;
     int nin         = fmfsk->nin;
     int N           = fmfsk->N;
     int nsym        = fmfsk->nsym;
     int nbit        = fmfsk->nbit;
-    int nmem        = fmfsk->nmem;
-    float *oldsamps = fmfsk->oldsamps;
-    int nold        =  nmem-nin;
-    COMP phi_ft,dphi_ft;    /* Phase and delta-phase for fine timing estimator */
-    float t;
+    int nfilt       = fmfsk->nfilt;
     COMP x;                 /* Magic fine timing angle */
     float norm_rx_timing,old_norm_rx_timing,d_norm_rx_timing,appm;
     int rx_timing,sample_offset;
@@ -190,52 +197,58 @@ void fmfsk_demod(struct FMFSK *fmfsk, uint8_t rx_bits[],float fmfsk_in[]){
     float eye_max;
     uint8_t mbit;
     float var_signal = 0, var_noise = 0, lastFabsV;
+    float *integ_mem = fmfsk->integ_mem;
+    float *integ_out = fmfsk->integ_out;
+    float *ft_sum = fmfsk->ft_sum;
+    float sum;
     
-    /* Shift in nin samples */
-    memmove(&oldsamps[0]   , &oldsamps[nmem-nold], sizeof(float)*nold);
-    memcpy (&oldsamps[nold], &fmfsk_in[0]        , sizeof(float)*nin );
+    assert(nin >= Ts && nin <= N+Ts);
     
-    /* Allocate memory for filtering */
-    float *rx_filt = alloca(sizeof(float)*(nsym+1)*Ts);
-    
-    /* Integrate over Ts input symbols at every offset */
-    for(i=0; i<(nsym+1)*Ts; i++){
-        t=0;
-        /* Integrate over some samples */
-        for(j=i;j<i+Ts;j++){
-            t += oldsamps[j];
-        }
-        rx_filt[i] = t;
+    /* Integrate over Ts input symbols for each of the nin new samples, as a
+       running sum.  The sum restarts from the saved samples each call so
+       rounding errors can't build up */
+    sum = 0;
+    for(i=0; i<Ts; i++)
+        sum += integ_mem[i];
+    for(i=0; i<Ts; i++){
+        sum += fmfsk_in[i] - integ_mem[i];
+        integ_out[i] = sum;
     }
+    for(i=Ts; i<nin; i++){
+        sum += fmfsk_in[i] - fmfsk_in[i-Ts];
+        integ_out[i] = sum;
+    }
+    memcpy(integ_mem, &fmfsk_in[nin-Ts], sizeof(float)*Ts);
+    
+    /* Shift them into the delay line, rx_filt[0] is then the oldest output
+       we keep, integrated over the oldest Ts of the last nmem samples */
+    quisk_fDelayPut(fmfsk->rx_filt, nfilt, &fmfsk->rx_filt_index, integ_out, nin);
+    float *rx_filt = fmfsk->rx_filt + fmfsk->rx_filt_index;
     
     /*
      *  Fine timing estimation
      *
      * Estimate fine timing using line at Rs/2 that Manchester encoding provides
      * We need this to sync up to Manchester codewords.
+     *
+     * The downshift oscillator has a period of Ts samples, so the squared
+     * samples are first summed modulo Ts and then mixed with one period of
+     * ft_table.
      */
     
-    /* init fine timing extractor */
-    phi_ft.real = 1;
-    phi_ft.imag = 0;
-    
-    /* Set up delta-phase */ 
-    dphi_ft.real = cosf(2*M_PI*((float)Rs)/((float)Fs));
-    dphi_ft.imag = sinf(2*M_PI*((float)Rs)/((float)Fs));
+    for(k=0; k<Ts; k++)
+        ft_sum[k] = 0;
+    for(i=0; i<(nsym+1)*Ts; i+=Ts){
+        /* Apply non-linearity */
+        for(k=0; k<Ts; k++)
+            ft_sum[k] += rx_filt[i+k]*rx_filt[i+k];
+    }
     
     x.real = 0;
     x.imag = 0;
-    
-    for(i=0; i<(nsym+1)*Ts; i++){
-        /* Apply non-linearity */
-        t = rx_filt[i]*rx_filt[i];
-        
+    for(k=0; k<Ts; k++){
         /* Shift Rs/2 down to DC and accumulate */
-        x = cadd(x,fcmult(t,phi_ft));
-        
-        /* Spin downshift oscillator */
-        phi_ft = cmult(dphi_ft,phi_ft);
-        modem_probe_samp_c("t_phi_ft",&phi_ft,1);
+        x = cadd(x,fcmult(ft_sum[k],fmfsk->ft_table[k]));
     }
     
     /* Figure out the normalized RX timing, using David's magic number */
@@ -31,6 +31,7 @@
 #include <stdint.h>
 #include "comp.h"
 #include "modem_stats.h"
+#include "filter.h"
 
 #define FMFSK_SCALE 16383
 
@@ -47,11 +48,17 @@ struct FMFSK{
     int nsym;           /* Number of raw modem symbols processed per demod call */
     int nbit;           /* Number of bits spit out per demod call */
     int nmem;           /* Number of samples kept around between demod calls */
+    int nfilt;          /* Number of integrator outputs kept, nmem-Ts+1 */
     
     /* State kept by demod */
     int nin;            /* Number of samples to be demod-ed the next cycle */
     int lodd;           /* Last integrated sample for odd bitstream generation */
-    float * oldsamps;   /* Memory of old samples to make clock-offset-tolerance possible */
+    float * integ_mem;  /* Last Ts input samples, for the running sum integrator */
+    float * integ_out;  /* Integrator outputs of the current call, up to N+Ts/2 */
+    float * rx_filt;    /* Double-length delay line of integrator outputs, to make clock-offset-tolerance possible */
+    int rx_filt_index;  /* Position of the oldest integrator output in rx_filt */
+    float * ft_sum;     /* Squared rx_filt folded modulo Ts, for fine timing */
+    COMP * ft_table;    /* exp(j*2*pi*Rs*k/Fs), one period of the Rs fine timing line */
     
     /* Stats generated by demod */
     float norm_rx_timing; /* RX Timing, used to calculate clock offset */
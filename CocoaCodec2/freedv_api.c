@@ -119,6 +119,8 @@ struct freedv *freedv_open_advanced(int mode, struct freedv_advanced *adv) {
     f->error_pattern_callback_state = NULL;
     f->n_protocol_bits = 0;
     f->frames = 0;
+    f->idle_detect = NULL;
+    f->ext_vco = 0;
     
     /* Init states for this mode, and set up samples in/out -----------------------------------------*/
     
@@ -203,27 +205,24 @@ struct freedv *freedv_open_advanced(int mode, struct freedv_advanced *adv) {
         f->squelch_en = 0;
         codec2_mode = CODEC2_MODE_700C;
 
-        if ((ofdm_config = (struct OFDM_CONFIG *) calloc(1, sizeof (struct OFDM_CONFIG))) == NULL) {
-            if (f->tx_bits != NULL) {
-              free(f->tx_bits);
-              f->tx_bits = NULL;
-            }
-            if (f->rx_bits != NULL) {
-              free(f->rx_bits);
-              f->rx_bits = NULL;
-            }
-            return NULL;
-        }
+        /* nc = 0 selects the default 700D modem config */
+
+        struct OFDM_CONFIG default_config;
+        memset(&default_config, 0, sizeof(struct OFDM_CONFIG));
 
-        f->ofdm = ofdm_create(ofdm_config);
-        free(ofdm_config);
+        f->ofdm = ofdm_create(&default_config);
 
-        /* Get a copy of the actual modem config */
-        ofdm_config = ofdm_get_config_param();
+        /* Get a copy of the actual modem config.  It's the same for every
+           700D instance, so set it up once rather than writing to it while
+           other instances may be running */
 
-        ofdm_bitsperframe = ofdm_get_bits_per_frame();
-        ofdm_nuwbits = (ofdm_config->ns - 1) * ofdm_config->bps - ofdm_config->txtbits;
-        ofdm_ntxtbits = ofdm_config->txtbits;
+        if (ofdm_config == NULL) {
+            ofdm_config = ofdm_get_config_param();
+
+            ofdm_bitsperframe = ofdm_get_bits_per_frame();
+            ofdm_nuwbits = (ofdm_config->ns - 1) * ofdm_config->bps - ofdm_config->txtbits;
+            ofdm_ntxtbits = ofdm_config->txtbits;
+        }
 
         f->ldpc = (struct LDPC*)malloc(sizeof(struct LDPC));
 
@@ -232,6 +231,7 @@ struct freedv *freedv_open_advanced(int mode, struct freedv_advanced *adv) {
         }
 
         set_up_hra_112_112(f->ldpc, ofdm_config);
+        f->ldpc->enc = ldpc_enc_create(f->ldpc);     /* falls back to encode() if NULL */
         int coded_syms_per_frame = f->ldpc->coded_syms_per_frame;
         
         if (adv == NULL) {
@@ -243,15 +243,36 @@ struct freedv *freedv_open_advanced(int mode, struct freedv_advanced *adv) {
 
         f->modem_frame_count_tx = f->modem_frame_count_rx = 0;
         
-        f->codeword_symbols = (COMP*)malloc(sizeof(COMP)*f->interleave_frames*coded_syms_per_frame);
+        /* the interleaver window is a ring of frames, each frame is stored
+           at slot k and k+interleave_frames so the window can be read in
+           order from the oldest frame */
+
+        f->codeword_head = 0;
+        f->ldpc_max_iter_default = f->ldpc->max_iter;
+        f->ldpc_iter = 0;
+        f->ldpc_unsatisfied = 0;
+        f->codeword_symbols = (COMP*)malloc(sizeof(COMP)*2*f->interleave_frames*coded_syms_per_frame);
 
         if (f->codeword_symbols == NULL) {return NULL;}
 
-        f->codeword_amps = (float*)malloc(sizeof(float)*f->interleave_frames*coded_syms_per_frame);
+        f->codeword_amps = (float*)malloc(sizeof(float)*2*f->interleave_frames*coded_syms_per_frame);
 
         if (f->codeword_amps == NULL) {free(f->codeword_symbols); return NULL;}
 
-        for (int i=0; i<f->interleave_frames*coded_syms_per_frame; i++) {
+        f->interleaver = gp_interleaver_create(f->interleave_frames*coded_syms_per_frame);
+
+        if (f->interleaver == NULL) {
+            free(f->codeword_symbols);
+            free(f->codeword_amps);
+            if (f->ldpc->enc)
+                ldpc_enc_destroy(f->ldpc->enc);
+            free(f->ldpc);
+            ofdm_destroy(f->ofdm);
+            free(f);
+            return NULL;
+        }
+
+        for (int i=0; i<2*f->interleave_frames*coded_syms_per_frame; i++) {
             f->codeword_symbols[i].real = 0.0;
             f->codeword_symbols[i].imag = 0.0;
             f->codeword_amps[i] = 0.0;
@@ -271,7 +292,14 @@ struct freedv *freedv_open_advanced(int mode, struct freedv_advanced *adv) {
         f->mod_out = (COMP*)malloc(sizeof(COMP)*f->interleave_frames*f->n_nat_modem_samples);
 
         if (f->mod_out == NULL) {
-            if (f->codeword_symbols != NULL) { free (f->codeword_symbols); }
+            free(f->codeword_symbols);
+            free(f->codeword_amps);
+            gp_interleaver_destroy(f->interleaver);
+            if (f->ldpc->enc)
+                ldpc_enc_destroy(f->ldpc->enc);
+            free(f->ldpc);
+            ofdm_destroy(f->ofdm);
+            free(f);
             return NULL;
         }
 
@@ -293,7 +321,6 @@ struct freedv *freedv_open_advanced(int mode, struct freedv_advanced *adv) {
         /* Set the number of protocol bits */
         f->n_protocol_bits = 20;
         f->sz_error_pattern = 0;
-        f->ext_vco = 0;
     }
     
     if (mode == FREEDV_MODE_2400A) {
@@ -469,6 +496,13 @@ struct freedv *freedv_open_advanced(int mode, struct freedv_advanced *adv) {
         f->ptFilter8000to7500 = NULL;
     }
 
+    /* Sound card sample rate conversion is off until requested */
+
+    f->sound_card_samp_rate = 0;
+    f->sc_rx_in = f->sc_rx_out = f->sc_tx_in = f->sc_tx_out = NULL;
+    f->sc_rx_fifo = f->sc_tx_fifo = NULL;
+    f->sc_modem_buf = f->sc_speech_buf = NULL;
+
     /* Varicode low bit rate text states */
     
     varicode_decode_init(&f->varicode_dec_states, 1);
@@ -483,6 +517,10 @@ struct freedv *freedv_open_advanced(int mode, struct freedv_advanced *adv) {
     return f;
 }
 
+static void freedv_sound_card_free(struct freedv *f);
+static int freedv_idle(struct freedv *f, const void *demod_in, const struct MODEM_IO *io, int nin);
+static void freedv_comptx_io(struct freedv *f, void *mod_out, const struct MODEM_IO *io, short speech_in[]);
+
 /*---------------------------------------------------------------------------*\
 
   FUNCTION....: freedv_close
@@ -509,6 +547,9 @@ void freedv_close(struct freedv *freedv) {
         free(freedv->mod_out);
         free(freedv->codeword_symbols);
         free(freedv->codeword_amps);
+        gp_interleaver_destroy(freedv->interleaver);
+        if (freedv->ldpc->enc)
+            ldpc_enc_destroy(freedv->ldpc->enc);
         free(freedv->ldpc);
         ofdm_destroy(freedv->ofdm);
     }
@@ -534,6 +575,8 @@ void freedv_close(struct freedv *freedv) {
         free(freedv->ptFilter7500to8000);
         freedv->ptFilter7500to8000 = NULL;
     }
+    tone_detect_destroy(freedv->idle_detect);
+    freedv_sound_card_free(freedv);
     free(freedv);
 }
 
@@ -581,7 +624,7 @@ void freedv_close(struct freedv *freedv) {
 static void freedv_tx_fsk_voice(struct freedv *f, short mod_out[]) {
     int  i;
     float *tx_float; /* To hold on to modulated samps from fsk/fmfsk */
-    uint8_t vc_bits[2]; /* Varicode bits for 2400 framing */
+    uint8_t vc_bits[2] = {0, 0}; /* Varicode bits for 2400 framing, zero until a char is encoded */
     uint8_t proto_bits[3]; /* Prococol bits for 2400 framing */
 
     /* Frame for 2400A/B */
@@ -651,7 +694,7 @@ static void freedv_tx_fsk_voice(struct freedv *f, short mod_out[]) {
 static void freedv_comptx_fsk_voice(struct freedv *f, COMP mod_out[]) {
     int  i;
     float *tx_float; /* To hold on to modulated samps from fsk/fmfsk */
-    uint8_t vc_bits[2]; /* Varicode bits for 2400 framing */
+    uint8_t vc_bits[2] = {0, 0}; /* Varicode bits for 2400 framing, zero until a char is encoded */
     uint8_t proto_bits[3]; /* Prococol bits for 2400 framing */
 
     /* Frame for 2400A/B */
@@ -741,8 +784,15 @@ static void freedv_tx_fsk_data(struct freedv *f, short mod_out[]) {
 }
 
 void freedv_tx(struct freedv *f, short mod_out[], short speech_in[]) {
+    const struct MODEM_IO io = { MODEM_IO_SHORT, 1.0 };
+
+    freedv_tx_io(f, mod_out, speech_in, &io);
+}
+
+/* freedv_tx() writing the modem samples in any of the MODEM_IO formats */
+
+void freedv_tx_io(struct freedv *f, void *mod_out, short speech_in[], const struct MODEM_IO *io) {
     assert(f != NULL);
-    COMP tx_fdm[f->n_nom_modem_samples];
     int  i;
     assert((f->mode == FREEDV_MODE_1600)  || (f->mode == FREEDV_MODE_700)   || 
            (f->mode == FREEDV_MODE_700B)  || (f->mode == FREEDV_MODE_700C)  ||
@@ -762,11 +812,22 @@ void freedv_tx(struct freedv *f, short mod_out[], short speech_in[]) {
         }else{
             codec2_encode(f->codec2, f->packed_codec_bits, speech_in);
         }
-        freedv_tx_fsk_voice(f, mod_out);
+        if ((io->format == MODEM_IO_SHORT) && (io->scale == 1.0)) {
+            freedv_tx_fsk_voice(f, mod_out);
+        }
+        else {
+            short tx_real[f->n_nom_modem_samples];
+            COMP  x;
+
+            freedv_tx_fsk_voice(f, tx_real);
+            x.imag = 0.0;
+            for(i=0; i<f->n_nom_modem_samples; i++) {
+                x.real = tx_real[i];
+                modem_io_put(io, mod_out, i, x);
+            }
+        }
     } else{
-        freedv_comptx(f, tx_fdm, speech_in);
-        for(i=0; i<f->n_nom_modem_samples; i++)
-            mod_out[i] = tx_fdm[i].real;
+        freedv_comptx_io(f, mod_out, io, speech_in);
     }
 }
 
@@ -1021,6 +1082,9 @@ static void freedv_comptx_700d(struct freedv *f, COMP mod_out[]) {
             txt_bits[k] = f->tx_varicode_bits[f->varicode_bit_index++];
             f->nvaricode_bits--;
         }
+        else {
+            txt_bits[k] = 0;
+        }
     }
 
     /* optionally replace codec payload bits with test frames known to rx */
@@ -1041,7 +1105,7 @@ static void freedv_comptx_700d(struct freedv *f, COMP mod_out[]) {
     complex float tx_sams[f->interleave_frames*f->n_nat_modem_samples];
     COMP asam;
     
-    ofdm_ldpc_interleave_tx(f->ofdm, f->ldpc, tx_sams, tx_bits, txt_bits, f->interleave_frames, ofdm_config);
+    ofdm_ldpc_interleave_tx_gp(f->ofdm, f->ldpc, f->interleaver, tx_sams, tx_bits, txt_bits, f->interleave_frames, ofdm_config);
 
     for(i=0; i<f->interleave_frames*f->n_nat_modem_samples; i++) {
         asam.real = crealf(tx_sams[i]);
@@ -1059,6 +1123,16 @@ static void freedv_comptx_700d(struct freedv *f, COMP mod_out[]) {
 
 
 void freedv_comptx(struct freedv *f, COMP mod_out[], short speech_in[]) {
+    freedv_comptx_io(f, mod_out, &modem_io_comp, speech_in);
+}
+
+/*
+ * 700D is written straight from the interleaved frames to mod_out in
+ * the caller's format.  The other modems write COMP, which goes straight
+ * into mod_out if that is the format asked for.
+ */
+
+static void freedv_comptx_io(struct freedv *f, void *mod_out_io, const struct MODEM_IO *io, short speech_in[]) {
     assert(f != NULL);
 
     assert((f->mode == FREEDV_MODE_1600) || (f->mode == FREEDV_MODE_700) || 
@@ -1066,6 +1140,11 @@ void freedv_comptx(struct freedv *f, COMP mod_out[], short speech_in[]) {
            (f->mode == FREEDV_MODE_2400A) || (f->mode == FREEDV_MODE_2400B) ||
            (f->mode == FREEDV_MODE_700D));
 
+    int   direct = ((io->format == MODEM_IO_FLOAT_IQ) && (io->scale == 1.0)) || (f->mode == FREEDV_MODE_700D);
+    COMP  tx_fdm[direct ? 1 : f->n_nom_modem_samples];
+    COMP *mod_out = direct ? (COMP *)mod_out_io : tx_fdm;
+    int   i;
+
     if (f->mode == FREEDV_MODE_1600) {
         codec2_encode(f->codec2, f->packed_codec_bits, speech_in);
         freedv_comptx_fdmdv_1600(f, mod_out);
@@ -1075,7 +1154,7 @@ void freedv_comptx(struct freedv *f, COMP mod_out[], short speech_in[]) {
 
     int bits_per_codec_frame = codec2_bits_per_frame(f->codec2);
     int bytes_per_codec_frame = (bits_per_codec_frame + 7) / 8;
-    int i,j;
+    int j;
     
     /* all these modes need to pack a bunch of codec frames into one modem frame */
     
@@ -1117,8 +1196,9 @@ void freedv_comptx(struct freedv *f, COMP mod_out[], short speech_in[]) {
 
         /* output n_nom_modem_samples at a time from modulated buffer */
         for(i=0; i<f->n_nat_modem_samples; i++) {
-            mod_out[i] = f->mod_out[f->modem_frame_count_tx*f->n_nat_modem_samples+i];
+            modem_io_put(io, mod_out_io, i, f->mod_out[f->modem_frame_count_tx*f->n_nat_modem_samples+i]);
         }
+        return;
     }
     
 #endif
@@ -1127,6 +1207,11 @@ void freedv_comptx(struct freedv *f, COMP mod_out[], short speech_in[]) {
     	codec2_encode(f->codec2, f->packed_codec_bits, speech_in);
         freedv_comptx_fsk_voice(f,mod_out);
     }
+
+    if (!direct) {
+        for(i=0; i<f->n_nom_modem_samples; i++)
+            modem_io_put(io, mod_out_io, i, tx_fdm[i]);
+    }
 }
 
 void freedv_codectx(struct freedv *f, short mod_out[], unsigned char *packed_codec_bits) {
@@ -1271,53 +1356,33 @@ int freedv_nin(struct freedv *f) {
 
 int freedv_rx(struct freedv *f, short speech_out[], short demod_in[]) {
     assert(f != NULL);
-    int i;
-    int nin = freedv_nin(f);
+    struct MODEM_IO io = { MODEM_IO_SHORT, 1.0 };
 
-    assert(nin <= f->n_max_modem_samples);
+    assert(freedv_nin(f) <= f->n_max_modem_samples);
        
-    /* FSK RX happens in real floats, so convert to those and call their demod here */
-    if( (f->mode == FREEDV_MODE_2400A) || (f->mode == FREEDV_MODE_2400B) || (f->mode == FREEDV_MODE_800XA) ){
-        float rx_float[f->n_max_modem_samples];
-        for(i=0; i<nin; i++) {
-            rx_float[i] = ((float)demod_in[i]);
-        }
-        return freedv_floatrx(f,speech_out,rx_float);
+    if (f->mode == FREEDV_MODE_700D) {
+        io.scale = 2.0; /* keep levels the same as Octave simulations and C unit tests for real signals */
     }
-    
-    if ( (f->mode == FREEDV_MODE_1600) || (f->mode == FREEDV_MODE_700) || (f->mode == FREEDV_MODE_700B) ||
-        (f->mode == FREEDV_MODE_700C) || (f->mode == FREEDV_MODE_700D)) {
-
-        float gain = 1.0;
-        if (f->mode == FREEDV_MODE_700D) {
-            gain = 2.0; /* keep levels the same as Octave simulations and C unit tests for real signals */
-        }
         
-        /* FDM RX happens with complex samps, so do that */
-        COMP rx_fdm[f->n_max_modem_samples];
-        for(i=0; i<nin; i++) {
-            rx_fdm[i].real = gain*(float)demod_in[i];
-            rx_fdm[i].imag = 0.0;
-        }
-        return freedv_comprx(f, speech_out, rx_fdm);
-    }
-    
-    return 0; /* should never get here */
+    return freedv_rx_io(f, speech_out, demod_in, &io);
 }
 
 
 // float input samples version
 int freedv_comprx_fsk(struct freedv *f, COMP demod_in[], int *valid) {
     /* Varicode and protocol bits */
-    uint8_t vc_bits[2];
+    uint8_t vc_bits[2] = {0, 0}; /* Varicode bits, HF type B frames don't carry any */
     uint8_t proto_bits[3];
-    short vc_bit;
+    unsigned char vc_packed;
     int i;
     int n_ascii;
-    char ascii_out;
+    char ascii_out[2];
+
+    /* 2400A and 800XA hard decisions come packed, straight into the deframer */
+    int packed = (f->mode == FREEDV_MODE_2400A || f->mode == FREEDV_MODE_800XA);
 
     if(f->mode == FREEDV_MODE_2400A || f->mode == FREEDV_MODE_800XA){        
-	fsk_demod(f->fsk,(uint8_t*)f->tx_bits,demod_in);
+	fsk_demod_packed(f->fsk,(uint8_t*)f->tx_bits,demod_in);
         f->nin = fsk_nin(f->fsk);
         float EbNodB = f->fsk->stats->snr_est;           /* fsk demod actually estimates Eb/No     */
         f->snr_est = EbNodB + 10.0*log10f(800.0/3000.0); /* so convert to SNR Rb=800, noise B=3000 */
@@ -1333,14 +1398,18 @@ int freedv_comprx_fsk(struct freedv *f, COMP demod_in[], int *valid) {
         f->nin = fmfsk_nin(f->fmfsk);
     }
     
-    if(fvhff_deframe_bits(f->deframer,f->packed_codec_bits,proto_bits,vc_bits,(uint8_t*)f->tx_bits)){
-        /* Decode varicode text */
-        for(i=0; i<2; i++){
-            /* Note: deframe_bits spits out bits in uint8_ts while varicode_decode expects shorts */
-            vc_bit = vc_bits[i];
-            n_ascii = varicode_decode(&f->varicode_dec_states, &ascii_out, &vc_bit, 1, 1);
-            if (n_ascii && (f->freedv_put_next_rx_char != NULL)) {
-                (*f->freedv_put_next_rx_char)(f->callback_state, ascii_out);
+    int frame;
+    if(packed)
+        frame = fvhff_deframe_bits_packed(f->deframer,f->packed_codec_bits,proto_bits,vc_bits,(uint8_t*)f->tx_bits);
+    else
+        frame = fvhff_deframe_bits(f->deframer,f->packed_codec_bits,proto_bits,vc_bits,(uint8_t*)f->tx_bits);
+    if(frame){
+        /* Decode varicode text, both bits in one go, packed MSB first */
+        vc_packed = (vc_bits[0] << 7) | (vc_bits[1] << 6);
+        n_ascii = varicode_decode_packed(&f->varicode_dec_states, ascii_out, &vc_packed, 2, 2);
+        for(i=0; i<n_ascii; i++){
+            if (f->freedv_put_next_rx_char != NULL) {
+                (*f->freedv_put_next_rx_char)(f->callback_state, ascii_out[i]);
             }
         }
         /* Pass proto bits on down if callback is present */
@@ -1368,23 +1437,16 @@ int freedv_comprx_fsk(struct freedv *f, COMP demod_in[], int *valid) {
 
 int freedv_floatrx(struct freedv *f, short speech_out[], float demod_in[]) {
     assert(f != NULL);
-    int  i;
-    int nin = freedv_nin(f);    
-    
-    assert(nin <= f->n_max_modem_samples);
-    
-    COMP rx_fdm[f->n_max_modem_samples];
-    for(i=0; i<nin; i++) {
-        rx_fdm[i].real = demod_in[i];
-        rx_fdm[i].imag = 0;
-    }
+    const struct MODEM_IO io = { MODEM_IO_FLOAT, 1.0 };
 
-    return freedv_comprx(f, speech_out, rx_fdm);
+    assert(freedv_nin(f) <= f->n_max_modem_samples);
+    
+    return freedv_rx_io(f, speech_out, demod_in, &io);
 }
 
 // complex input samples version
 
-static int freedv_comprx_fdmdv_1600(struct freedv *f, COMP demod_in[], int *valid) {
+static int freedv_comprx_fdmdv_1600(struct freedv *f, const void *demod_in, const struct MODEM_IO *io, int *valid) {
     int                 bits_per_codec_frame, bytes_per_codec_frame, bits_per_fdmdv_frame;
     int                 i, j, bit, byte, nin_prev, nout;
     int                 recd_codeword, codeword1, data_flag_index, n_ascii;
@@ -1396,17 +1458,26 @@ static int freedv_comprx_fdmdv_1600(struct freedv *f, COMP demod_in[], int *vali
     bytes_per_codec_frame = (bits_per_codec_frame + 7) / 8;
     nout = f->n_speech_samples;
 
-    COMP ademod_in[f->nin];
-    for(i=0; i<f->nin; i++)
-        ademod_in[i] = fcmult(1.0/FDMDV_SCALE, demod_in[i]);
+    /* the demod scales the input to FDMDV_SCALE as it reads it */
+
+    struct MODEM_IO ademod_io = *io;
+    ademod_io.scale *= 1.0/FDMDV_SCALE;
 
     bits_per_fdmdv_frame  = fdmdv_bits_per_frame(f->fdmdv);
 
     nin_prev = f->nin;
-    fdmdv_demod(f->fdmdv, f->fdmdv_bits, &reliable_sync_bit, ademod_in, &f->nin);
-    fdmdv_get_demod_stats(f->fdmdv, &f->stats);
-    f->sync = f->fdmdv->sync;
-    f->snr_est = f->stats.snr_est;
+    if (!f->stats.sync && freedv_idle(f, demod_in, io, nin_prev)) {
+        /* nothing on the channel, skip the demod and its sync search */
+        reliable_sync_bit = 0;
+        f->nin = FDMDV_NOM_SAMPLES_PER_FRAME;
+        f->stats.sync = 0;
+    }
+    else {
+        fdmdv_demod_io(f->fdmdv, f->fdmdv_bits, &reliable_sync_bit, demod_in, &ademod_io, &f->nin);
+        fdmdv_get_demod_stats(f->fdmdv, &f->stats);
+        f->sync = f->fdmdv->sync;
+        f->snr_est = f->stats.snr_est;
+    }
 
     if (reliable_sync_bit == 1) {
         f->evenframe = 1;
@@ -1553,15 +1624,16 @@ static int freedv_comprx_fdmdv_1600(struct freedv *f, COMP demod_in[], int *vali
 }
 
 #ifndef CORTEX_M4
-static int freedv_comprx_700(struct freedv *f, COMP demod_in_8kHz[], int *valid) {
+static int freedv_comprx_700(struct freedv *f, const void *demod_in_8kHz, const struct MODEM_IO *io, int *valid) {
     int                 bits_per_codec_frame, bytes_per_codec_frame;
     int                 i, j, bit, byte, nout, k;
     int                 data_flag_index, n_ascii, nspare;
-    short               abit[1];
-    char                ascii_out;
+    short               abit[2];
+    char                ascii_out[2];
     float rx_bits[COHPSK_BITS_PER_FRAME]; /* soft decn rx bits */
     int   sync;
     int   frames;
+    int   nin_8k;
 
     bits_per_codec_frame  = codec2_bits_per_frame(f->codec2);
     bytes_per_codec_frame = (bits_per_codec_frame + 7) / 8;
@@ -1571,25 +1643,37 @@ static int freedv_comprx_700(struct freedv *f, COMP demod_in_8kHz[], int *valid)
     // echo samples back out as default (say if sync not found)
     *valid = -1;
 
+    // the decimator moves on the state freedv_nin() is based on, so
+    // take the caller's sample count before it runs
+    nin_8k = freedv_nin(f);
+
     // quisk_cfInterpDecim() modifies input data so lets make a copy just in case there
-    // is no sync and we need to echo inout to output
+    // is no sync and we need to echo inout to output, converting from the
+    // caller's format on the way
 
-    COMP demod_in[freedv_nin(f)];
-    for(i=0; i<freedv_nin(f); i++)
-        demod_in[i] = demod_in_8kHz[i];
+    COMP demod_in[nin_8k];
+    for(i=0; i<nin_8k; i++)
+        demod_in[i] = modem_io_get(io, demod_in_8kHz, i);
 
-    i = quisk_cfInterpDecim((complex float *)demod_in, freedv_nin(f), f->ptFilter8000to7500, 15, 16);
+    i = quisk_cfInterpDecim((complex float *)demod_in, nin_8k, f->ptFilter8000to7500, 15, 16);
     //if (i != f->nin)
     //    printf("freedv_comprx decimation: input %d output %d\n", freedv_nin(f), i);
 
     for(i=0; i<f->nin; i++)
         demod_in[i] = fcmult(1.0/FDMDV_SCALE, demod_in[i]);
     
-    cohpsk_demod(f->cohpsk, rx_bits, &sync, demod_in, &f->nin);
-
+    if (!f->stats.sync && freedv_idle(f, demod_in_8kHz, io, nin_8k)) {
+        /* nothing on the channel, skip the demod and its sync search */
+        sync = 0;
+        f->nin = COHPSK_NOM_SAMPLES_PER_FRAME;
+        f->stats.sync = 0;
+    }
+    else {
+        cohpsk_demod(f->cohpsk, rx_bits, &sync, demod_in, &f->nin);
+        cohpsk_get_demod_stats(f->cohpsk, &f->stats);
+        f->snr_est = f->stats.snr_est;
+    }
     f->sync = sync;
-    cohpsk_get_demod_stats(f->cohpsk, &f->stats);
-    f->snr_est = f->stats.snr_est;
 
     memset(f->packed_codec_bits, 0, bytes_per_codec_frame * frames);
 
@@ -1627,12 +1711,13 @@ static int freedv_comprx_700(struct freedv *f, COMP demod_in_8kHz[], int *valid)
                     assert(0);
                 }
 
-                for(k=0; k<nspare; k++)  {
-                    abit[0] = rx_bits[data_flag_index+j+k] < 0.0;
+                for(k=0; k<nspare; k++)
+                    abit[k] = rx_bits[data_flag_index+j+k] < 0.0;
 
-                    n_ascii = varicode_decode(&f->varicode_dec_states, &ascii_out, abit, 1, 1);
-                    if (n_ascii && (f->freedv_put_next_rx_char != NULL)) {
-                        (*f->freedv_put_next_rx_char)(f->callback_state, ascii_out);
+                n_ascii = varicode_decode(&f->varicode_dec_states, ascii_out, abit, nspare, nspare);
+                for(k=0; k<n_ascii; k++)  {
+                    if (f->freedv_put_next_rx_char != NULL) {
+                        (*f->freedv_put_next_rx_char)(f->callback_state, ascii_out[k]);
                     }
                 }
 
@@ -1746,65 +1831,76 @@ static int freedv_comprx_700(struct freedv *f, COMP demod_in_8kHz[], int *valid)
     [ ] deal with out of sync returning nin samples, listening to analog audio when out of sync
 */
 
-static int freedv_comprx_700d(struct freedv *f, COMP demod_in_8kHz[], int *valid) {
-    int   bits_per_codec_frame, bytes_per_codec_frame;
-    int   i, j, bit, byte, nout, k;
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: freedv_700d_rx_modem
+  DATE CREATED: October 2026
+
+  First stage of the 700D receiver: demodulates one modem frame, keeps
+  the interleaver ring and sync state machines going, decodes the txt
+  channel and sets rx->decode when a full interleaver window is ready
+  for freedv_700d_rx_fec().  Nothing here reads the FEC results, so the
+  FEC of a window can run later, or on another thread, while the modem
+  carries on with the next frame.
+
+\*---------------------------------------------------------------------------*/
+
+void freedv_700d_rx_modem(struct freedv *f, const void *demod_in_8kHz, const struct MODEM_IO *io, struct FREEDV_700D_RX *rx) {
+    int   i, j, k;
     int   n_ascii;
-    char  ascii_out;
-    int   frames;
+    char  ascii_out[ofdm_ntxtbits];
     struct OFDM *ofdm = f->ofdm;
     struct LDPC *ldpc = f->ldpc;
     
-    int    data_bits_per_frame = ldpc->data_bits_per_frame;
     int    coded_bits_per_frame = ldpc->coded_bits_per_frame;
     int    coded_syms_per_frame = ldpc->coded_syms_per_frame;
     int    interleave_frames = f->interleave_frames;
-    COMP  *codeword_symbols = f->codeword_symbols;
-    float *codeword_amps = f->codeword_amps;
+    COMP  *codeword_symbols;
+    float *codeword_amps;
     int    rx_bits[ofdm_bitsperframe];
     short txt_bits[ofdm_ntxtbits];
     COMP  payload_syms[coded_syms_per_frame];
     float payload_amps[coded_syms_per_frame];
-   
-    bits_per_codec_frame  = codec2_bits_per_frame(f->codec2);
-    bytes_per_codec_frame = (bits_per_codec_frame + 7) / 8;
-    frames = f->n_codec_bits / bits_per_codec_frame;
 
     // pass through is too noisey ....
     //nout = f->n_speech_samples;
-    nout = 0;
+    rx->nout = 0;
+    rx->decode = 0;
     
-    int Nerrs_raw = 0;
-    int Nerrs_coded = 0;
-    int iter = 0;
-    int parityCheckCount = 0;
+    rx->Nerrs_raw = 0;
+    rx->Nerrs_coded = 0;
+    rx->iter = 0;
+    rx->parityCheckCount = 0;
     int rx_uw[ofdm_nuwbits];
-    COMP rxbuf_in[f->nin];
 
-    for(i=0; i<f->nin; i++) {
-        rxbuf_in[i].real = demod_in_8kHz[i].real/OFDM_AMP_SCALE;
-        rxbuf_in[i].imag = demod_in_8kHz[i].imag/OFDM_AMP_SCALE;
-    }
+    /* the modem takes the samples straight from the caller's buffer,
+       scaling them down from 16 bit short levels as it reads them */
+
+    struct MODEM_IO rxbuf_io = *io;
+    rxbuf_io.scale /= OFDM_AMP_SCALE;
     
     /* echo samples back out as default (say if sync not found) */
     
-    *valid = 1;
+    rx->valid = 1;
     f->sync = f->stats.sync = 0;
     
     /* TODO estimate this properly from signal */
     
-    float EsNo = 3.0;
+    rx->EsNo = 3.0;
     
     /* looking for modem sync */
     
     if (strcmp(ofdm->sync_state,"search") == 0) {
-        ofdm_sync_search(f->ofdm, rxbuf_in);
+        if (freedv_idle(f, demod_in_8kHz, io, f->nin))
+            ofdm_sync_idle_io(f->ofdm, demod_in_8kHz, &rxbuf_io);
+        else
+            ofdm_sync_search_io(f->ofdm, demod_in_8kHz, &rxbuf_io);
     }
 
      /* OK modem is in sync */
     
     if ((strcmp(ofdm->sync_state,"synced") == 0) || (strcmp(ofdm->sync_state,"trial") == 0) ) {
-        ofdm_demod(ofdm, rx_bits, rxbuf_in);
+        ofdm_demod_io(ofdm, rx_bits, demod_in_8kHz, &rxbuf_io);
         ofdm_disassemble_modem_frame(ofdm, rx_uw, payload_syms, payload_amps, txt_bits);
 
         f->sync = 1;
@@ -1815,102 +1911,57 @@ static int freedv_comprx_700d(struct freedv *f, COMP demod_in_8kHz[], int *valid
 
         /* now we need to buffer for de-interleaving -------------------------------------*/
                 
-        /* shift interleaved symbol buffers to make room for new symbols */
+        /* newest symbols replace the oldest frame in the ring, in both
+           copies, then the next slot holds the oldest frame */
                 
-        for(i=0, j=coded_syms_per_frame; j<interleave_frames*coded_syms_per_frame; i++,j++) {
-            codeword_symbols[i] = codeword_symbols[j];
-            codeword_amps[i] = codeword_amps[j];
+        int head = f->codeword_head;
+        for(i=head*coded_syms_per_frame, j=0; j<coded_syms_per_frame; i++,j++) {
+            f->codeword_symbols[i] = f->codeword_symbols[i+interleave_frames*coded_syms_per_frame] = payload_syms[j];
+            f->codeword_amps[i]    = f->codeword_amps[i+interleave_frames*coded_syms_per_frame]    = payload_amps[j];
         }
+        f->codeword_head = (head + 1) % interleave_frames;
 
-        /* newest symbols at end of buffer (uses final i from last loop), note we 
-           change COMP formats from what modem uses internally */
-                
-        for(i=(interleave_frames-1)*coded_syms_per_frame,j=0; i<interleave_frames*coded_syms_per_frame; i++,j++) {
-            codeword_symbols[i] = payload_syms[j];
-            codeword_amps[i]    = payload_amps[j];
-         }
-               
-        /* run de-interleaver */
-                
-        COMP  codeword_symbols_de[interleave_frames*coded_syms_per_frame];
-        float codeword_amps_de[interleave_frames*coded_syms_per_frame];
-        gp_deinterleave_comp (codeword_symbols_de, codeword_symbols, interleave_frames*coded_syms_per_frame);
-        gp_deinterleave_float(codeword_amps_de   , codeword_amps   , interleave_frames*coded_syms_per_frame);
-
-        float llr[coded_bits_per_frame];
-        char out_char[coded_bits_per_frame];
+        /* the interleaver window, oldest frame first */
 
-        interleaver_sync_state_machine(ofdm, ldpc, ofdm_config, codeword_symbols_de, codeword_amps_de, EsNo,
-                                       interleave_frames, &iter, &parityCheckCount, &Nerrs_coded);
+        codeword_symbols = &f->codeword_symbols[f->codeword_head*coded_syms_per_frame];
+        codeword_amps    = &f->codeword_amps[f->codeword_head*coded_syms_per_frame];
+               
+        interleaver_sync_state_machine(ofdm, ldpc, ofdm_config, codeword_symbols, codeword_amps, f->interleaver, rx->EsNo,
+                                       interleave_frames, &rx->iter, &rx->parityCheckCount, &rx->Nerrs_coded);
                                          
         if (!strcmp(ofdm->sync_state_interleaver,"synced") && (ofdm->frame_count_interleaver == interleave_frames)) {
             ofdm->frame_count_interleaver = 0;
 
             if (f->test_frames) {
                 int tmp[interleave_frames];
-                Nerrs_raw = count_uncoded_errors(ldpc, ofdm_config, tmp, interleave_frames, codeword_symbols_de);
-                f->total_bit_errors += Nerrs_raw;
+                COMP codeword_symbols_de[interleave_frames*coded_syms_per_frame];
+                gp_interleaver_deinterleave_comp(f->interleaver, codeword_symbols_de, codeword_symbols);
+                rx->Nerrs_raw = count_uncoded_errors(ldpc, ofdm_config, tmp, interleave_frames, codeword_symbols_de);
+                f->total_bit_errors += rx->Nerrs_raw;
                 f->total_bits       += ofdm_bitsperframe*interleave_frames;
             }
 
-            memset(f->packed_codec_bits, 0, bytes_per_codec_frame * frames);
-            byte = 0; f->modem_frame_count_rx = 0;
-            
-            for (j=0; j<interleave_frames; j++) {
-                symbols_to_llrs(llr, &codeword_symbols_de[j*coded_syms_per_frame],
-                                &codeword_amps_de[j*coded_syms_per_frame],
-                                EsNo, ofdm->mean_amp, coded_syms_per_frame);               
-                iter = run_ldpc_decoder(ldpc, out_char, llr, &parityCheckCount);
-
-                if (f->test_frames) {
-                    int payload_data_bits[data_bits_per_frame];
-                    ofdm_generate_payload_data_bits(payload_data_bits, data_bits_per_frame);
-                    Nerrs_coded = count_errors(payload_data_bits, out_char, data_bits_per_frame);
-                    f->total_bit_errors_coded += Nerrs_coded;
-                    f->total_bits_coded       += data_bits_per_frame;
-                } else {
-
-                    /* a frame of valid Codec 2 bits, pack into Codec 2 frame  */
+            /* the window is only valid until the next call */
 
-                    for (i=0; i<data_bits_per_frame; i+=bits_per_codec_frame) {
-
-                        /* pack bits, MSB received first */
-
-                        bit = 7;
-                        for(k=0; k<bits_per_codec_frame; k++) {
-                            f->packed_codec_bits[byte] |= (out_char[i+k] << bit);
-                            bit--;
-                            if (bit < 0) {
-                                bit = 7;
-                                byte++;
-                            }
-                        }
-                        if (bit != 7)
-                            byte++;
-                    }
-                    
-                }
-            } /* for interleave frames ... */
-
-            /* make sure we don't overrun packed byte array */
-
-            assert(byte <= f->nbyte_packed_codec_bits);
+            rx->decode = 1;
+            rx->codeword_symbols = codeword_symbols;
+            rx->codeword_amps = codeword_amps;
+            rx->mean_amp = ofdm->mean_amp;
                    
-            nout = f->n_speech_samples;                  
+            rx->nout = f->n_speech_samples;                  
 
             if (f->squelch_en && (f->stats.snr_est < f->snr_squelch_thresh)) {
-                *valid = 0;
+                rx->valid = 0;
             }
             
         } /* if interleaver synced ..... */
 
         /* If modem is synced we can decode txt bits */
         
-        for(k=0; k<ofdm_ntxtbits; k++)  { 
-            //fprintf(stderr, "txt_bits[%d] = %d\n", k, rx_bits[i]);
-            n_ascii = varicode_decode(&f->varicode_dec_states, &ascii_out, &txt_bits[k], 1, 1);
-            if (n_ascii && (f->freedv_put_next_rx_char != NULL)) {
-                (*f->freedv_put_next_rx_char)(f->callback_state, ascii_out);
+        n_ascii = varicode_decode(&f->varicode_dec_states, ascii_out, txt_bits, ofdm_ntxtbits, ofdm_ntxtbits);
+        for(k=0; k<n_ascii; k++)  { 
+            if (f->freedv_put_next_rx_char != NULL) {
+                (*f->freedv_put_next_rx_char)(f->callback_state, ascii_out[k]);
             }
         }
 
@@ -1926,7 +1977,7 @@ static int freedv_comprx_700d(struct freedv *f, COMP demod_in_8kHz[], int *valid
         f->total_bits += ofdm_nuwbits;          
 
     } /* if modem synced .... */ else {
-        *valid = -1;
+        rx->valid = -1;
     }
 
     /* iterate state machine and update nin for next call */
@@ -1935,32 +1986,198 @@ static int freedv_comprx_700d(struct freedv *f, COMP demod_in_8kHz[], int *valid
     //fprintf(stderr, "nin: %d\n", ofdm_get_nin(ofdm));
     ofdm_sync_state_machine(ofdm, rx_uw);
 
-    if (f->verbose  && strcmp(ofdm->last_sync_state, "search")) {
-        fprintf(stderr, "%3d st: %-6s euw: %2d %1d f: %5.1f ist: %-6s %2d eraw: %3d ecdd: %3d iter: %3d pcc: %3d vld: %d, nout: %4d\n",
-                f->frames++, ofdm->last_sync_state, ofdm->uw_errors, ofdm->sync_counter, 
-		(double)ofdm->foff_est_hz,
-                ofdm->last_sync_state_interleaver, ofdm->frame_count_interleaver,
-                Nerrs_raw, Nerrs_coded, iter, parityCheckCount, *valid, nout);
-    }
-    
     /* no valid FreeDV signal - squelch output */
     
     int sync = !strcmp(ofdm->sync_state,"synced") || !strcmp(ofdm->sync_state,"trial");
     if (!sync) {
          if (f->squelch_en) {
- 	    *valid = 0;
+ 	    rx->valid = 0;
          }
          //f->snr_est = 0.0;
     }
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: freedv_700d_rx_fec
+  DATE CREATED: October 2026
+
+  Second stage of the 700D receiver: de-interleaves and LDPC decodes the
+  window left by freedv_700d_rx_modem(), packing the Codec 2 frames into
+  packed_out[], which must hold f->nbyte_packed_codec_bits bytes.  Only
+  the LDPC and coded error statistics in f are written.
+
+\*---------------------------------------------------------------------------*/
+
+void freedv_700d_rx_fec(struct freedv *f, struct FREEDV_700D_RX *rx, unsigned char packed_out[]) {
+    int   bits_per_codec_frame, bytes_per_codec_frame;
+    int   i, j, bit, byte, k;
+    int   frames;
+    struct LDPC *ldpc = f->ldpc;
     
-    //fprintf(stderr, "sync: %d valid: %d snr: %3.2f\n", f->sync, *valid, f->snr_est);
-    
+    int    data_bits_per_frame = ldpc->data_bits_per_frame;
+    int    coded_bits_per_frame = ldpc->coded_bits_per_frame;
+    int    coded_syms_per_frame = ldpc->coded_syms_per_frame;
+    int    interleave_frames = f->interleave_frames;
+
+    /* the de-interleaver is run as the LLRs are computed, straight
+       from the interleaved symbols */
+                
+    uint16_t *perm = f->interleaver->perm;
+    float llr[coded_bits_per_frame];
+    char out_char[coded_bits_per_frame];
+
+    assert(rx->decode);
+
+    bits_per_codec_frame  = codec2_bits_per_frame(f->codec2);
+    bytes_per_codec_frame = (bits_per_codec_frame + 7) / 8;
+    frames = f->n_codec_bits / bits_per_codec_frame;
+
+    memset(packed_out, 0, bytes_per_codec_frame * frames);
+    byte = 0;
+            
+    f->ldpc_iter = 0;
+    f->ldpc_unsatisfied = 0;
+    for (j=0; j<interleave_frames; j++) {
+        struct LDPC_STATS stats;
+        symbols_to_llrs_gather(llr, rx->codeword_symbols, rx->codeword_amps, &perm[j*coded_syms_per_frame],
+                               rx->EsNo, rx->mean_amp, coded_syms_per_frame);
+        rx->iter = run_ldpc_decoder_stats(ldpc, out_char, llr, &stats);
+        rx->parityCheckCount = ldpc->NumberParityBits - stats.unsatisfied;
+        f->ldpc_iter += stats.iter;
+        f->ldpc_unsatisfied += stats.unsatisfied;
+
+        if (f->test_frames) {
+            int payload_data_bits[data_bits_per_frame];
+            ofdm_generate_payload_data_bits(payload_data_bits, data_bits_per_frame);
+            rx->Nerrs_coded = count_errors(payload_data_bits, out_char, data_bits_per_frame);
+            f->total_bit_errors_coded += rx->Nerrs_coded;
+            f->total_bits_coded       += data_bits_per_frame;
+        } else {
+
+            /* a frame of valid Codec 2 bits, pack into Codec 2 frame  */
+
+            for (i=0; i<data_bits_per_frame; i+=bits_per_codec_frame) {
+
+                /* pack bits, MSB received first */
+
+                bit = 7;
+                for(k=0; k<bits_per_codec_frame; k++) {
+                    packed_out[byte] |= (out_char[i+k] << bit);
+                    bit--;
+                    if (bit < 0) {
+                        bit = 7;
+                        byte++;
+                    }
+                }
+                if (bit != 7)
+                    byte++;
+            }
+            
+        }
+    } /* for interleave frames ... */
+
+    /* make sure we don't overrun packed byte array */
+
+    assert(byte <= f->nbyte_packed_codec_bits);
+}
+
+
+void freedv_700d_rx_verbose(struct freedv *f, struct FREEDV_700D_RX *rx) {
+    struct OFDM *ofdm = f->ofdm;
+
+    if (f->verbose  && strcmp(ofdm->last_sync_state, "search")) {
+        fprintf(stderr, "%3d st: %-6s euw: %2d %1d f: %5.1f ist: %-6s %2d eraw: %3d ecdd: %3d iter: %3d pcc: %3d vld: %d, nout: %4d\n",
+                f->frames++, ofdm->last_sync_state, ofdm->uw_errors, ofdm->sync_counter, 
+		(double)ofdm->foff_est_hz,
+                ofdm->last_sync_state_interleaver, ofdm->frame_count_interleaver,
+                rx->Nerrs_raw, rx->Nerrs_coded, rx->iter, rx->parityCheckCount, rx->valid, rx->nout);
+    }
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: freedv_700d_speech
+  DATE CREATED: October 2026
+
+  Last stage of the 700D receiver: decodes the Codec 2 frames of the
+  next modem frame of packed[], the output of the last decoded window.
+  *frame_count is the modem frame within the window, reset when a new
+  window is decoded; once all interleave_frames have been played
+  nothing more is output.  Returns the number of speech samples.
+
+\*---------------------------------------------------------------------------*/
+
+int freedv_700d_speech(struct freedv *f, short speech_out[], const unsigned char packed[], int *frame_count) {
+    int bits_per_codec_frame  = codec2_bits_per_frame(f->codec2);
+    int bytes_per_codec_frame = (bits_per_codec_frame + 7) / 8;
+    int data_bits_per_frame = f->ldpc->data_bits_per_frame;
+    int frames = data_bits_per_frame/bits_per_codec_frame;
+    int i, nout = 0;
+
+    if (*frame_count < f->interleave_frames) {
+        nout = f->n_speech_samples;
+        //fprintf(stderr, "modem_frame_count_rx: %d nout: %d\n", *frame_count, nout);
+        for (i = 0; i < frames; i++) {
+            codec2_decode(f->codec2, speech_out, (unsigned char*)packed + (i + frames*(*frame_count))*bytes_per_codec_frame);
+            speech_out += codec2_samples_per_frame(f->codec2);
+        }
+        (*frame_count)++;
+    }
+
     return nout;
 }
+
+
+static int freedv_comprx_700d(struct freedv *f, const void *demod_in_8kHz, const struct MODEM_IO *io, int *valid) {
+    struct FREEDV_700D_RX rx;
+
+    freedv_700d_rx_modem(f, demod_in_8kHz, io, &rx);
+    if (rx.decode) {
+        freedv_700d_rx_fec(f, &rx, f->packed_codec_bits);
+        f->modem_frame_count_rx = 0;
+    }
+    freedv_700d_rx_verbose(f, &rx);
+
+    //fprintf(stderr, "sync: %d valid: %d snr: %3.2f\n", f->sync, rx.valid, f->snr_est);
+
+    *valid = rx.valid;
+    return rx.nout;
+}
 #endif
 
 
 int freedv_comprx(struct freedv *f, short speech_out[], COMP demod_in[]) {
+    return freedv_rx_io(f, speech_out, demod_in, &modem_io_comp);
+}
+
+/* FSK demods take COMP input, the one mode that still needs a converted copy */
+
+static int freedv_comprx_fsk_io(struct freedv *f, const void *demod_in, const struct MODEM_IO *io, int *valid) {
+    int i, nin = freedv_nin(f);
+
+    if ((io->format == MODEM_IO_FLOAT_IQ) && (io->scale == 1.0))
+        return freedv_comprx_fsk(f, (COMP *)demod_in, valid);
+
+    COMP rx_fdm[f->n_max_modem_samples];
+    for(i=0; i<nin; i++)
+        rx_fdm[i] = modem_io_get(io, demod_in, i);
+    return freedv_comprx_fsk(f, rx_fdm, valid);
+}
+
+/*---------------------------------------------------------------------------*
+  FUNCTION....: freedv_rx_io
+  DATE CREATED: October 2026
+
+  freedv_rx() for freedv_nin() samples in any of the MODEM_IO formats.
+  The 1600, 700 .. 700C and 700D modems read the caller's buffer in
+  their first stage, so no converted copy of the input is made.  The
+  scale is applied as the samples are read, freedv_rx() itself uses
+  MODEM_IO_SHORT with a scale of 1, or 2 for 700D.
+
+\*---------------------------------------------------------------------------*/
+
+int freedv_rx_io(struct freedv *f, short speech_out[], const void *demod_in, const struct MODEM_IO *io) {
     assert(f != NULL);
     int                 bits_per_codec_frame, bytes_per_codec_frame;
     int                 i, nout = 0;
@@ -1972,19 +2189,19 @@ int freedv_comprx(struct freedv *f, short speech_out[], COMP demod_in[]) {
     bytes_per_codec_frame = (bits_per_codec_frame + 7) / 8;
 
     if (f->mode == FREEDV_MODE_1600) {
-        nout = freedv_comprx_fdmdv_1600(f, demod_in, &valid);
+        nout = freedv_comprx_fdmdv_1600(f, demod_in, io, &valid);
     }
 #ifndef CORTEX_M4
     if ((f->mode == FREEDV_MODE_700) || (f->mode == FREEDV_MODE_700B) || (f->mode == FREEDV_MODE_700C)) {
-        nout = freedv_comprx_700(f, demod_in, &valid);
+        nout = freedv_comprx_700(f, demod_in, io, &valid);
     }
 
     if (f->mode == FREEDV_MODE_700D) {
-        nout = freedv_comprx_700d(f, demod_in, &valid);
+        nout = freedv_comprx_700d(f, demod_in, io, &valid);
     }
     
     if( (f->mode == FREEDV_MODE_2400A) || (f->mode == FREEDV_MODE_2400B) || (f->mode == FREEDV_MODE_800XA)){
-        nout = freedv_comprx_fsk(f, demod_in, &valid);
+        nout = freedv_comprx_fsk_io(f, demod_in, io, &valid);
     }
 #endif
 
@@ -2000,26 +2217,13 @@ int freedv_comprx(struct freedv *f, short speech_out[], COMP demod_in[]) {
         /* we havent got sync so play audio from radio.  This might
            not work for all modes due to nin bouncing about */
         for (i = 0; i < nout; i++)
-            speech_out[i] = demod_in[i].real;
+            speech_out[i] = modem_io_get(io, demod_in, i).real;
     }
     else {
         /* decoded audio to play */
         
         if (f->mode == FREEDV_MODE_700D) {
-            int data_bits_per_frame = f->ldpc->data_bits_per_frame;
-            int frames = data_bits_per_frame/bits_per_codec_frame;
-            
-            nout = 0;
-            if (f->modem_frame_count_rx < f->interleave_frames) {
-                nout = f->n_speech_samples;
-                //fprintf(stderr, "modem_frame_count_rx: %d nout: %d\n", f->modem_frame_count_rx, nout);
-                for (i = 0; i < frames; i++) {
-                    codec2_decode(f->codec2, speech_out, f->packed_codec_bits + (i + frames*f->modem_frame_count_rx)* bytes_per_codec_frame);
-                    speech_out += codec2_samples_per_frame(f->codec2);
-                }
-                f->modem_frame_count_rx++;
-            }
-           
+            nout = freedv_700d_speech(f, speech_out, f->packed_codec_bits, &f->modem_frame_count_rx);
         } else {
             int frames = f->n_codec_bits / bits_per_codec_frame;
             //fprintf(stderr, "frames: %d\n", frames);
@@ -2034,35 +2238,75 @@ int freedv_comprx(struct freedv *f, short speech_out[], COMP demod_in[]) {
     return nout;
 }
 
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: freedv_rx_block
+  DATE CREATED: October 2026
+
+  Receives as many modem frames as demod_in[] holds, so the caller can
+  hand over a block of any size n rather than looping on freedv_nin().
+  Each frame takes freedv_nin() samples, read in place in the caller's
+  format as by freedv_rx_io().  Stops when fewer than freedv_nin()
+  samples are left, or when speech_out[] could not take the worst case
+  output of another frame, the larger of freedv_get_n_speech_samples()
+  and freedv_get_n_max_modem_samples().
+
+  Returns the number of speech samples written to speech_out[], with
+  the number of demod_in[] samples used in *consumed.  Samples not used
+  must be passed again, at the start of the next block.
+
+\*---------------------------------------------------------------------------*/
+
+int freedv_rx_block(struct freedv *f, const void *demod_in, size_t n, const struct MODEM_IO *io,
+                    size_t *consumed, short speech_out[], int max_speech) {
+    assert(f != NULL);
+    const char *in = demod_in;
+    size_t      used = 0;
+    int         nout = 0, nin;
+    int         size = modem_io_size(io);
+    int         max_nout = (f->n_speech_samples > f->n_max_modem_samples) ? f->n_speech_samples : f->n_max_modem_samples;
+
+    while (((size_t)(nin = freedv_nin(f)) <= n - used) && (max_speech - nout >= max_nout)) {
+        nout += freedv_rx_io(f, &speech_out[nout], in + used*size, io);
+        used += nin;
+    }
+
+    if (consumed != NULL)
+        *consumed = used;
+    return nout;
+}
+
 int freedv_codecrx(struct freedv *f, unsigned char *packed_codec_bits, short demod_in[])
+{
+    const struct MODEM_IO io = { MODEM_IO_SHORT, 1.0 };
+
+    return freedv_codecrx_io(f, packed_codec_bits, demod_in, &io);
+}
+
+/* freedv_codecrx() for freedv_nin() samples in any of the MODEM_IO formats */
+
+int freedv_codecrx_io(struct freedv *f, unsigned char *packed_codec_bits, const void *demod_in, const struct MODEM_IO *io)
 {
     assert(f != NULL);
-    COMP rx_fdm[f->n_max_modem_samples];
     int i;
-    int nin = freedv_nin(f);
     int valid;
     int ret = 0;
     int bits_per_codec_frame = codec2_bits_per_frame(f->codec2);
 
-    assert(nin <= f->n_max_modem_samples);
+    assert(freedv_nin(f) <= f->n_max_modem_samples);
     
-    for(i=0; i<nin; i++) {
-        rx_fdm[i].real = (float)demod_in[i];
-        rx_fdm[i].imag = 0.0;
-    }
-
     if (f->mode == FREEDV_MODE_1600) {
-        freedv_comprx_fdmdv_1600(f, rx_fdm, &valid);
+        freedv_comprx_fdmdv_1600(f, demod_in, io, &valid);
     }
 
 #ifndef CORTEX_M4
     int bytes_per_codec_frame = (bits_per_codec_frame + 7) / 8;
     if ((f->mode == FREEDV_MODE_700) || (f->mode == FREEDV_MODE_700B) || (f->mode == FREEDV_MODE_700C)) {
-        freedv_comprx_700(f, rx_fdm, &valid);
+        freedv_comprx_700(f, demod_in, io, &valid);
     }
 
     if (f->mode == FREEDV_MODE_700D) {
-        freedv_comprx_700d(f, rx_fdm, &valid);
+        freedv_comprx_700d(f, demod_in, io, &valid);
 
         int data_bits_per_frame = f->ldpc->data_bits_per_frame;
         int frames = data_bits_per_frame/bits_per_codec_frame;
@@ -2080,7 +2324,7 @@ int freedv_codecrx(struct freedv *f, unsigned char *packed_codec_bits, short dem
 #endif
     
     if( (f->mode == FREEDV_MODE_2400A) || (f->mode == FREEDV_MODE_2400B) || (f->mode == FREEDV_MODE_800XA)){
-        freedv_comprx_fsk(f, rx_fdm, &valid);
+        freedv_comprx_fsk_io(f, demod_in, io, &valid);
     }
 
     if (valid == 1) {
@@ -2186,6 +2430,36 @@ void freedv_set_callback_data(struct freedv *f, freedv_callback_datarx datarx, f
     }
 }
 
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: freedv_set_callback_data_view / freedv_data_rx_release
+  DATE CREATED: October 2026
+
+  Receive data packets as views of the data channel's reassembly buffers.
+  If the callback returns non-zero the packet stays valid, and its buffer
+  out of use, until it is given back with freedv_data_rx_release(), which
+  may be called from another thread.  Up to FREEDV_DATA_CHANNEL_RX_SLOTS
+  packets can be held while reception goes on; packets that arrive when
+  every buffer is held are dropped.
+\*---------------------------------------------------------------------------*/
+void freedv_set_callback_data_view(struct freedv *f, freedv_callback_datarx_view datarx, void *callback_state) {
+    if ((f->mode == FREEDV_MODE_2400A) || (f->mode == FREEDV_MODE_2400B) || (f->mode == FREEDV_MODE_800XA)){
+        if (!f->deframer->fdc)
+            f->deframer->fdc = freedv_data_channel_create();
+        if (!f->deframer->fdc)
+            return;
+
+        freedv_data_set_cb_rx_view(f->deframer->fdc, datarx, callback_state);
+    }
+}
+
+void freedv_data_rx_release(struct freedv *f, const unsigned char *packet) {
+    if ((f->mode == FREEDV_MODE_2400A) || (f->mode == FREEDV_MODE_2400B) || (f->mode == FREEDV_MODE_800XA)){
+        if (f->deframer->fdc)
+            freedv_data_channel_release(f->deframer->fdc, packet);
+    }
+}
+
 /*---------------------------------------------------------------------------*\
 
   FUNCTION....: freedv_set_data_header
@@ -2263,6 +2537,94 @@ void freedv_set_varicode_code_num         (struct freedv *f, int val) {varicode_
 void freedv_set_ext_vco                   (struct freedv *f, int val) {f->ext_vco = val;}
 
 
+/* Caps the LDPC iterations of each 700D codeword, and optionally shares an
+   iteration budget with other channels, see ldpc_budget_create() */
+
+void freedv_set_ldpc_max_iter(struct freedv *f, int max_iter) {
+    if (f->mode == FREEDV_MODE_700D) {
+        f->ldpc->max_iter = (max_iter > 0) ? max_iter : f->ldpc_max_iter_default;
+    }
+}
+
+void freedv_set_ldpc_budget(struct freedv *f, struct LDPC_BUDGET *budget) {
+    if (f->mode == FREEDV_MODE_700D) {
+        f->ldpc->budget = budget;
+    }
+}
+
+
+/*---------------------------------------------------------------------------*
+  FUNCTION....: freedv_set_idle_detect
+  DATE CREATED: October 2026
+
+  Sets up a tone_detect on the carrier frequencies of the modem, with up
+  to four noise reference bins each side of the signal, spread between
+  the edges of a 400-2700 Hz SSB passband and two Goertzel bins clear of
+  the outer carriers.  While the detector sees nothing the rx functions
+  skip the modem's sync search, and it is only run when out of sync.
+
+\*---------------------------------------------------------------------------*/
+
+#define IDLE_DETECT_N    160    /* 20 ms Goertzel blocks at 8 kHz */
+#define IDLE_DETECT_LO   400.0
+#define IDLE_DETECT_HI   2700.0
+
+int freedv_set_idle_detect(struct freedv *f, float pfa) {
+    float tone_hz[TONE_DETECT_MAX_TONES];
+    float ref_hz[TONE_DETECT_MAX_REF];
+    float guard, lo, hi;
+    int   ntones, nref, i;
+
+    if ((f->mode != FREEDV_MODE_1600) && (f->mode != FREEDV_MODE_700) && (f->mode != FREEDV_MODE_700B) &&
+        (f->mode != FREEDV_MODE_700C) && (f->mode != FREEDV_MODE_700D))
+        return -1;
+
+    tone_detect_destroy(f->idle_detect);
+    f->idle_detect = NULL;
+    if (pfa <= 0.0)
+        return 0;
+
+    if (f->mode == FREEDV_MODE_1600)
+        ntones = fdmdv_get_carrier_freqs(f->fdmdv, tone_hz);
+#ifndef CORTEX_M4
+    else if (f->mode == FREEDV_MODE_700D)
+        ntones = ofdm_get_carrier_freqs(f->ofdm, tone_hz);
+    else
+        ntones = cohpsk_get_carrier_freqs(f->cohpsk, tone_hz);
+#else
+    else
+        return -1;
+#endif
+    assert(ntones <= TONE_DETECT_MAX_TONES);
+
+    lo = hi = tone_hz[0];
+    for(i=1; i<ntones; i++) {
+        if (tone_hz[i] < lo) lo = tone_hz[i];
+        if (tone_hz[i] > hi) hi = tone_hz[i];
+    }
+    guard = 2.0*FS/IDLE_DETECT_N;
+    lo -= guard;
+    hi += guard;
+
+    nref = 0;
+    for(i=0; (i<TONE_DETECT_MAX_REF/2) && (lo > IDLE_DETECT_LO); i++)
+        ref_hz[nref++] = IDLE_DETECT_LO + i*(lo - IDLE_DETECT_LO)/(TONE_DETECT_MAX_REF/2 - 1);
+    for(i=0; (i<TONE_DETECT_MAX_REF/2) && (hi < IDLE_DETECT_HI); i++)
+        ref_hz[nref++] = hi + i*(IDLE_DETECT_HI - hi)/(TONE_DETECT_MAX_REF/2 - 1);
+
+    f->idle_detect = tone_detect_create(FS, IDLE_DETECT_N, tone_hz, ntones, ref_hz, nref, pfa);
+    return (f->idle_detect == NULL) ? -1 : 0;
+}
+
+/* True when the idle detector is on and there's no signal, so the sync search can be skipped */
+
+static int freedv_idle(struct freedv *f, const void *demod_in, const struct MODEM_IO *io, int nin) {
+    if (f->idle_detect == NULL)
+        return 0;
+    return !tone_detect_update(f->idle_detect, demod_in, io, nin);
+}
+
+
 /* Band Pass Filter to cleanup OFDM tx waveform, only supported by FreeDV 700D */
 
 void freedv_set_tx_bpf(struct freedv *f, int val) {
@@ -2340,6 +2702,154 @@ int freedv_set_alt_modem_samp_rate(struct freedv *f, int samp_rate){
 }
 
 
+/*---------------------------------------------------------------------------*\
+
+  FUNCTIONS...: freedv_set_sound_card_samp_rate
+  DATE CREATED: October 2026
+
+  Lets the caller run at the sound card sample rate, e.g. 44100 or 48000
+  Hz, rather than the modem and speech rates.  Call after
+  freedv_set_alt_modem_samp_rate() if that is used.  Afterwards use
+  freedv_sound_card_nin() and freedv_sound_card_rx() in place of
+  freedv_nin() and freedv_rx(), and freedv_sound_card_tx_nin() and
+  freedv_sound_card_tx() in place of freedv_tx().  The number of samples
+  in and out varies a little from call to call, buffers of
+  freedv_get_n_max_sound_card_samples() are always large enough.
+
+  Returns 0 on success, -1 if the sample rate is not supported.
+
+\*---------------------------------------------------------------------------*/
+
+static void freedv_sound_card_free(struct freedv *f) {
+    if (f->sc_rx_in)   { resample_destroy(f->sc_rx_in);  f->sc_rx_in = NULL; }
+    if (f->sc_rx_out)  { resample_destroy(f->sc_rx_out); f->sc_rx_out = NULL; }
+    if (f->sc_tx_in)   { resample_destroy(f->sc_tx_in);  f->sc_tx_in = NULL; }
+    if (f->sc_tx_out)  { resample_destroy(f->sc_tx_out); f->sc_tx_out = NULL; }
+    if (f->sc_rx_fifo) { fifo_destroy(f->sc_rx_fifo);    f->sc_rx_fifo = NULL; }
+    if (f->sc_tx_fifo) { fifo_destroy(f->sc_tx_fifo);    f->sc_tx_fifo = NULL; }
+    free(f->sc_modem_buf);  f->sc_modem_buf = NULL;
+    free(f->sc_speech_buf); f->sc_speech_buf = NULL;
+    f->sound_card_samp_rate = 0;
+}
+
+int freedv_set_sound_card_samp_rate(struct freedv *f, int samp_rate) {
+    int n_modem, n_speech;
+
+    freedv_sound_card_free(f);
+
+    f->sc_rx_in  = resample_create(samp_rate, f->modem_sample_rate);
+    f->sc_rx_out = resample_create(FS, samp_rate);
+    f->sc_tx_in  = resample_create(samp_rate, FS);
+    f->sc_tx_out = resample_create(f->modem_sample_rate, samp_rate);
+    if ((f->sc_rx_in == NULL) || (f->sc_rx_out == NULL) || (f->sc_tx_in == NULL) || (f->sc_tx_out == NULL)) {
+        freedv_sound_card_free(f);
+        return -1;
+    }
+
+    /* one sound card sample can overshoot the modem or speech samples
+       we asked for, the excess waits in the FIFOs for the next call */
+
+    n_modem  = f->n_max_modem_samples + resample_max_nout(f->sc_rx_in, 1);
+    n_speech = f->n_speech_samples + resample_max_nout(f->sc_tx_in, 1);
+    f->sc_modem_buf  = (short*)malloc(sizeof(short)*n_modem);
+    f->sc_speech_buf = (short*)malloc(sizeof(short)*n_speech);
+    f->sc_rx_fifo = fifo_create(2*n_modem);
+    f->sc_tx_fifo = fifo_create(2*n_speech);
+    if ((f->sc_modem_buf == NULL) || (f->sc_speech_buf == NULL) ||
+        (f->sc_rx_fifo == NULL) || (f->sc_tx_fifo == NULL)) {
+        freedv_sound_card_free(f);
+        return -1;
+    }
+
+    f->sound_card_samp_rate = samp_rate;
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTIONS...: freedv_sound_card_nin, freedv_sound_card_rx
+  DATE CREATED: October 2026
+
+  Receive at the sound card rate.  freedv_sound_card_nin() is the number
+  of samples to pass to the next freedv_sound_card_rx(), which returns the
+  number of speech samples written at the sound card rate.
+
+\*---------------------------------------------------------------------------*/
+
+int freedv_sound_card_nin(struct freedv *f) {
+    int need;
+
+    assert(f->sound_card_samp_rate);
+    need = freedv_nin(f) - fifo_used(f->sc_rx_fifo);
+    return (need > 0) ? resample_nin(f->sc_rx_in, need) : 0;
+}
+
+int freedv_sound_card_rx(struct freedv *f, short speech_out[], short demod_in[]) {
+    int n, nin, nout;
+
+    assert(f->sound_card_samp_rate);
+    n = resample_short(f->sc_rx_in, f->sc_modem_buf, demod_in, freedv_sound_card_nin(f));
+    fifo_write(f->sc_rx_fifo, f->sc_modem_buf, n);
+
+    nin = freedv_nin(f);
+    if (fifo_read(f->sc_rx_fifo, f->sc_modem_buf, nin) != 0)
+        return 0;
+    nout = freedv_rx(f, f->sc_speech_buf, f->sc_modem_buf);
+
+    return resample_short(f->sc_rx_out, speech_out, f->sc_speech_buf, nout);
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTIONS...: freedv_sound_card_tx_nin, freedv_sound_card_tx
+  DATE CREATED: October 2026
+
+  Transmit at the sound card rate.  freedv_sound_card_tx_nin() is the
+  number of speech samples to pass to the next freedv_sound_card_tx(),
+  which returns the number of modem samples written at the sound card
+  rate.
+
+\*---------------------------------------------------------------------------*/
+
+int freedv_sound_card_tx_nin(struct freedv *f) {
+    int need;
+
+    assert(f->sound_card_samp_rate);
+    need = f->n_speech_samples - fifo_used(f->sc_tx_fifo);
+    return (need > 0) ? resample_nin(f->sc_tx_in, need) : 0;
+}
+
+int freedv_sound_card_tx(struct freedv *f, short mod_out[], short speech_in[]) {
+    int n;
+
+    assert(f->sound_card_samp_rate);
+    n = resample_short(f->sc_tx_in, f->sc_speech_buf, speech_in, freedv_sound_card_tx_nin(f));
+    fifo_write(f->sc_tx_fifo, f->sc_speech_buf, n);
+    n = fifo_read(f->sc_tx_fifo, f->sc_speech_buf, f->n_speech_samples);
+    assert(n == 0);
+
+    freedv_tx(f, f->sc_modem_buf, f->sc_speech_buf);
+    return resample_short(f->sc_tx_out, mod_out, f->sc_modem_buf, f->n_nom_modem_samples);
+}
+
+/* Largest number of samples at the sound card rate passed to or returned by
+   any of the functions above, size all sound card buffers to this */
+
+int freedv_get_n_max_sound_card_samples(struct freedv *f) {
+    int n, nmax;
+
+    assert(f->sound_card_samp_rate);
+    nmax = resample_max_nout(f->sc_tx_out, f->n_nom_modem_samples);
+    n = resample_max_nout(f->sc_rx_out, f->n_speech_samples);
+    if (n > nmax) nmax = n;
+    n = (int)(((long)f->n_max_modem_samples*f->sound_card_samp_rate + f->modem_sample_rate - 1)/f->modem_sample_rate) + 1;
+    if (n > nmax) nmax = n;
+    n = (int)(((long)f->n_speech_samples*f->sound_card_samp_rate + FS - 1)/FS) + 1;
+    if (n > nmax) nmax = n;
+
+    return nmax;
+}
+
 /*---------------------------------------------------------------------------* \
 
   FUNCTIONS...: freedv_set_sync
@@ -2403,6 +2913,19 @@ int freedv_get_sync_interleaver(struct freedv *f) {
     return 0;
 }
 
+/* LDPC iterations and unsatisfied parity checks summed over the codewords
+   of the last 700D interleaver window decoded */
+
+void freedv_get_ldpc_stats(struct freedv *f, int *iter, int *unsatisfied) {
+    if (f->mode == FREEDV_MODE_700D) {
+        *iter = f->ldpc_iter;
+        *unsatisfied = f->ldpc_unsatisfied;
+    } else {
+        *iter = 0;
+        *unsatisfied = 0;
+    }
+}
+
 int freedv_get_sz_error_pattern(struct freedv *f) 
 {
     if ((f->mode == FREEDV_MODE_700) || (f->mode == FREEDV_MODE_700B) || (f->mode == FREEDV_MODE_700C)) {
@@ -38,6 +38,7 @@
 // This declares a single-precision (float) complex number
 #include <sys/types.h>
 #include "comp.h"
+#include "modem_io.h"
 
 #define FREEDV_MODE_1600        0
 #define FREEDV_MODE_700         1
@@ -80,6 +81,8 @@ typedef void (*freedv_callback_prototx)(void *, char *);
 typedef void (*freedv_callback_datarx)(void *, unsigned char *packet, size_t size);
 /* Called when a new packet can be send */
 typedef void (*freedv_callback_datatx)(void *, unsigned char *packet, size_t *size);
+/* Called with a view of the receive buffer, return non-zero to keep it until freedv_data_rx_release() */
+typedef int (*freedv_callback_datarx_view)(void *, const unsigned char *packet, size_t size);
 
 
 /*---------------------------------------------------------------------------*\
@@ -98,9 +101,18 @@ void freedv_close   (struct freedv *freedv);
 
 void freedv_tx      (struct freedv *freedv, short mod_out[], short speech_in[]);
 void freedv_comptx  (struct freedv *freedv, COMP  mod_out[], short speech_in[]);
+/*
+ * freedv_tx() with the modem samples in the caller's own format, see
+ * modem_io.h, written by the modem itself rather than through a
+ * converted copy.  freedv_tx() is MODEM_IO_SHORT with a scale of 1.0,
+ * freedv_rx() the same but with a scale of 2.0 for 700D.
+ */
+void freedv_tx_io   (struct freedv *freedv, void *mod_out, short speech_in[], const struct MODEM_IO *io);
 void freedv_codectx (struct freedv *f, short mod_out[], unsigned char *packed_codec_bits);
 void freedv_datatx  (struct freedv *f, short mod_out[]);
 int  freedv_data_ntxframes (struct freedv *freedv);
+int  freedv_sound_card_tx_nin(struct freedv *freedv);
+int  freedv_sound_card_tx   (struct freedv *freedv, short mod_out[], short speech_in[]);
 
 // Receive -------------------------------------------------------------------
 
@@ -108,13 +120,23 @@ int freedv_nin      (struct freedv *freedv);
 int freedv_rx       (struct freedv *freedv, short speech_out[], short demod_in[]);
 int freedv_floatrx  (struct freedv *freedv, short speech_out[], float demod_in[]);
 int freedv_comprx   (struct freedv *freedv, short speech_out[], COMP  demod_in[]);
+/* freedv_rx() with the modem samples in any format, see freedv_tx_io() */
+int freedv_rx_io    (struct freedv *freedv, short speech_out[], const void *demod_in, const struct MODEM_IO *io);
+/* receive every whole modem frame in a block of n samples, see freedv_api.c */
+int freedv_rx_block (struct freedv *freedv, const void *demod_in, size_t n, const struct MODEM_IO *io,
+                     size_t *consumed, short speech_out[], int max_speech);
 int freedv_codecrx  (struct freedv *freedv, unsigned char *packed_codec_bits, short demod_in[]);
+int freedv_codecrx_io(struct freedv *freedv, unsigned char *packed_codec_bits, const void *demod_in, const struct MODEM_IO *io);
+int freedv_sound_card_nin(struct freedv *freedv);
+int freedv_sound_card_rx (struct freedv *freedv, short speech_out[], short demod_in[]);
 
 // Set parameters ------------------------------------------------------------
 
 void freedv_set_callback_txt            (struct freedv *freedv, freedv_callback_rx rx, freedv_callback_tx tx, void *callback_state);
 void freedv_set_callback_protocol       (struct freedv *freedv, freedv_callback_protorx rx, freedv_callback_prototx tx, void *callback_state);
 void freedv_set_callback_data           (struct freedv *freedv, freedv_callback_datarx datarx, freedv_callback_datatx datatx, void *callback_state);
+void freedv_set_callback_data_view      (struct freedv *freedv, freedv_callback_datarx_view datarx, void *callback_state);
+void freedv_data_rx_release             (struct freedv *freedv, const unsigned char *packet);
 void freedv_set_test_frames		(struct freedv *freedv, int test_frames);
 void freedv_set_test_frames_diversity	(struct freedv *freedv, int test_frames_diversity);
 void freedv_set_smooth_symbols		(struct freedv *freedv, int smooth_symbols);
@@ -127,12 +149,26 @@ void freedv_set_callback_error_pattern  (struct freedv *freedv, freedv_calback_e
 void freedv_set_varicode_code_num       (struct freedv *freedv, int val);
 void freedv_set_data_header             (struct freedv *freedv, unsigned char *header);
 int  freedv_set_alt_modem_samp_rate     (struct freedv *freedv, int samp_rate);
+int  freedv_set_sound_card_samp_rate    (struct freedv *freedv, int samp_rate);
 void freedv_set_carrier_ampl            (struct freedv *freedv, int c, float ampl);
 void freedv_set_sync                    (struct freedv *freedv, int sync_cmd);
 void freedv_set_verbose                 (struct freedv *freedv, int verbosity);
 void freedv_set_tx_bpf                  (struct freedv *freedv, int val);
 void freedv_set_ext_vco                 (struct freedv *f, int val);
 
+/* 700D LDPC decoder limits, max_iter <= 0 restores the default cap, budget may be NULL */
+struct LDPC_BUDGET;
+void freedv_set_ldpc_max_iter           (struct freedv *f, int max_iter);
+void freedv_set_ldpc_budget             (struct freedv *f, struct LDPC_BUDGET *budget);
+
+/*
+ * Gate the sync search of the 1600, 700, 700C and 700D modems with a
+ * cheap signal presence detector, so an idle channel costs little CPU.
+ * pfa is the chance each 20 ms of noise starts a full search, 0 turns
+ * the detector off.  Returns -1 if the mode is not supported.
+ */
+int  freedv_set_idle_detect             (struct freedv *f, float pfa);
+
 // Get parameters -------------------------------------------------------------------------
 
 struct MODEM_STATS;
@@ -146,12 +182,14 @@ int freedv_get_modem_sample_rate    (struct freedv *freedv);
 int freedv_get_modem_symbol_rate    (struct freedv *freedv);
 int freedv_get_n_max_modem_samples  (struct freedv *freedv);
 int freedv_get_n_nom_modem_samples  (struct freedv *freedv);
+int freedv_get_n_max_sound_card_samples(struct freedv *freedv);
 int freedv_get_total_bits	    (struct freedv *freedv);
 int freedv_get_total_bit_errors	    (struct freedv *freedv);
 int freedv_get_total_bits_coded     (struct freedv *freedv);
 int freedv_get_total_bit_errors_coded(struct freedv *freedv);
 int freedv_get_sync		    (struct freedv *freedv);
 int freedv_get_sync_interleaver	    (struct freedv *freedv);
+void freedv_get_ldpc_stats          (struct freedv *freedv, int *iter, int *unsatisfied);
 struct FSK * freedv_get_fsk         (struct freedv *f);
 struct CODEC2 *freedv_get_codec2    (struct freedv *freedv);
 int freedv_get_n_codec_bits         (struct freedv *freedv);
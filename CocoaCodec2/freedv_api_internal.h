@@ -43,6 +43,9 @@
 #include "fmfsk.h"
 #include "codec2_fdmdv.h"
 #include "codec2_cohpsk.h"
+#include "codec2_fifo.h"
+#include "resample.h"
+#include "tone_detect.h"
 
 struct freedv {
     int                  mode;
@@ -128,8 +131,13 @@ struct freedv {
     /* interleaved LDPC OFDM states ---------------------------------------------------------------------*/
 
     int                  interleave_frames;          // number of OFDM modem frames in interleaver, e.g. 1,2,4,8,16
-    COMP                *codeword_symbols;
+    COMP                *codeword_symbols;           // ring of interleave_frames frames, each stored twice
     float               *codeword_amps;
+    int                  codeword_head;              // ring slot of the oldest frame
+    struct GP_INTERLEAVER *interleaver;              // permutation for interleave_frames*coded_syms_per_frame symbols
+    int                  ldpc_max_iter_default;      // iteration cap set up by the code, restored by freedv_set_ldpc_max_iter(f, 0)
+    int                  ldpc_iter;                  // LDPC iterations used decoding the last interleaver window
+    int                  ldpc_unsatisfied;           // parity checks left unsatisfied in the last window
     int                  modem_frame_count_tx;       // modem frame counter for tx side
     int                  modem_frame_count_rx;       // modem frame counter for rx side
     COMP                *mod_out;                    // output buffer of intereaved frames
@@ -147,8 +155,46 @@ struct freedv {
     void (*freedv_get_next_proto)(void *callback_state, char *proto_bits_packed);
     void *proto_callback_state;
     int n_protocol_bits;
+
+    /* optional signal presence detector run before the sync search, see
+       freedv_set_idle_detect() */
+    struct TONE_DETECT  *idle_detect;            // NULL unless set
+
+    /* optional conversion to and from the sound card sample rate, see
+       freedv_set_sound_card_samp_rate() */
+    int                  sound_card_samp_rate;   // zero unless set
+    struct RESAMPLE     *sc_rx_in;               // sound card to modem rate
+    struct RESAMPLE     *sc_rx_out;              // speech to sound card rate
+    struct RESAMPLE     *sc_tx_in;               // sound card to speech rate
+    struct RESAMPLE     *sc_tx_out;              // modem to sound card rate
+    struct FIFO         *sc_rx_fifo;             // modem samples waiting for freedv_rx()
+    struct FIFO         *sc_tx_fifo;             // speech samples waiting for freedv_tx()
+    short               *sc_modem_buf;
+    short               *sc_speech_buf;
+};
+
+/* The 700D receiver in stages, so they can be pipelined, see
+   freedv_pipeline.h.  freedv_comprx() runs them in turn. */
+
+struct FREEDV_700D_RX {
+    int                  valid;                      // as returned by the comprx functions
+    int                  nout;                       // speech samples for this modem frame
+    int                  decode;                     // a full interleaver window is ready
+    COMP                *codeword_symbols;           // the window, oldest frame first
+    float               *codeword_amps;
+    float                EsNo;
+    float                mean_amp;
+    int                  Nerrs_raw;                  // for the verbose print
+    int                  Nerrs_coded;
+    int                  iter;
+    int                  parityCheckCount;
 };
 
+void freedv_700d_rx_modem(struct freedv *f, const void *demod_in_8kHz, const struct MODEM_IO *io, struct FREEDV_700D_RX *rx);
+void freedv_700d_rx_fec(struct freedv *f, struct FREEDV_700D_RX *rx, unsigned char packed_out[]);
+void freedv_700d_rx_verbose(struct freedv *f, struct FREEDV_700D_RX *rx);
+int  freedv_700d_speech(struct freedv *f, short speech_out[], const unsigned char packed[], int *frame_count);
+
 #endif
 
 #ifdef __cplusplus
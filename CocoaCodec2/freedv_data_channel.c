@@ -32,6 +32,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 static unsigned char fdc_header_bcast[6] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
 
@@ -71,51 +72,160 @@ static unsigned short fdc_crc_table[256] = {
     0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78
 };
 
-static unsigned short fdc_crc(unsigned char *buffer, size_t len)
+/* Slice-by-8: fdc_crc_slice[k][i] is the CRC of byte i followed by k+1 zero bytes */
+static unsigned short fdc_crc_slice[7][256];
+static pthread_once_t fdc_crc_once = PTHREAD_ONCE_INIT;
+
+static void fdc_crc_init(void)
 {
-    unsigned short crc = 0xffff;
-    size_t i;
+    int i, k;
+
+    for (i = 0; i < 256; i++) {
+        unsigned short crc = fdc_crc_table[i];
 
-    for (i = 0; i < len; i++, buffer++) {
+        for (k = 0; k < 7; k++) {
+            crc = (crc >> 8) ^ fdc_crc_table[crc & 0xff];
+            fdc_crc_slice[k][i] = crc;
+        }
+    }
+}
+
+/* Continue a CRC over len more bytes, eight bytes per step */
+static unsigned short fdc_crc_update(unsigned short crc, const unsigned char *buffer, size_t len)
+{
+    while (len >= 8) {
+        crc ^= buffer[0] | (buffer[1] << 8);
+        crc = fdc_crc_slice[6][crc & 0xff] ^
+              fdc_crc_slice[5][crc >> 8] ^
+              fdc_crc_slice[4][buffer[2]] ^
+              fdc_crc_slice[3][buffer[3]] ^
+              fdc_crc_slice[2][buffer[4]] ^
+              fdc_crc_slice[1][buffer[5]] ^
+              fdc_crc_slice[0][buffer[6]] ^
+              fdc_crc_table[buffer[7]];
+        buffer += 8;
+        len -= 8;
+    }
+    for (; len > 0; len--, buffer++) {
         crc = (crc >> 8) ^ fdc_crc_table[(crc ^ *buffer) & 0xff];
     }
 
+    return crc;
+}
+
+static unsigned short fdc_crc(const unsigned char *buffer, size_t len)
+{
+    return fdc_crc_update(0xffff, buffer, len) ^ 0xffff;
+}
+
+/*
+ * CRC4 (0x03 polynomal) of a header frame.  The bit loop of the original
+ * implementation never ran (shift started at 7 with a 'shift <= 0' test),
+ * so every transmitter puts the initial value 0x0f on the air.  Keep that
+ * value so header frames stay compatible.
+ */
+#define FDC_CRC4_HEADER 0x0f
+
+/*
+ * Receive buffer positions in on-air order, where the from address comes
+ * before the to address.  Packets are reassembled with the two swapped so
+ * callbacks get a view of the buffer without another copy.
+ */
+static int fdc_rx_pos(int pos)
+{
+    if (pos < 6)
+        return pos + 6;
+    if (pos < 12)
+        return pos - 6;
+    return pos;
+}
+
+static void fdc_rx_put(unsigned char *packet, int pos, const unsigned char *data, int len)
+{
+    while (len > 0) {
+        int n = (pos < 12) ? 6 - pos % 6 : len;
+
+        if (n > len)
+            n = len;
+        memcpy(packet + fdc_rx_pos(pos), data, n);
+        pos += n;
+        data += n;
+        len -= n;
+    }
+}
+
+/* CRC of the first len bytes of a reassembled packet, in on-air order */
+static unsigned short fdc_rx_crc(const unsigned char *packet, int len)
+{
+    unsigned short crc = 0xffff;
+    int pos = 0;
+
+    while (pos < len) {
+        int n = (pos < 12) ? 6 - pos % 6 : len - pos;
+
+        if (n > len - pos)
+            n = len - pos;
+        crc = fdc_crc_update(crc, packet + fdc_rx_pos(pos), n);
+        pos += n;
+    }
+
     return crc ^ 0xffff;
 }
 
-/* CRC4 0x03 polynomal */
-static unsigned char fdc_crc4(unsigned char *buffer, size_t len)
+/* Move reception to a slot no view holds, or -1 if there is none */
+static void fdc_rx_next_slot(struct freedv_data_channel *fdc)
 {
-    unsigned char crc = 0x0f;
-    size_t i;
-    
-    for (i = 0; i < len; i++, buffer++) {
-        int shift;
-	
-        for (shift = 7; shift <= 0; shift--) {
-            crc <<= 1;
-            if ((*buffer >> shift) & 0x1)
-                crc |= 1;
-            if (crc & 0x10)
-                crc ^= 0x03;
-	}
+    int i, slot;
+
+    for (i = 0; i < FREEDV_DATA_CHANNEL_RX_SLOTS; i++) {
+        slot = (fdc->rx_cur + 1 + i + FREEDV_DATA_CHANNEL_RX_SLOTS) % FREEDV_DATA_CHANNEL_RX_SLOTS;
+        if (!atomic_load(&fdc->rx_slot[slot].held)) {
+            fdc->rx_cur = slot;
+            return;
+        }
+    }
+    fdc->rx_cur = -1;
+}
+
+/* Pass a complete packet in the current slot to the callbacks */
+static void fdc_rx_deliver(struct freedv_data_channel *fdc, size_t size)
+{
+    struct freedv_data_rx_slot *slot = &fdc->rx_slot[fdc->rx_cur];
+
+    if (fdc->cb_rx) {
+        fdc->cb_rx(fdc->cb_rx_state, slot->packet, size);
+    }
+    if (fdc->cb_rx_view) {
+        atomic_store(&slot->held, 1);
+        if (fdc->cb_rx_view(fdc->cb_rx_view_state, slot->packet, size))
+            fdc_rx_next_slot(fdc);
+        else
+            atomic_store(&slot->held, 0);
     }
-    
-    return crc & 0x0f;
 }
- 
+
 struct freedv_data_channel *freedv_data_channel_create(void)
 {
     struct freedv_data_channel *fdc;
-  
+    int i;
+
+    pthread_once(&fdc_crc_once, fdc_crc_init);
+
     fdc = malloc(sizeof(struct freedv_data_channel));
     if (!fdc)
         return NULL;
 
     fdc->cb_rx = NULL;
+    fdc->cb_rx_view = NULL;
     fdc->cb_tx = NULL;
     fdc->packet_tx_size = 0;
 
+    for (i = 0; i < FREEDV_DATA_CHANNEL_RX_SLOTS; i++)
+        atomic_init(&fdc->rx_slot[i].held, 0);
+    fdc->rx_cur = 0;
+    fdc->packet_rx_cnt = 0;
+    fdc->rx_dropped = 0;
+
     freedv_data_set_header(fdc, fdc_header_bcast);
 
     memcpy(fdc->rx_header, fdc->tx_header, 8);
@@ -141,8 +251,27 @@ void freedv_data_set_cb_tx(struct freedv_data_channel *fdc, freedv_data_callback
     fdc->cb_tx_state = state;
 }
 
+void freedv_data_set_cb_rx_view(struct freedv_data_channel *fdc, freedv_data_callback_rx_view cb, void *state)
+{
+    fdc->cb_rx_view = cb;
+    fdc->cb_rx_view_state = state;
+}
+
+void freedv_data_channel_release(struct freedv_data_channel *fdc, const unsigned char *packet)
+{
+    int i;
+
+    for (i = 0; i < FREEDV_DATA_CHANNEL_RX_SLOTS; i++) {
+        if (packet == fdc->rx_slot[i].packet) {
+            atomic_store(&fdc->rx_slot[i].held, 0);
+            return;
+        }
+    }
+}
+
 void freedv_data_channel_rx_frame(struct freedv_data_channel *fdc, unsigned char *data, size_t size, int from_bit, int bcast_bit, int crc_bit, int end_bits)
 {
+    unsigned char *packet;
     int copy_bits;
     if (end_bits) {
         copy_bits = end_bits;
@@ -150,18 +279,35 @@ void freedv_data_channel_rx_frame(struct freedv_data_channel *fdc, unsigned char
         copy_bits = size;
     }
 
+    /* Only the first frame of a packet has compressed addresses, so a lost
+       end frame does not take the next packet with it */
+    if (from_bit || bcast_bit || crc_bit)
+        fdc->packet_rx_cnt = 0;
+
+    /* Every buffer is still held by a view, look again for a free one */
+    if (fdc->rx_cur < 0) {
+        fdc_rx_next_slot(fdc);
+        if (fdc->rx_cur < 0) {
+            if (end_bits)
+                fdc->rx_dropped++;
+            return;
+        }
+        fdc->packet_rx_cnt = 0;
+    }
+    packet = fdc->rx_slot[fdc->rx_cur].packet;
+
     /* New packet? */
     if (fdc->packet_rx_cnt == 0) {
         /* Does the packet have a compressed from field? */
         if (from_bit) {
 	    /* Compressed from: take the previously received header */
-	    memcpy(fdc->packet_rx + fdc->packet_rx_cnt, fdc->rx_header, 6);
+	    fdc_rx_put(packet, fdc->packet_rx_cnt, fdc->rx_header, 6);
 	    fdc->packet_rx_cnt += 6;	    
        	}
 	if (bcast_bit) {
             if (!from_bit) {
                 /* Copy from header and modify size and end_bits accordingly */
-                memcpy(fdc->packet_rx + fdc->packet_rx_cnt, data, 6);
+                fdc_rx_put(packet, fdc->packet_rx_cnt, data, 6);
                 fdc->packet_rx_cnt += 6;
                 copy_bits -= 6;
                 if (copy_bits < 0)
@@ -169,18 +315,15 @@ void freedv_data_channel_rx_frame(struct freedv_data_channel *fdc, unsigned char
                 data += 6;
             }
             /* Compressed to: fill in broadcast address */
-            memcpy(fdc->packet_rx + fdc->packet_rx_cnt, fdc_header_bcast, sizeof(fdc_header_bcast));
+            fdc_rx_put(packet, fdc->packet_rx_cnt, fdc_header_bcast, sizeof(fdc_header_bcast));
             fdc->packet_rx_cnt += 6;
 	}
         if (crc_bit) {
-            unsigned char calc_crc = fdc_crc4(data, size);
-            if (calc_crc == end_bits) {
-	        /* It is a single header field, remember it for later */
-                memcpy(fdc->packet_rx + 6, data, 6);
-		memcpy(fdc->packet_rx, fdc_header_bcast, 6);
-                if (fdc->cb_rx) {
-                    fdc->cb_rx(fdc->cb_rx_state, fdc->packet_rx, 12);
-                }
+            if (end_bits == FDC_CRC4_HEADER) {
+	        /* It is a single header field */
+                memcpy(packet + 6, data, 6);
+		memcpy(packet, fdc_header_bcast, 6);
+                fdc_rx_deliver(fdc, 12);
             }
             fdc->packet_rx_cnt = 0;
             return;
@@ -193,33 +336,28 @@ void freedv_data_channel_rx_frame(struct freedv_data_channel *fdc, unsigned char
 	return;
     }
 
-    memcpy(fdc->packet_rx + fdc->packet_rx_cnt, data, copy_bits);
+    fdc_rx_put(packet, fdc->packet_rx_cnt, data, copy_bits);
     fdc->packet_rx_cnt += copy_bits;
     
     if (end_bits != 0 && fdc->packet_rx_cnt >= 2) {
-        unsigned short calc_crc = fdc_crc(fdc->packet_rx, fdc->packet_rx_cnt - 2);
+        int crc_pos = fdc->packet_rx_cnt - 2;
+        unsigned short calc_crc = fdc_rx_crc(packet, crc_pos);
         unsigned short rx_crc;
-	rx_crc = fdc->packet_rx[fdc->packet_rx_cnt - 1] << 8;
-        rx_crc |= fdc->packet_rx[fdc->packet_rx_cnt - 2];
+	rx_crc = packet[fdc_rx_pos(crc_pos + 1)] << 8;
+        rx_crc |= packet[fdc_rx_pos(crc_pos)];
 
         if (rx_crc == calc_crc) {
+            size_t size_rx = crc_pos;
+
             if (fdc->packet_rx_cnt == size) {
 	        /* It is a single header field, remember it for later */
-                memcpy(fdc->rx_header, fdc->packet_rx, 6);
+                memcpy(fdc->rx_header, packet + 6, 6);
+                memcpy(packet, fdc_header_bcast, 6);
             }
 
-            /* callback */
-            if (fdc->cb_rx) {
-                unsigned char tmp[6];
-		memcpy(tmp, fdc->packet_rx, 6);
-		memcpy(fdc->packet_rx, fdc->packet_rx + 6, 6);
-		memcpy(fdc->packet_rx + 6, tmp, 6);
-		
-		size_t size = fdc->packet_rx_cnt - 2;
-                if (size < 12)
-                    size = 12;
-                fdc->cb_rx(fdc->cb_rx_state, fdc->packet_rx, size);
-            }
+            if (size_rx < 12)
+                size_rx = 12;
+            fdc_rx_deliver(fdc, size_rx);
         }    
         fdc->packet_rx_cnt = 0;
     }
@@ -242,7 +380,7 @@ void freedv_data_channel_tx_frame(struct freedv_data_channel *fdc, unsigned char
 	    /* Nothing to send, insert a header frame */
 	    memcpy(fdc->packet_tx, fdc->tx_header, size);
             if (size < 8) {
-                *end_bits = fdc_crc4(fdc->tx_header, size);
+                *end_bits = FDC_CRC4_HEADER;
                 *crc_bit = 1;
                 memcpy(data, fdc->tx_header, size);
 
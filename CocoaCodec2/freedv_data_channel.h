@@ -32,22 +32,44 @@
 #define _FREEDV_DATA_CHANNEL_H
 
 #include <stdlib.h>
+#include <stdatomic.h>
 
 #define FREEDV_DATA_CHANNEL_PACKET_MAX 2048
 
+/* Packets that can be held by the receiver at once, see freedv_data_callback_rx_view */
+#define FREEDV_DATA_CHANNEL_RX_SLOTS   4
+
 typedef void (*freedv_data_callback_rx)(void *, unsigned char *packet, size_t size);
 typedef void (*freedv_data_callback_tx)(void *, unsigned char *packet, size_t *size);
 
+/*
+ * Hands out a view of the reassembly buffer, to address first as for
+ * freedv_data_callback_rx.  Returning zero gives the buffer straight back,
+ * non-zero keeps the packet valid until freedv_data_channel_release() so it can
+ * be processed later, while reception continues into another buffer.
+ */
+typedef int (*freedv_data_callback_rx_view)(void *, const unsigned char *packet, size_t size);
+
+/* A reassembly buffer, bytes are kept in callback order: to, from, payload, CRC */
+struct freedv_data_rx_slot {
+    unsigned char packet[FREEDV_DATA_CHANNEL_PACKET_MAX + 2];
+    atomic_int held;                    /* owned by a view callback */
+};
+
 struct freedv_data_channel {
     freedv_data_callback_rx cb_rx;
     void *cb_rx_state;
-     freedv_data_callback_tx cb_tx;
+    freedv_data_callback_rx_view cb_rx_view;
+    void *cb_rx_view_state;
+    freedv_data_callback_tx cb_tx;
     void *cb_tx_state;
-   
+
     unsigned char rx_header[8];
-    unsigned char packet_rx[FREEDV_DATA_CHANNEL_PACKET_MAX + 2];
-    int packet_rx_cnt;
-    
+    struct freedv_data_rx_slot rx_slot[FREEDV_DATA_CHANNEL_RX_SLOTS];
+    int rx_cur;                         /* slot being filled, -1 if all are held */
+    int packet_rx_cnt;                  /* bytes received for the current packet */
+    int rx_dropped;                     /* packets lost because every slot was held */
+
     unsigned char tx_header[8];
     unsigned char packet_tx[FREEDV_DATA_CHANNEL_PACKET_MAX + 2];
     int packet_tx_cnt;
@@ -60,6 +82,10 @@ void freedv_data_channel_destroy(struct freedv_data_channel *fdc);
 
 void freedv_data_set_cb_rx(struct freedv_data_channel *fdc, freedv_data_callback_rx cb, void *state);
 void freedv_data_set_cb_tx(struct freedv_data_channel *fdc, freedv_data_callback_tx cb, void *state);
+void freedv_data_set_cb_rx_view(struct freedv_data_channel *fdc, freedv_data_callback_rx_view cb, void *state);
+
+/* Give back a packet kept by a view callback, may be called from any thread */
+void freedv_data_channel_release(struct freedv_data_channel *fdc, const unsigned char *packet);
 
 void freedv_data_channel_rx_frame(struct freedv_data_channel *fdc, unsigned char *data, size_t size, int from_bit, int bcast_bit, int crc_bit, int end_bits);
 void freedv_data_channel_tx_frame(struct freedv_data_channel *fdc, unsigned char *data, size_t size, int *from_bit, int *bcast_bit, int *crc_bit, int *end_bits);
@@ -0,0 +1,410 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: freedv_offline.c
+  DATE CREATED: October 2026
+
+  Faster than real time decoding of recorded FreeDV signals, see
+  freedv_offline.h.
+
+  Each segment owns the samples [start, end) of the recording, and is
+  decoded by a fresh freedv that starts overlap samples earlier, so by
+  start it has had the time a live receiver would have to find sync and
+  fill the interleaver.  Events are kept only for modem frames that
+  start in the owned range, so each frame lands in exactly one segment
+  and the segments just have to be put end to end.  Sync events are
+  sent for the first owned frame of every segment, and the stitching
+  drops those that don't change the state.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License version 2.1, as
+  published by the Free Software Foundation.  This program is
+  distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "codec2.h"
+#include "freedv_offline.h"
+
+struct OFFLINE_SEGMENT {
+    long            start, end;         /* owned samples                        */
+    struct FREEDV_OFFLINE_EVENT *event;
+    long            nevents, max_events;
+    unsigned char  *codec_bits;
+    long            ncodec_bytes, max_codec_bytes;
+    int             error;
+};
+
+struct OFFLINE_JOB {
+    const struct FREEDV_OFFLINE_CONFIG *config;
+    const char     *samples;
+    size_t          n;
+    const struct MODEM_IO *io;
+    int             size;               /* bytes per sample                     */
+    long            overlap;
+    long            snr_period;         /* samples between SNR events           */
+    struct OFFLINE_SEGMENT *seg;
+    int             nsegs;
+    atomic_int      next;               /* next segment to decode               */
+};
+
+/* txt callback state, txt chars come out while freedv_codecrx_io() runs */
+
+struct OFFLINE_RX {
+    struct OFFLINE_SEGMENT *seg;
+    long            sample;
+    int             owned;
+};
+
+static struct FREEDV_OFFLINE_EVENT *add_event(struct OFFLINE_SEGMENT *seg, int type, long sample) {
+    struct FREEDV_OFFLINE_EVENT *e;
+
+    if (seg->nevents == seg->max_events) {
+        long max_events = seg->max_events ? 2*seg->max_events : 256;
+        e = realloc(seg->event, max_events*sizeof(struct FREEDV_OFFLINE_EVENT));
+        if (e == NULL) {
+            seg->error = 1;
+            return NULL;
+        }
+        seg->event = e;
+        seg->max_events = max_events;
+    }
+
+    e = &seg->event[seg->nevents++];
+    memset(e, 0, sizeof(struct FREEDV_OFFLINE_EVENT));
+    e->type = type;
+    e->sample = sample;
+    return e;
+}
+
+static void add_codec(struct OFFLINE_SEGMENT *seg, long sample, const unsigned char packed[], int nbytes) {
+    struct FREEDV_OFFLINE_EVENT *e;
+
+    if (seg->ncodec_bytes + nbytes > seg->max_codec_bytes) {
+        long max_bytes = 2*seg->max_codec_bytes + nbytes;
+        unsigned char *bits = realloc(seg->codec_bits, max_bytes);
+        if (bits == NULL) {
+            seg->error = 1;
+            return;
+        }
+        seg->codec_bits = bits;
+        seg->max_codec_bytes = max_bytes;
+    }
+
+    e = add_event(seg, FREEDV_OFFLINE_CODEC, sample);
+    if (e != NULL) {
+        e->offset = seg->ncodec_bytes;
+        e->nbytes = nbytes;
+        memcpy(&seg->codec_bits[seg->ncodec_bytes], packed, nbytes);
+        seg->ncodec_bytes += nbytes;
+    }
+}
+
+static void offline_txt(void *state, char c) {
+    struct OFFLINE_RX *rx = state;
+    struct FREEDV_OFFLINE_EVENT *e;
+
+    if (rx->owned) {
+        e = add_event(rx->seg, FREEDV_OFFLINE_TXT, rx->sample);
+        if (e != NULL)
+            e->c = c;
+    }
+}
+
+static struct freedv *offline_open(const struct FREEDV_OFFLINE_CONFIG *config) {
+    struct freedv *f;
+
+    if (config->adv != NULL)
+        f = freedv_open_advanced(config->mode, config->adv);
+    else
+        f = freedv_open(config->mode);
+    if ((f != NULL) && (config->setup != NULL))
+        config->setup(f, config->setup_state);
+    return f;
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: decode_segment
+  DATE CREATED: October 2026
+
+  Runs one freedv from overlap samples before the segment to the last
+  modem frame starting inside it, recording the events of the frames
+  that start inside it.
+
+\*---------------------------------------------------------------------------*/
+
+static void decode_segment(struct OFFLINE_JOB *job, struct OFFLINE_SEGMENT *seg) {
+    struct OFFLINE_RX rx;
+    struct FREEDV_OFFLINE_EVENT *e;
+    struct freedv *f;
+    unsigned char *packed;
+    long  pos, next_snr;
+    int   nin, nbytes, sync, last_sync = -1;
+    float snr;
+
+    f = offline_open(job->config);
+    if (f == NULL) {
+        seg->error = 1;
+        return;
+    }
+    packed = malloc(freedv_get_n_codec_bits(f));
+    if (packed == NULL) {
+        freedv_close(f);
+        seg->error = 1;
+        return;
+    }
+
+    rx.seg = seg;
+    freedv_set_callback_txt(f, offline_txt, NULL, &rx);
+
+    pos = seg->start - job->overlap;
+    if (pos < 0)
+        pos = 0;
+    next_snr = seg->start;
+
+    while ((pos < seg->end) && (pos + (nin = freedv_nin(f)) <= (long)job->n) && !seg->error) {
+        rx.sample = pos;
+        rx.owned = (pos >= seg->start);
+        nbytes = freedv_codecrx_io(f, packed, job->samples + pos*job->size, job->io);
+
+        if (rx.owned) {
+            freedv_get_modem_stats(f, &sync, &snr);
+            if (sync != last_sync) {
+                e = add_event(seg, FREEDV_OFFLINE_SYNC, pos);
+                if (e != NULL) {
+                    e->sync = sync;
+                    e->snr = snr;
+                }
+                last_sync = sync;
+            }
+            if (nbytes)
+                add_codec(seg, pos, packed, nbytes);
+            if (sync && (pos >= next_snr)) {
+                e = add_event(seg, FREEDV_OFFLINE_SNR, pos);
+                if (e != NULL)
+                    e->snr = snr;
+                next_snr = pos + job->snr_period;
+            }
+        }
+        pos += nin;
+    }
+
+    free(packed);
+    freedv_close(f);
+}
+
+static void *offline_worker(void *arg) {
+    struct OFFLINE_JOB *job = arg;
+    int i;
+
+    while ((i = atomic_fetch_add(&job->next, 1)) < job->nsegs)
+        decode_segment(job, &job->seg[i]);
+    return NULL;
+}
+
+/* put the segments end to end, dropping sync events that change nothing */
+
+static struct FREEDV_OFFLINE_TRANSCRIPT *stitch(struct OFFLINE_JOB *job) {
+    struct FREEDV_OFFLINE_TRANSCRIPT *t;
+    long nevents = 0, nbytes = 0, j;
+    int  i, sync = 0;
+
+    for(i=0; i<job->nsegs; i++) {
+        if (job->seg[i].error)
+            return NULL;
+        nevents += job->seg[i].nevents;
+        nbytes += job->seg[i].ncodec_bytes;
+    }
+
+    t = calloc(1, sizeof(struct FREEDV_OFFLINE_TRANSCRIPT));
+    if (t == NULL)
+        return NULL;
+    t->event = malloc((nevents ? nevents : 1)*sizeof(struct FREEDV_OFFLINE_EVENT));
+    t->codec_bits = malloc(nbytes ? nbytes : 1);
+    if ((t->event == NULL) || (t->codec_bits == NULL)) {
+        freedv_offline_free(t);
+        return NULL;
+    }
+
+    for(i=0; i<job->nsegs; i++) {
+        struct OFFLINE_SEGMENT *seg = &job->seg[i];
+
+        for(j=0; j<seg->nevents; j++) {
+            struct FREEDV_OFFLINE_EVENT *e = &seg->event[j];
+
+            if (e->type == FREEDV_OFFLINE_SYNC) {
+                if (e->sync == sync)
+                    continue;
+                sync = e->sync;
+            }
+            t->event[t->nevents] = *e;
+            if (e->type == FREEDV_OFFLINE_CODEC)
+                t->event[t->nevents].offset += t->ncodec_bytes;
+            t->nevents++;
+        }
+        memcpy(&t->codec_bits[t->ncodec_bytes], seg->codec_bits, seg->ncodec_bytes);
+        t->ncodec_bytes += seg->ncodec_bytes;
+    }
+
+    return t;
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: freedv_offline_decode
+  DATE CREATED: October 2026
+
+  Segments are shortened from segment_s when there would be fewer than
+  four per thread, so the threads finish together, though never below
+  four overlaps, which caps the work repeated in the overlaps at a
+  quarter.  Segments and overlaps are whole nominal modem frames, so
+  while the demod timing holds still the segment decoders frame the
+  signal just as one decoder running through would.
+
+\*---------------------------------------------------------------------------*/
+
+struct FREEDV_OFFLINE_TRANSCRIPT *freedv_offline_decode(const struct FREEDV_OFFLINE_CONFIG *config,
+                                                        const void *samples, size_t n, const struct MODEM_IO *io) {
+    struct FREEDV_OFFLINE_TRANSCRIPT *t;
+    struct OFFLINE_JOB job;
+    struct freedv *f;
+    pthread_t *thread;
+    long  seg_len, fs, n_nom;
+    int   i, n_threads, bytes_per_codec_frame;
+
+    assert(config != NULL);
+
+    /* a first freedv to look up the mode's rates */
+
+    f = offline_open(config);
+    if (f == NULL)
+        return NULL;
+    fs = freedv_get_modem_sample_rate(f);
+    n_nom = freedv_get_n_nom_modem_samples(f);
+    bytes_per_codec_frame = (codec2_bits_per_frame(freedv_get_codec2(f)) + 7)/8;
+    freedv_close(f);
+
+    n_threads = (config->n_threads > 0) ? config->n_threads : 1;
+    job.config = config;
+    job.samples = samples;
+    job.n = n;
+    job.io = io;
+    job.size = modem_io_size(io);
+    job.overlap = fs*((config->overlap_s > 0.0) ? config->overlap_s : FREEDV_OFFLINE_OVERLAP);
+    job.snr_period = fs;
+    seg_len = fs*((config->segment_s > 0.0) ? config->segment_s : FREEDV_OFFLINE_SEGMENT);
+    if ((long)n/seg_len < 4*n_threads) {
+        seg_len = n/(4*n_threads);
+        if (seg_len < 4*job.overlap)
+            seg_len = 4*job.overlap;
+    }
+
+    /* whole modem frames, so each segment's decoder starts on the frame grid */
+
+    job.overlap = (job.overlap + n_nom - 1)/n_nom*n_nom;
+    seg_len = (seg_len + n_nom - 1)/n_nom*n_nom;
+    if (seg_len < n_nom)
+        seg_len = n_nom;
+    job.nsegs = (n + seg_len - 1)/seg_len;
+    job.seg = calloc(job.nsegs ? job.nsegs : 1, sizeof(struct OFFLINE_SEGMENT));
+    if (job.seg == NULL)
+        return NULL;
+    for(i=0; i<job.nsegs; i++) {
+        job.seg[i].start = i*seg_len;
+        job.seg[i].end = (i == job.nsegs-1) ? (long)n : (i+1)*seg_len;
+    }
+    atomic_init(&job.next, 0);
+
+    if (n_threads > job.nsegs)
+        n_threads = job.nsegs;
+    thread = malloc((n_threads ? n_threads : 1)*sizeof(pthread_t));
+    if (thread == NULL) {
+        free(job.seg);
+        return NULL;
+    }
+
+    /* this thread is one of the workers */
+
+    for(i=1; i<n_threads; i++) {
+        if (pthread_create(&thread[i], NULL, offline_worker, &job) != 0)
+            break;
+    }
+    offline_worker(&job);
+    while (--i > 0)
+        pthread_join(thread[i], NULL);
+    free(thread);
+
+    t = stitch(&job);
+    if (t != NULL) {
+        t->bytes_per_codec_frame = bytes_per_codec_frame;
+        t->seconds = (double)n/fs;
+    }
+
+    for(i=0; i<job.nsegs; i++) {
+        free(job.seg[i].event);
+        free(job.seg[i].codec_bits);
+    }
+    free(job.seg);
+    return t;
+}
+
+
+struct FREEDV_OFFLINE_TRANSCRIPT *freedv_offline_decode_file(const struct FREEDV_OFFLINE_CONFIG *config,
+                                                             const char *path, const struct MODEM_IO *io) {
+    struct FREEDV_OFFLINE_TRANSCRIPT *t;
+    struct stat st;
+    void  *samples = NULL;
+    size_t n;
+    int    fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    n = st.st_size/modem_io_size(io);
+    if (n > 0) {
+        samples = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (samples == MAP_FAILED) {
+            close(fd);
+            return NULL;
+        }
+    }
+
+    t = freedv_offline_decode(config, samples, n, io);
+
+    if (n > 0)
+        munmap(samples, st.st_size);
+    close(fd);
+    return t;
+}
+
+
+void freedv_offline_free(struct FREEDV_OFFLINE_TRANSCRIPT *t) {
+    if (t != NULL) {
+        free(t->event);
+        free(t->codec_bits);
+        free(t);
+    }
+}
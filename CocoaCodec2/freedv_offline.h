@@ -0,0 +1,97 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: freedv_offline.h
+  DATE CREATED: October 2026
+
+  Faster than real time decoding of recorded FreeDV signals.  The
+  recording is cut into segments that are decoded on a pool of threads,
+  each by its own freedv instance started a little before the segment
+  so it has time to sync, and the results are stitched back together
+  into one time ordered transcript of codec frames, txt and sync/SNR
+  events.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License version 2.1, as
+  published by the Free Software Foundation.  This program is
+  distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __FREEDV_OFFLINE__
+#define __FREEDV_OFFLINE__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include "freedv_api.h"
+
+#define FREEDV_OFFLINE_SEGMENT  60.0    /* default segment length, seconds        */
+#define FREEDV_OFFLINE_OVERLAP  5.0     /* default decode ahead of each segment   */
+
+/* event types */
+
+#define FREEDV_OFFLINE_CODEC    0       /* codec frames from one modem frame      */
+#define FREEDV_OFFLINE_TXT      1       /* one received txt character             */
+#define FREEDV_OFFLINE_SYNC     2       /* modem sync gained or lost              */
+#define FREEDV_OFFLINE_SNR      3       /* SNR estimate, once a second in sync    */
+
+struct FREEDV_OFFLINE_EVENT {
+    int   type;
+    long  sample;       /* start of the modem frame in the recording, in samples */
+    int   sync;         /* SYNC: the new state                                   */
+    float snr;          /* SYNC, SNR: SNR estimate in dB                          */
+    char  c;            /* TXT                                                   */
+    long  offset;       /* CODEC: packed codec bits at codec_bits[offset], as    */
+    int   nbytes;       /* from freedv_codecrx()                                 */
+};
+
+struct FREEDV_OFFLINE_TRANSCRIPT {
+    struct FREEDV_OFFLINE_EVENT *event;
+    long           nevents;
+    unsigned char *codec_bits;
+    long           ncodec_bytes;
+    int            bytes_per_codec_frame;
+    double         seconds;             /* length of the recording              */
+};
+
+struct FREEDV_OFFLINE_CONFIG {
+    int    mode;                        /* FREEDV_MODE_xxx                      */
+    struct freedv_advanced *adv;        /* for freedv_open_advanced(), or NULL  */
+    int    n_threads;
+    float  segment_s;                   /* 0 for FREEDV_OFFLINE_SEGMENT         */
+    float  overlap_s;                   /* 0 for FREEDV_OFFLINE_OVERLAP         */
+
+    /* optional, called on each freedv opened, e.g. to set test frames */
+
+    void (*setup)(struct freedv *f, void *state);
+    void  *setup_state;
+};
+
+/*
+ * Decode n modem samples in format io, at the mode's modem sample rate.
+ * Returns NULL if a freedv can't be opened or memory runs out.
+ */
+struct FREEDV_OFFLINE_TRANSCRIPT *freedv_offline_decode(const struct FREEDV_OFFLINE_CONFIG *config,
+                                                        const void *samples, size_t n, const struct MODEM_IO *io);
+
+/* As freedv_offline_decode(), on a file of raw samples, which is memory mapped */
+struct FREEDV_OFFLINE_TRANSCRIPT *freedv_offline_decode_file(const struct FREEDV_OFFLINE_CONFIG *config,
+                                                             const char *path, const struct MODEM_IO *io);
+
+void freedv_offline_free(struct FREEDV_OFFLINE_TRANSCRIPT *t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
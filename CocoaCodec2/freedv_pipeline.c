@@ -0,0 +1,441 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: freedv_pipeline.c
+  DATE CREATED: October 2026
+
+  Pipelined FreeDV 700D receiver.  The stages are the ones freedv_comprx()
+  runs in turn:
+
+    modem:   freedv_700d_rx_modem(), demod, sync, txt, interleaver window
+    FEC:     freedv_700d_rx_fec(), LDPC decode of a window
+    vocoder: freedv_700d_speech(), Codec 2 decode
+
+  Each modem frame becomes a job in a ring shared by the three threads.
+  The ring and the sample queues either side are single producer single
+  consumer, the hand over is just an atomic counter, so no stage waits
+  on a lock held by another.  The mutex and condition variable are only
+  used to sleep when a stage has nothing to do.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License version 2.1, as
+  published by the Free Software Foundation.  This program is
+  distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "freedv_pipeline.h"
+#include "freedv_api_internal.h"
+#include "mpdecode_core.h"
+
+#define FREEDV_PIPE_SPEECH_FS 8000     /* Codec 2 speech sample rate */
+
+struct FREEDV_PIPE_JOB {
+    struct FREEDV_700D_RX rx;
+    COMP          *symbols;            /* copy of the interleaver window */
+    float         *amps;
+    unsigned char *packed;             /* Codec 2 frames from the FEC    */
+};
+
+struct FREEDV_PIPE {
+    struct freedv  *f;
+
+    /* modem samples in, written by the caller, read by the modem thread */
+
+    COMP           *in;
+    int             in_size;
+    atomic_long     in_wr, in_rd;
+    atomic_int      nin;               /* samples the modem needs next   */
+
+    /* modem frames, job_modem >= job_fec >= job_voc */
+
+    struct FREEDV_PIPE_JOB *job;
+    int             njobs;
+    atomic_long     job_modem, job_fec, job_voc;
+    int             nsyms;             /* symbols in a window            */
+
+    /* speech out, written by the vocoder thread, read by the caller */
+
+    short          *out;
+    int             out_size;
+    atomic_long     out_wr, out_rd;
+
+    /* vocoder thread state */
+
+    unsigned char  *packed;            /* last decoded window            */
+    int             frame_count;       /* modem frame of it to play next */
+    short          *speech;
+
+    COMP           *frame;             /* modem thread scratch           */
+
+    pthread_t       threads[3];
+    int             n_threads;
+    pthread_mutex_t lock;
+    pthread_cond_t  cv;
+    atomic_int      quit;
+};
+
+static void freedv_pipe_free(struct FREEDV_PIPE *p);
+
+/* wake every stage, called after publishing new work or freeing space */
+
+static void freedv_pipe_wake(struct FREEDV_PIPE *p) {
+    pthread_mutex_lock(&p->lock);
+    pthread_cond_broadcast(&p->cv);
+    pthread_mutex_unlock(&p->lock);
+}
+
+/* sleep until ready(p) or quit, returns 0 on quit */
+
+static int freedv_pipe_wait(struct FREEDV_PIPE *p, int (*ready)(struct FREEDV_PIPE *p)) {
+    int go;
+
+    pthread_mutex_lock(&p->lock);
+    while (!atomic_load(&p->quit) && !ready(p))
+        pthread_cond_wait(&p->cv, &p->lock);
+    go = !atomic_load(&p->quit);
+    pthread_mutex_unlock(&p->lock);
+    return go;
+}
+
+static int freedv_pipe_modem_ready(struct FREEDV_PIPE *p) {
+    return (atomic_load(&p->in_wr) - atomic_load(&p->in_rd) >= atomic_load(&p->nin)) &&
+           (atomic_load(&p->job_modem) - atomic_load(&p->job_voc) < p->njobs);
+}
+
+static int freedv_pipe_fec_ready(struct FREEDV_PIPE *p) {
+    return atomic_load(&p->job_fec) < atomic_load(&p->job_modem);
+}
+
+static int freedv_pipe_voc_ready(struct FREEDV_PIPE *p) {
+    return (atomic_load(&p->job_voc) < atomic_load(&p->job_fec)) &&
+           (p->out_size - (atomic_load(&p->out_wr) - atomic_load(&p->out_rd)) >= p->f->n_speech_samples);
+}
+
+static int freedv_pipe_idle(struct FREEDV_PIPE *p) {
+    if (p->out_size - (atomic_load(&p->out_wr) - atomic_load(&p->out_rd)) < p->f->n_speech_samples)
+        return 1;
+    return (atomic_load(&p->in_wr) - atomic_load(&p->in_rd) < atomic_load(&p->nin)) &&
+           (atomic_load(&p->job_voc) == atomic_load(&p->job_modem));
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: freedv_pipe_modem_thread
+  DATE CREATED: October 2026
+
+  Takes f->nin samples at a time, as freedv_nin() would ask for, and
+  leaves a copy of the interleaver window in the job when it is ready
+  to decode, as the ring in f moves on with the next frame.  With
+  verbose on, the FEC columns printed are those of the interleaver sync
+  search, as the window has not been decoded yet.
+
+\*---------------------------------------------------------------------------*/
+
+static void *freedv_pipe_modem_thread(void *arg) {
+    struct FREEDV_PIPE *p = (struct FREEDV_PIPE*)arg;
+    struct freedv *f = p->f;
+    struct FREEDV_PIPE_JOB *job;
+    long   rd, n_job;
+    int    i, nin;
+
+    while (freedv_pipe_wait(p, freedv_pipe_modem_ready)) {
+        nin = atomic_load(&p->nin);
+        rd = atomic_load(&p->in_rd);
+        for(i=0; i<nin; i++)
+            p->frame[i] = p->in[(rd + i) % p->in_size];
+        atomic_store(&p->in_rd, rd + nin);
+
+        n_job = atomic_load(&p->job_modem);
+        job = &p->job[n_job % p->njobs];
+        freedv_700d_rx_modem(f, p->frame, &modem_io_comp, &job->rx);
+        freedv_700d_rx_verbose(f, &job->rx);
+        if (job->rx.decode) {
+            memcpy(job->symbols, job->rx.codeword_symbols, sizeof(COMP)*p->nsyms);
+            memcpy(job->amps, job->rx.codeword_amps, sizeof(float)*p->nsyms);
+            job->rx.codeword_symbols = job->symbols;
+            job->rx.codeword_amps = job->amps;
+        }
+
+        atomic_store(&p->nin, f->nin);
+        atomic_store(&p->job_modem, n_job + 1);
+        freedv_pipe_wake(p);
+    }
+
+    return NULL;
+}
+
+
+static void *freedv_pipe_fec_thread(void *arg) {
+    struct FREEDV_PIPE *p = (struct FREEDV_PIPE*)arg;
+    struct FREEDV_PIPE_JOB *job;
+    long   n_job;
+
+    while (freedv_pipe_wait(p, freedv_pipe_fec_ready)) {
+        n_job = atomic_load(&p->job_fec);
+        job = &p->job[n_job % p->njobs];
+        if (job->rx.decode)
+            freedv_700d_rx_fec(p->f, &job->rx, job->packed);
+
+        atomic_store(&p->job_fec, n_job + 1);
+        freedv_pipe_wake(p);
+    }
+
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: freedv_pipe_voc_thread
+  DATE CREATED: October 2026
+
+  Keeps its own copy of the last decoded window and frame count, taking
+  the place of f->packed_codec_bits and f->modem_frame_count_rx, and
+  squelches or decodes each modem frame as freedv_comprx() does.
+
+\*---------------------------------------------------------------------------*/
+
+static void *freedv_pipe_voc_thread(void *arg) {
+    struct FREEDV_PIPE *p = (struct FREEDV_PIPE*)arg;
+    struct freedv *f = p->f;
+    struct FREEDV_PIPE_JOB *job;
+    long   n_job, wr;
+    int    i, nout;
+
+    while (freedv_pipe_wait(p, freedv_pipe_voc_ready)) {
+        n_job = atomic_load(&p->job_voc);
+        job = &p->job[n_job % p->njobs];
+        if (job->rx.decode) {
+            memcpy(p->packed, job->packed, f->nbyte_packed_codec_bits);
+            p->frame_count = 0;
+        }
+
+        /* 700D returns no samples without modem sync, so there is
+           nothing to echo when valid < 0 */
+
+        nout = job->rx.nout;
+        if (job->rx.valid > 0)
+            nout = freedv_700d_speech(f, p->speech, p->packed, &p->frame_count);
+        else
+            memset(p->speech, 0, sizeof(short)*nout);
+
+        wr = atomic_load(&p->out_wr);
+        for(i=0; i<nout; i++)
+            p->out[(wr + i) % p->out_size] = p->speech[i];
+        atomic_store(&p->out_wr, wr + nout);
+
+        atomic_store(&p->job_voc, n_job + 1);
+        freedv_pipe_wake(p);
+    }
+
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: freedv_pipe_create
+  DATE CREATED: October 2026
+
+  Allocates the queues and starts the three threads.  The vocoder starts
+  from f->packed_codec_bits and f->modem_frame_count_rx, so output
+  matches freedv_comprx() on the same f from the first frame.
+
+\*---------------------------------------------------------------------------*/
+
+struct FREEDV_PIPE *freedv_pipe_create(struct freedv *f, int max_frames) {
+    void *(*stage[3])(void *) = {freedv_pipe_modem_thread, freedv_pipe_fec_thread, freedv_pipe_voc_thread};
+    struct FREEDV_PIPE *p;
+    int i;
+
+    assert(f != NULL);
+    if ((f->mode != FREEDV_MODE_700D) || (max_frames < 1))
+        return NULL;
+
+    p = (struct FREEDV_PIPE*)calloc(1, sizeof(struct FREEDV_PIPE));
+    if (p == NULL)
+        return NULL;
+    p->f = f;
+    p->in_size = max_frames*f->n_max_modem_samples;
+    p->njobs = max_frames;
+    p->nsyms = f->interleave_frames*f->ldpc->coded_syms_per_frame;
+    p->out_size = max_frames*f->n_speech_samples;
+    atomic_init(&p->in_wr, 0);
+    atomic_init(&p->in_rd, 0);
+    atomic_init(&p->nin, f->nin);
+    atomic_init(&p->job_modem, 0);
+    atomic_init(&p->job_fec, 0);
+    atomic_init(&p->job_voc, 0);
+    atomic_init(&p->out_wr, 0);
+    atomic_init(&p->out_rd, 0);
+    atomic_init(&p->quit, 0);
+
+    p->in = (COMP*)malloc(sizeof(COMP)*p->in_size);
+    p->job = (struct FREEDV_PIPE_JOB*)calloc(p->njobs, sizeof(struct FREEDV_PIPE_JOB));
+    p->out = (short*)malloc(sizeof(short)*p->out_size);
+    p->packed = (unsigned char*)malloc(f->nbyte_packed_codec_bits);
+    p->speech = (short*)malloc(sizeof(short)*f->n_speech_samples);
+    p->frame = (COMP*)malloc(sizeof(COMP)*f->n_max_modem_samples);
+    if ((p->in == NULL) || (p->job == NULL) || (p->out == NULL) || (p->packed == NULL) ||
+        (p->speech == NULL) || (p->frame == NULL)) {
+        freedv_pipe_free(p);
+        return NULL;
+    }
+    for(i=0; i<p->njobs; i++) {
+        p->job[i].symbols = (COMP*)malloc(sizeof(COMP)*p->nsyms);
+        p->job[i].amps = (float*)malloc(sizeof(float)*p->nsyms);
+        p->job[i].packed = (unsigned char*)malloc(f->nbyte_packed_codec_bits);
+        if ((p->job[i].symbols == NULL) || (p->job[i].amps == NULL) || (p->job[i].packed == NULL)) {
+            freedv_pipe_free(p);
+            return NULL;
+        }
+    }
+    memcpy(p->packed, f->packed_codec_bits, f->nbyte_packed_codec_bits);
+    p->frame_count = f->modem_frame_count_rx;
+
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->cv, NULL);
+    for(i=0; i<3; i++) {
+        if (pthread_create(&p->threads[i], NULL, stage[i], p) != 0) {
+            freedv_pipe_destroy(p);
+            return NULL;
+        }
+        p->n_threads++;
+    }
+
+    return p;
+}
+
+
+static void freedv_pipe_free(struct FREEDV_PIPE *p) {
+    int i;
+
+    if (p->job != NULL) {
+        for(i=0; i<p->njobs; i++) {
+            free(p->job[i].symbols);
+            free(p->job[i].amps);
+            free(p->job[i].packed);
+        }
+    }
+    free(p->in);
+    free(p->job);
+    free(p->out);
+    free(p->packed);
+    free(p->speech);
+    free(p->frame);
+    free(p);
+}
+
+
+void freedv_pipe_destroy(struct FREEDV_PIPE *p) {
+    int i;
+
+    assert(p != NULL);
+    pthread_mutex_lock(&p->lock);
+    atomic_store(&p->quit, 1);
+    pthread_cond_broadcast(&p->cv);
+    pthread_mutex_unlock(&p->lock);
+    for(i=0; i<p->n_threads; i++)
+        pthread_join(p->threads[i], NULL);
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->cv);
+    freedv_pipe_free(p);
+}
+
+
+int freedv_pipe_write(struct FREEDV_PIPE *p, COMP demod_in[], int n) {
+    long wr = atomic_load(&p->in_wr);
+    int  i, space = p->in_size - (int)(wr - atomic_load(&p->in_rd));
+
+    if (n > space)
+        n = space;
+    for(i=0; i<n; i++)
+        p->in[(wr + i) % p->in_size] = demod_in[i];
+    atomic_store(&p->in_wr, wr + n);
+    if (n)
+        freedv_pipe_wake(p);
+    return n;
+}
+
+/* as freedv_rx(), real 700D samples are scaled by 2 */
+
+int freedv_pipe_write_short(struct FREEDV_PIPE *p, short demod_in[], int n) {
+    long wr = atomic_load(&p->in_wr);
+    int  i, space = p->in_size - (int)(wr - atomic_load(&p->in_rd));
+    COMP *c;
+
+    if (n > space)
+        n = space;
+    for(i=0; i<n; i++) {
+        c = &p->in[(wr + i) % p->in_size];
+        c->real = 2.0*(float)demod_in[i];
+        c->imag = 0.0;
+    }
+    atomic_store(&p->in_wr, wr + n);
+    if (n)
+        freedv_pipe_wake(p);
+    return n;
+}
+
+
+int freedv_pipe_read(struct FREEDV_PIPE *p, short speech_out[], int max) {
+    long rd = atomic_load(&p->out_rd);
+    int  i, n = (int)(atomic_load(&p->out_wr) - rd);
+
+    if (n > max)
+        n = max;
+    for(i=0; i<n; i++)
+        speech_out[i] = p->out[(rd + i) % p->out_size];
+    atomic_store(&p->out_rd, rd + n);
+    if (n)
+        freedv_pipe_wake(p);
+    return n;
+}
+
+
+void freedv_pipe_flush(struct FREEDV_PIPE *p) {
+    freedv_pipe_wait(p, freedv_pipe_idle);
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: freedv_pipe_latency
+  DATE CREATED: October 2026
+
+  The samples waiting in each queue, plus the interleaver window the
+  serial receiver also has to wait for.  The modem frame is taken as
+  n_nom_modem_samples long, each job in flight holds one.
+
+\*---------------------------------------------------------------------------*/
+
+float freedv_pipe_latency(struct FREEDV_PIPE *p) {
+    struct freedv *f = p->f;
+    float frame = (float)f->n_nom_modem_samples/f->modem_sample_rate;
+    long  in = atomic_load(&p->in_wr) - atomic_load(&p->in_rd);
+    long  jobs = atomic_load(&p->job_modem) - atomic_load(&p->job_voc);
+    long  out = atomic_load(&p->out_wr) - atomic_load(&p->out_rd);
+
+    return (float)in/f->modem_sample_rate + jobs*frame + (float)out/FREEDV_PIPE_SPEECH_FS +
+           f->interleave_frames*frame;
+}
+
+
+float freedv_pipe_max_latency(struct FREEDV_PIPE *p) {
+    struct freedv *f = p->f;
+    float frame = (float)f->n_nom_modem_samples/f->modem_sample_rate;
+
+    return (float)p->in_size/f->modem_sample_rate + p->njobs*frame + (float)p->out_size/FREEDV_PIPE_SPEECH_FS +
+           f->interleave_frames*frame;
+}
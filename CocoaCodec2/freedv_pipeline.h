@@ -0,0 +1,79 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: freedv_pipeline.h
+  DATE CREATED: October 2026
+
+  Pipelined FreeDV receiver.  The modem, the FEC decoder and the speech
+  decoder each run on their own thread, connected by lock free single
+  producer single consumer queues, so a receiver can use up to three
+  cores and a slow LDPC decode no longer holds up the caller's audio
+  thread.  The speech out is the same as from freedv_rx()/freedv_comprx()
+  on the same samples, only later.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License version 2.1, as
+  published by the Free Software Foundation.  This program is
+  distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __FREEDV_PIPELINE__
+#define __FREEDV_PIPELINE__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "freedv_api.h"
+
+struct FREEDV_PIPE;
+
+/*
+ * Start a pipeline on an open freedv.  Only FREEDV_MODE_700D is
+ * pipelined, NULL is returned for other modes.  max_frames modem frames
+ * can be queued in each of the input, FEC and speech queues, which
+ * bounds the latency, see freedv_pipe_max_latency().
+ *
+ * While the pipeline runs it owns f: don't call freedv_rx() and
+ * friends or change settings, though the stats getters may be called.
+ * The txt callback is called from the modem thread.
+ */
+struct FREEDV_PIPE *freedv_pipe_create(struct freedv *f, int max_frames);
+
+/* Stops the threads, samples still queued are dropped, f is left open */
+void freedv_pipe_destroy(struct FREEDV_PIPE *p);
+
+/*
+ * Queue n modem samples at the modem sample rate, never blocks.
+ * Returns the number of samples taken, less than n if the input queue
+ * is full.
+ */
+int freedv_pipe_write(struct FREEDV_PIPE *p, COMP demod_in[], int n);
+int freedv_pipe_write_short(struct FREEDV_PIPE *p, short demod_in[], int n);
+
+/* Read up to max decoded 8 kHz speech samples, never blocks */
+int freedv_pipe_read(struct FREEDV_PIPE *p, short speech_out[], int max);
+
+/*
+ * Wait until every whole modem frame written so far has been through
+ * all three stages, or the speech queue is too full to go on.
+ */
+void freedv_pipe_flush(struct FREEDV_PIPE *p);
+
+/* Seconds between a sample going in and its speech being readable */
+float freedv_pipe_latency(struct FREEDV_PIPE *p);
+float freedv_pipe_max_latency(struct FREEDV_PIPE *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,470 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: freedv_pool.c
+  DATE CREATED: October 2026
+
+  Multi-channel FreeDV receiver on a work stealing thread pool.
+
+  A channel is queued on a worker deque when a whole modem frame
+  (freedv_nin() samples) is waiting, and is never queued twice, so only
+  one worker runs it at a time and its frames are decoded in order.  A
+  worker runs up to FREEDV_POOL_QUANTUM frames of a channel, then queues
+  it again on its own deque if there is more to do, so a busy channel
+  can't starve the rest.  Workers take from the back of their own
+  deque and steal from the front of the others.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License version 2.1, as
+  published by the Free Software Foundation.  This program is
+  distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "freedv_pool.h"
+
+#define FREEDV_POOL_QUANTUM 4   /* modem frames run before a channel is requeued */
+
+struct FREEDV_POOL_CHAN {
+    struct FREEDV_POOL *pool;
+    int             chan;
+    struct freedv  *f;              /* NULL if the slot is free            */
+    void           *state;
+
+    /* modem samples, written by the caller, read by the running worker */
+
+    short          *in;
+    int             in_size;
+    atomic_long     in_wr, in_rd;
+    atomic_int      nin;            /* freedv_nin() for the next frame     */
+
+    atomic_int      queued;         /* on a deque or being run             */
+    atomic_int      closing;
+
+    atomic_long     cpu_ns;
+    atomic_long     frames;
+    atomic_long     samples_in;
+    atomic_long     samples_refused;
+};
+
+struct FREEDV_POOL_DEQUE {
+    pthread_mutex_t lock;
+    int            *item;           /* channel numbers                     */
+    int             head, count;
+};
+
+struct FREEDV_POOL_WORKER {
+    struct FREEDV_POOL *pool;
+    int             index;
+};
+
+struct FREEDV_POOL {
+    int             n_threads;
+    int             max_channels;
+    freedv_pool_speech_cb speech_cb;
+    freedv_pool_txt_cb txt_cb;
+
+    struct FREEDV_POOL_CHAN   *chan;
+    struct FREEDV_POOL_DEQUE  *deque;
+    struct FREEDV_POOL_WORKER *worker;
+    pthread_t      *threads;
+    int             n_started;
+
+    pthread_mutex_t lock;
+    pthread_cond_t  work_cv;        /* Signalled when a channel is queued  */
+    pthread_cond_t  done_cv;        /* Signalled when a channel has been run */
+    atomic_int      pending;        /* channels on the deques              */
+    atomic_int      running;        /* channels being run                  */
+    atomic_int      next_deque;     /* where the callers queue channels    */
+    atomic_int      quit;
+};
+
+/*---------------------------------------------------------------------------*\
+
+                               FUNCTIONS
+
+\*---------------------------------------------------------------------------*/
+
+static void freedv_pool_free(struct FREEDV_POOL *pool);
+
+static void freedv_pool_rx_char(void *callback_state, char c) {
+    struct FREEDV_POOL_CHAN *ch = (struct FREEDV_POOL_CHAN*)callback_state;
+    ch->pool->txt_cb(ch->state, ch->chan, c);
+}
+
+static long freedv_pool_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+    return (long)t.tv_sec*1000000000L + t.tv_nsec;
+}
+
+static int freedv_pool_avail(struct FREEDV_POOL_CHAN *ch) {
+    return (int)(atomic_load(&ch->in_wr) - atomic_load(&ch->in_rd));
+}
+
+static void freedv_pool_enqueue(struct FREEDV_POOL *pool, int chan, int d) {
+    struct FREEDV_POOL_DEQUE *dq = &pool->deque[d];
+
+    pthread_mutex_lock(&dq->lock);
+    assert(dq->count < pool->max_channels);
+    dq->item[(dq->head + dq->count) % pool->max_channels] = chan;
+    dq->count++;
+    atomic_fetch_add(&pool->pending, 1);
+    pthread_mutex_unlock(&dq->lock);
+
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->work_cv);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/* queue the channel on deque d if it has a whole frame and isn't already queued */
+
+static void freedv_pool_schedule(struct FREEDV_POOL *pool, struct FREEDV_POOL_CHAN *ch, int d) {
+    int idle = 0;
+
+    if (atomic_load(&ch->closing) || (freedv_pool_avail(ch) < atomic_load(&ch->nin)))
+        return;
+    if (!atomic_compare_exchange_strong(&ch->queued, &idle, 1))
+        return;
+
+    /* freedv_pool_remove() sets closing then waits for queued == 0, so
+       look again now queued is set, one of us is bound to see the other */
+
+    if (atomic_load(&ch->closing)) {
+        pthread_mutex_lock(&pool->lock);
+        atomic_store(&ch->queued, 0);
+        pthread_cond_broadcast(&pool->done_cv);
+        pthread_mutex_unlock(&pool->lock);
+        return;
+    }
+    freedv_pool_enqueue(pool, ch->chan, d);
+}
+
+/* take a channel from the back of our own deque, or the front of another */
+
+static int freedv_pool_take(struct FREEDV_POOL *pool, int self) {
+    struct FREEDV_POOL_DEQUE *dq;
+    int i, d, chan = -1;
+
+    for(i=0; (i<pool->n_threads) && (chan < 0); i++) {
+        d = (self + i) % pool->n_threads;
+        dq = &pool->deque[d];
+        pthread_mutex_lock(&dq->lock);
+        if (dq->count) {
+            if (d == self) {
+                chan = dq->item[(dq->head + dq->count - 1) % pool->max_channels];
+            } else {
+                chan = dq->item[dq->head];
+                dq->head = (dq->head + 1) % pool->max_channels;
+            }
+            dq->count--;
+            atomic_fetch_add(&pool->running, 1);
+            atomic_fetch_sub(&pool->pending, 1);
+        }
+        pthread_mutex_unlock(&dq->lock);
+    }
+
+    return chan;
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: freedv_pool_run
+  DATE CREATED: October 2026
+
+  One unit of work: up to FREEDV_POOL_QUANTUM freedv_rx() calls on a
+  channel.  The channel is released before checking for more samples,
+  so a frame pushed meanwhile is either seen here or queues the channel
+  from freedv_pool_push().
+
+\*---------------------------------------------------------------------------*/
+
+static void freedv_pool_run(struct FREEDV_POOL *pool, struct FREEDV_POOL_CHAN *ch, int self) {
+    struct freedv *f = ch->f;
+    int   n_max = freedv_get_n_max_modem_samples(f);
+    int   n_speech = freedv_get_n_speech_samples(f);
+    short demod_in[n_max];
+    short speech_out[(n_speech > n_max) ? n_speech : n_max];
+    long  rd, t0 = freedv_pool_ns();
+    int   i, k, nin, nout;
+
+    for(k=0; (k<FREEDV_POOL_QUANTUM) && !atomic_load(&ch->closing); k++) {
+        nin = atomic_load(&ch->nin);
+        if (freedv_pool_avail(ch) < nin)
+            break;
+        rd = atomic_load(&ch->in_rd);
+        for(i=0; i<nin; i++)
+            demod_in[i] = ch->in[(rd + i) % ch->in_size];
+        atomic_store(&ch->in_rd, rd + nin);
+
+        nout = freedv_rx(f, speech_out, demod_in);
+        atomic_store(&ch->nin, freedv_nin(f));
+        atomic_fetch_add(&ch->frames, 1);
+        if (pool->speech_cb != NULL)
+            pool->speech_cb(ch->state, ch->chan, speech_out, nout);
+    }
+    atomic_fetch_add(&ch->cpu_ns, freedv_pool_ns() - t0);
+
+    atomic_store(&ch->queued, 0);
+    freedv_pool_schedule(pool, ch, self);
+}
+
+
+static void *freedv_pool_thread(void *arg) {
+    struct FREEDV_POOL_WORKER *w = (struct FREEDV_POOL_WORKER*)arg;
+    struct FREEDV_POOL *pool = w->pool;
+    int chan;
+
+    while (!atomic_load(&pool->quit)) {
+        chan = freedv_pool_take(pool, w->index);
+        if (chan < 0) {
+            pthread_mutex_lock(&pool->lock);
+            while (!atomic_load(&pool->quit) && (atomic_load(&pool->pending) == 0))
+                pthread_cond_wait(&pool->work_cv, &pool->lock);
+            pthread_mutex_unlock(&pool->lock);
+            continue;
+        }
+
+        freedv_pool_run(pool, &pool->chan[chan], w->index);
+
+        pthread_mutex_lock(&pool->lock);
+        atomic_fetch_sub(&pool->running, 1);
+        pthread_cond_broadcast(&pool->done_cv);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return NULL;
+}
+
+
+struct FREEDV_POOL *freedv_pool_create(int n_threads, int max_channels,
+                                       freedv_pool_speech_cb speech_cb, freedv_pool_txt_cb txt_cb)
+{
+    struct FREEDV_POOL *pool;
+    int i;
+
+    if ((n_threads < 1) || (max_channels < 1))
+        return NULL;
+
+    pool = (struct FREEDV_POOL*)calloc(1, sizeof(struct FREEDV_POOL));
+    if (pool == NULL)
+        return NULL;
+    pool->n_threads = n_threads;
+    pool->max_channels = max_channels;
+    pool->speech_cb = speech_cb;
+    pool->txt_cb = txt_cb;
+    atomic_init(&pool->pending, 0);
+    atomic_init(&pool->running, 0);
+    atomic_init(&pool->next_deque, 0);
+    atomic_init(&pool->quit, 0);
+
+    pool->chan = (struct FREEDV_POOL_CHAN*)calloc(max_channels, sizeof(struct FREEDV_POOL_CHAN));
+    pool->deque = (struct FREEDV_POOL_DEQUE*)calloc(n_threads, sizeof(struct FREEDV_POOL_DEQUE));
+    pool->worker = (struct FREEDV_POOL_WORKER*)calloc(n_threads, sizeof(struct FREEDV_POOL_WORKER));
+    pool->threads = (pthread_t*)calloc(n_threads, sizeof(pthread_t));
+    if ((pool->chan == NULL) || (pool->deque == NULL) || (pool->worker == NULL) || (pool->threads == NULL)) {
+        freedv_pool_free(pool);
+        return NULL;
+    }
+    for(i=0; i<max_channels; i++) {
+        pool->chan[i].pool = pool;
+        pool->chan[i].chan = i;
+    }
+    for(i=0; i<n_threads; i++) {
+        pool->deque[i].item = (int*)malloc(sizeof(int)*max_channels);
+        if (pool->deque[i].item == NULL) {
+            freedv_pool_free(pool);
+            return NULL;
+        }
+        pthread_mutex_init(&pool->deque[i].lock, NULL);
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cv, NULL);
+    pthread_cond_init(&pool->done_cv, NULL);
+    for(i=0; i<n_threads; i++) {
+        pool->worker[i].pool = pool;
+        pool->worker[i].index = i;
+        if (pthread_create(&pool->threads[i], NULL, freedv_pool_thread, &pool->worker[i]) != 0) {
+            freedv_pool_destroy(pool);
+            return NULL;
+        }
+        pool->n_started++;
+    }
+
+    return pool;
+}
+
+
+static void freedv_pool_free(struct FREEDV_POOL *pool) {
+    int i;
+
+    if (pool->chan != NULL) {
+        for(i=0; i<pool->max_channels; i++)
+            free(pool->chan[i].in);
+    }
+    if (pool->deque != NULL) {
+        for(i=0; i<pool->n_threads; i++)
+            free(pool->deque[i].item);
+    }
+    free(pool->chan);
+    free(pool->deque);
+    free(pool->worker);
+    free(pool->threads);
+    free(pool);
+}
+
+
+void freedv_pool_destroy(struct FREEDV_POOL *pool) {
+    int i;
+
+    assert(pool != NULL);
+    pthread_mutex_lock(&pool->lock);
+    atomic_store(&pool->quit, 1);
+    pthread_cond_broadcast(&pool->work_cv);
+    pthread_mutex_unlock(&pool->lock);
+    for(i=0; i<pool->n_started; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    for(i=0; i<pool->n_threads; i++)
+        pthread_mutex_destroy(&pool->deque[i].lock);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_cv);
+    pthread_cond_destroy(&pool->done_cv);
+    freedv_pool_free(pool);
+}
+
+
+int freedv_pool_add(struct FREEDV_POOL *pool, struct freedv *f, int max_samples, void *state) {
+    struct FREEDV_POOL_CHAN *ch = NULL;
+    int i;
+
+    assert((pool != NULL) && (f != NULL));
+    if (max_samples < freedv_get_n_max_modem_samples(f))
+        max_samples = freedv_get_n_max_modem_samples(f);
+
+    pthread_mutex_lock(&pool->lock);
+    for(i=0; (i<pool->max_channels) && (ch == NULL); i++) {
+        if ((pool->chan[i].f == NULL) && (pool->chan[i].in == NULL))
+            ch = &pool->chan[i];
+    }
+    if (ch != NULL) {
+        ch->in = (short*)malloc(sizeof(short)*max_samples);
+        if (ch->in == NULL)
+            ch = NULL;
+    }
+    pthread_mutex_unlock(&pool->lock);
+    if (ch == NULL)
+        return -1;
+
+    ch->state = state;
+    ch->in_size = max_samples;
+    atomic_store(&ch->in_wr, 0);
+    atomic_store(&ch->in_rd, 0);
+    atomic_store(&ch->nin, freedv_nin(f));
+    atomic_store(&ch->queued, 0);
+    atomic_store(&ch->closing, 0);
+    atomic_store(&ch->cpu_ns, 0);
+    atomic_store(&ch->frames, 0);
+    atomic_store(&ch->samples_in, 0);
+    atomic_store(&ch->samples_refused, 0);
+    if (pool->txt_cb != NULL)
+        freedv_set_callback_txt(f, freedv_pool_rx_char, NULL, ch);
+    ch->f = f;
+
+    return ch->chan;
+}
+
+
+struct freedv *freedv_pool_remove(struct FREEDV_POOL *pool, int chan) {
+    struct FREEDV_POOL_CHAN *ch;
+    struct freedv *f;
+
+    assert((chan >= 0) && (chan < pool->max_channels));
+    ch = &pool->chan[chan];
+    assert(ch->f != NULL);
+
+    pthread_mutex_lock(&pool->lock);
+    atomic_store(&ch->closing, 1);
+    while (atomic_load(&ch->queued))
+        pthread_cond_wait(&pool->done_cv, &pool->lock);
+    f = ch->f;
+    ch->f = NULL;
+    free(ch->in);
+    ch->in = NULL;
+    pthread_mutex_unlock(&pool->lock);
+
+    if (pool->txt_cb != NULL)
+        freedv_set_callback_txt(f, NULL, NULL, NULL);
+    return f;
+}
+
+
+int freedv_pool_push(struct FREEDV_POOL *pool, int chan, short demod_in[], int n) {
+    struct FREEDV_POOL_CHAN *ch;
+    long wr;
+    int  i, space;
+
+    assert((chan >= 0) && (chan < pool->max_channels));
+    ch = &pool->chan[chan];
+    if (atomic_load(&ch->closing))
+        return 0;
+
+    wr = atomic_load(&ch->in_wr);
+    space = ch->in_size - (int)(wr - atomic_load(&ch->in_rd));
+    if (n > space) {
+        atomic_fetch_add(&ch->samples_refused, n - space);
+        n = space;
+    }
+    for(i=0; i<n; i++)
+        ch->in[(wr + i) % ch->in_size] = demod_in[i];
+    atomic_store(&ch->in_wr, wr + n);
+    atomic_fetch_add(&ch->samples_in, n);
+
+    freedv_pool_schedule(pool, ch, atomic_fetch_add(&pool->next_deque, 1) % pool->n_threads);
+    return n;
+}
+
+
+int freedv_pool_space(struct FREEDV_POOL *pool, int chan) {
+    struct FREEDV_POOL_CHAN *ch;
+
+    assert((chan >= 0) && (chan < pool->max_channels));
+    ch = &pool->chan[chan];
+    return ch->in_size - freedv_pool_avail(ch);
+}
+
+
+void freedv_pool_get_stats(struct FREEDV_POOL *pool, int chan, struct FREEDV_POOL_STATS *stats) {
+    struct FREEDV_POOL_CHAN *ch;
+
+    assert((chan >= 0) && (chan < pool->max_channels));
+    ch = &pool->chan[chan];
+    stats->cpu_seconds = atomic_load(&ch->cpu_ns)*1E-9;
+    stats->frames = atomic_load(&ch->frames);
+    stats->samples_in = atomic_load(&ch->samples_in);
+    stats->samples_refused = atomic_load(&ch->samples_refused);
+    stats->queued = freedv_pool_avail(ch);
+}
+
+
+void freedv_pool_flush(struct FREEDV_POOL *pool) {
+    pthread_mutex_lock(&pool->lock);
+    while (atomic_load(&pool->pending) || atomic_load(&pool->running))
+        pthread_cond_wait(&pool->done_cv, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,100 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: freedv_pool.h
+  DATE CREATED: October 2026
+
+  Receive many FreeDV channels on a pool of threads.  Each channel is a
+  struct freedv from freedv_open(), fed sample blocks by the caller.  A
+  channel with a whole modem frame waiting is queued on a worker, idle
+  workers steal queued channels from busy ones, and decoded speech and
+  txt come back through callbacks.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License version 2.1, as
+  published by the Free Software Foundation.  This program is
+  distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __FREEDV_POOL__
+#define __FREEDV_POOL__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "freedv_api.h"
+
+struct FREEDV_POOL;
+
+/*
+ * Called from a worker thread with the speech from one freedv_rx() call
+ * on channel chan, or one received txt character.  Calls for a channel
+ * come in the order its samples were pushed and never overlap, though
+ * successive calls may come from different workers.
+ */
+typedef void (*freedv_pool_speech_cb)(void *state, int chan, short speech_out[], int nout);
+typedef void (*freedv_pool_txt_cb)(void *state, int chan, char c);
+
+struct FREEDV_POOL_STATS {
+    double cpu_seconds;     /* worker CPU time spent on the channel    */
+    long   frames;          /* freedv_rx() calls made                  */
+    long   samples_in;      /* samples accepted by freedv_pool_push()  */
+    long   samples_refused; /* samples turned away as the queue was full */
+    int    queued;          /* samples waiting now                     */
+};
+
+/*
+ * Start n_threads workers for up to max_channels channels.  Either
+ * callback may be NULL.  Returns NULL on failure.
+ */
+struct FREEDV_POOL *freedv_pool_create(int n_threads, int max_channels,
+                                       freedv_pool_speech_cb speech_cb, freedv_pool_txt_cb txt_cb);
+
+/* Stops the workers, channels still in the pool are left open */
+void freedv_pool_destroy(struct FREEDV_POOL *pool);
+
+/*
+ * Hand an open freedv to the pool, with room to queue max_samples
+ * modem samples.  state is passed back to the callbacks.  The pool sets
+ * the freedv txt callback, and owns f until freedv_pool_remove(), so f
+ * must not be used directly meanwhile, apart from the stats getters.
+ * Returns the channel number, or -1 if the pool is full.
+ */
+int freedv_pool_add(struct FREEDV_POOL *pool, struct freedv *f, int max_samples, void *state);
+
+/*
+ * Wait for any work on the channel to finish and take it out of the
+ * pool, dropping samples still queued.  Returns the freedv, for the
+ * caller to close.
+ */
+struct freedv *freedv_pool_remove(struct FREEDV_POOL *pool, int chan);
+
+/*
+ * Queue n modem samples on a channel, never blocks.  Returns the number
+ * taken, which is less than n when the channel has fallen behind.  Only
+ * one thread at a time should push to a channel.
+ */
+int freedv_pool_push(struct FREEDV_POOL *pool, int chan, short demod_in[], int n);
+
+/* Samples that can be pushed to the channel now */
+int freedv_pool_space(struct FREEDV_POOL *pool, int chan);
+
+void freedv_pool_get_stats(struct FREEDV_POOL *pool, int chan, struct FREEDV_POOL_STATS *stats);
+
+/* Wait until no channel has a whole modem frame queued */
+void freedv_pool_flush(struct FREEDV_POOL *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
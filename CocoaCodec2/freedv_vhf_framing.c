@@ -50,33 +50,33 @@ static const uint8_t A_uw_v[] =    {0,1,1,0,0,1,1,1,
 static const uint8_t A_uw_d[] =    {1,1,1,1,0,0,0,1,
                                     1,1,1,1,1,1,0,0};
 
-/* Blank VHF type A frame */
-static const uint8_t A_blank[] =   {1,0,1,0,0,1,1,1, /* Padding[0:3] Proto[0:3]   */
-                                    1,0,1,0,0,1,1,1, /* Proto[4:11]               */
-                                    0,0,0,0,0,0,0,0, /* Voice[0:7]                */
-                                    0,0,0,0,0,0,0,0, /* Voice[8:15]               */
-                                    0,0,0,0,0,0,0,0, /* Voice[16:23]              */
-                                    0,1,1,0,0,1,1,1, /* UW[0:7]                   */
-                                    1,0,1,0,1,1,0,1, /* UW[8:15]                  */
-                                    0,0,0,0,0,0,0,0, /* Voice[24:31]              */
-                                    0,0,0,0,0,0,0,0, /* Voice[32:39]              */
-                                    0,0,0,0,0,0,0,0, /* Voice[40:47]              */
-                                    0,0,0,0,0,0,1,0, /* Voice[48:51] Proto[12:15] */
-                                    0,1,1,1,0,0,1,0};/* Proto[16:19] Padding[4:7] */
+/* Blank VHF type A frame, packed MSB first */
+static const uint8_t A_blank[] =   {0xa7,            /* Padding[0:3] Proto[0:3]   */
+                                    0xa7,            /* Proto[4:11]               */
+                                    0x00,            /* Voice[0:7]                */
+                                    0x00,            /* Voice[8:15]               */
+                                    0x00,            /* Voice[16:23]              */
+                                    0x67,            /* UW[0:7]                   */
+                                    0xad,            /* UW[8:15]                  */
+                                    0x00,            /* Voice[24:31]              */
+                                    0x00,            /* Voice[32:39]              */
+                                    0x00,            /* Voice[40:47]              */
+                                    0x02,            /* Voice[48:51] Proto[12:15] */
+                                    0x72};           /* Proto[16:19] Padding[4:7] */
                     
-/* Blank VHF type AT (A for TDMA; padding bits not transmitted) frame */
-static const uint8_t AT_blank[] =  {        0,1,1,1, /*              Proto[0:3]   */
-                                    1,0,1,0,0,1,1,1, /* Proto[4:11]               */
-                                    0,0,0,0,0,0,0,0, /* Voice[0:7]                */
-                                    0,0,0,0,0,0,0,0, /* Voice[8:15]               */
-                                    0,0,0,0,0,0,0,0, /* Voice[16:23]              */
-                                    0,1,1,0,0,1,1,1, /* UW[0:7]                   */
-                                    1,0,1,0,1,1,0,1, /* UW[8:15]                  */
-                                    0,0,0,0,0,0,0,0, /* Voice[24:31]              */
-                                    0,0,0,0,0,0,0,0, /* Voice[32:39]              */
-                                    0,0,0,0,0,0,0,0, /* Voice[40:47]              */
-                                    0,0,0,0,0,0,1,0, /* Voice[48:51] Proto[12:15] */
-                                    0,1,1,1        };/* Proto[16:19]              */
+/* Blank VHF type AT (A for TDMA; padding bits not transmitted) frame, packed
+   MSB first, so each byte straddles two of the fields of a type A frame */
+static const uint8_t AT_blank[] =  {0x7a,            /* Proto[0:7]                */
+                                    0x70,            /* Proto[8:11] Voice[0:3]    */
+                                    0x00,            /* Voice[4:11]               */
+                                    0x00,            /* Voice[12:19]              */
+                                    0x06,            /* Voice[20:23] UW[0:3]      */
+                                    0x7a,            /* UW[4:11]                  */
+                                    0xd0,            /* UW[12:15] Voice[24:27]    */
+                                    0x00,            /* Voice[28:35]              */
+                                    0x00,            /* Voice[36:43]              */
+                                    0x00,            /* Voice[44:51]              */
+                                    0x27};           /* Proto[12:19]              */
 
 /* HF Type B voice UW */
 static const uint8_t B_uw_v[] =    {0,1,1,0,0,1,1,1};
@@ -84,15 +84,15 @@ static const uint8_t B_uw_v[] =    {0,1,1,0,0,1,1,1};
 /* HF Type B data UW */
 static const uint8_t B_uw_d[] =    {1,1,1,1,0,0,1,0};
                                     
-/* Blank HF type B frame */
-static const uint8_t B_blank[] =   {0,1,1,0,0,1,1,1, /* UW[0:7]					  */
-									0,0,0,0,0,0,0,0, /* Voice1[0:7]				  */
-									0,0,0,0,0,0,0,0, /* Voice1[8:15]			  */
-									0,0,0,0,0,0,0,0, /* Voice1[16:23]			  */
-									0,0,0,0,0,0,0,0, /* Voice1[24:28] Voice2[0:3] */
-									0,0,0,0,0,0,0,0, /* Voice2[4:11]			  */
-									0,0,0,0,0,0,0,0, /* Voice2[12:19]			  */
-									0,0,0,0,0,0,0,0};/* Voice2[20:28]			  */
+/* Blank HF type B frame, packed MSB first */
+static const uint8_t B_blank[] =   {0x67,            /* UW[0:7]                   */
+                                    0x00,            /* Voice1[0:7]               */
+                                    0x00,            /* Voice1[8:15]              */
+                                    0x00,            /* Voice1[16:23]             */
+                                    0x00,            /* Voice1[24:28] Voice2[0:3] */
+                                    0x00,            /* Voice2[4:11]              */
+                                    0x00,            /* Voice2[12:19]             */
+                                    0x00};           /* Voice2[20:28]             */
 
 /* States */
 #define ST_NOSYNC 0 /* Not synchronized */
@@ -106,114 +106,128 @@ enum frame_payload_type {
     FRAME_PAYLOAD_TYPE_DATA,
 };
 
-/* Place codec and other bits into a frame */
-void fvhff_frame_bits(  int frame_type,
-                        uint8_t bits_out[],
+/*
+ * Frames are handled packed MSB first, 8 bits to a byte, and fields are
+ * moved up to a byte at a time.  A field of n <= 56 bits is carried in
+ * the low n bits of a uint64_t, first bit most significant.
+ */
+
+/* Read n bits starting at bit pos of MSB first packed bytes */
+static uint64_t fvhff_get_bits(const uint8_t bytes[], int pos, int n){
+    uint64_t v = 0;
+    int take,shift;
+    while(n > 0){
+        shift = 8 - (pos&0x7);
+        take = n < shift ? n : shift;
+        shift -= take;
+        v = (v<<take) | ((bytes[pos>>3]>>shift) & ((1<<take)-1));
+        pos += take;
+        n -= take;
+    }
+    return v;
+}
+
+/* Overwrite n bits starting at bit pos of MSB first packed bytes */
+static void fvhff_put_bits(uint8_t bytes[], int pos, uint64_t v, int n){
+    int take,shift;
+    uint8_t mask;
+    while(n > 0){
+        shift = 8 - (pos&0x7);
+        take = n < shift ? n : shift;
+        shift -= take;
+        mask = ((1<<take)-1) << shift;
+        bytes[pos>>3] = (bytes[pos>>3] & ~mask) | (((v>>(n-take)) << shift) & mask);
+        pos += take;
+        n -= take;
+    }
+}
+
+/* Copy n bits from bit src_pos of src to bit dst_pos of dst */
+static void fvhff_copy_bits(uint8_t dst[], int dst_pos, const uint8_t src[], int src_pos, int n){
+    fvhff_put_bits(dst, dst_pos, fvhff_get_bits(src, src_pos, n), n);
+}
+
+/* Unpack nbits MSB first packed bits, one bit per uint8_t */
+static void fvhff_unpack(uint8_t bits_out[], const uint8_t packed_in[], int nbits){
+    int i;
+    for(i=0; i<nbits; i++)
+        bits_out[i] = UNPACK_BIT_MSBFIRST(packed_in,i);
+}
+
+/* Place codec and other bits into a packed frame */
+void fvhff_frame_bits_packed(int frame_type,
+                        uint8_t frame_out[],
                         uint8_t codec2_in[],
                         uint8_t proto_in[],
                         uint8_t vc_in[]){
-    int i,ibit;
     if(frame_type == FREEDV_VHF_FRAME_A){
         /* Fill out frame with blank frame prototype */
-        for(i=0; i<96; i++)
-            bits_out[i] = A_blank[i];
+        memcpy(frame_out, A_blank, sizeof(A_blank));
         
         /* Fill in protocol bits, if present */
         if(proto_in!=NULL){
-            ibit = 0;
-            /* First half of protocol bits */
-            /* Extract and place in frame, MSB first */
-            for(i=4 ; i<16; i++){
-                bits_out[i] = UNPACK_BIT_MSBFIRST(proto_in,ibit);
-                ibit++;
-            }
-            /* Last set of protocol bits */
-            for(i=84; i<92; i++){
-                bits_out[i] = UNPACK_BIT_MSBFIRST(proto_in,ibit);
-                ibit++;
-            }
+            fvhff_copy_bits(frame_out, 4, proto_in, 0, 12);
+            fvhff_copy_bits(frame_out, 84, proto_in, 12, 8);
         }
         
         /* Fill in varicode bits, if present */
-        if(vc_in!=NULL){
-            bits_out[90] = vc_in[0];
-            bits_out[91] = vc_in[1];
-        }
+        if(vc_in!=NULL)
+            fvhff_put_bits(frame_out, 90, ((vc_in[0]&0x1)<<1) | (vc_in[1]&0x1), 2);
         
         /* Fill in codec2 bits, present or not */
-        ibit = 0;
-        for(i=16; i<40; i++){   /* First half */
-            bits_out[i] = UNPACK_BIT_MSBFIRST(codec2_in,ibit);
-            ibit++;
-        }
-        for(i=56; i<84; i++){   /* Second half */
-            bits_out[i] = UNPACK_BIT_MSBFIRST(codec2_in,ibit);
-            ibit++;
-        }
+        fvhff_copy_bits(frame_out, 16, codec2_in, 0, 24);
+        fvhff_copy_bits(frame_out, 56, codec2_in, 24, 28);
     }else if(frame_type == FREEDV_HF_FRAME_B){
-        /* Pointers to both c2 frames so the bit unpack macro works */
-        uint8_t * codec2_in1 = &codec2_in[0];
-        uint8_t * codec2_in2 = &codec2_in[4];
         /* Fill out frame with blank prototype */
-        for(i=0; i<64; i++)
-            bits_out[i] = B_blank[i];
+        memcpy(frame_out, B_blank, sizeof(B_blank));
         
-        /* Fill out first codec2 block */
-        ibit=0;
-        for(i=8; i<36; i++){
-            bits_out[i] = UNPACK_BIT_MSBFIRST(codec2_in1,ibit);
-            ibit++;
-        }
-        /* Fill out second codec2 block */
-        ibit=0;
-        for(i=36; i<64; i++){
-            bits_out[i] = UNPACK_BIT_MSBFIRST(codec2_in2,ibit);
-            ibit++;
-        }
+        /* Fill out both codec2 blocks, the second starts at codec2_in[4] */
+        fvhff_copy_bits(frame_out, 8, codec2_in, 0, 28);
+        fvhff_copy_bits(frame_out, 36, codec2_in, 32, 28);
     }else if(frame_type == FREEDV_VHF_FRAME_AT){
         /* Fill out frame with blank frame prototype */
-        for(i=0; i<88; i++)
-            bits_out[i] = AT_blank[i];
+        memcpy(frame_out, AT_blank, sizeof(AT_blank));
         
         /* Fill in protocol bits, if present */
         if(proto_in!=NULL){
-            ibit = 0;
-            /* First half of protocol bits */
-            /* Extract and place in frame, MSB first */
-            for(i=0 ; i<12; i++){
-                bits_out[i] = UNPACK_BIT_MSBFIRST(proto_in,ibit);
-                ibit++;
-            }
-            /* Last set of protocol bits */
-            for(i=80; i<88; i++){
-                bits_out[i] = UNPACK_BIT_MSBFIRST(proto_in,ibit);
-                ibit++;
-            }
+            fvhff_copy_bits(frame_out, 0, proto_in, 0, 12);
+            fvhff_copy_bits(frame_out, 80, proto_in, 12, 8);
         }
         
         /* Fill in varicode bits, if present */
-        if(vc_in!=NULL){
-            bits_out[86] = vc_in[0];
-            bits_out[87] = vc_in[1];
-        }
+        if(vc_in!=NULL)
+            fvhff_put_bits(frame_out, 86, ((vc_in[0]&0x1)<<1) | (vc_in[1]&0x1), 2);
         
         /* Fill in codec2 bits, present or not */
-        ibit = 0;
-        for(i=12; i<36; i++){   /* First half */
-            bits_out[i] = UNPACK_BIT_MSBFIRST(codec2_in,ibit);
-            ibit++;
-        }
-        for(i=52; i<80; i++){   /* Second half */
-            bits_out[i] = UNPACK_BIT_MSBFIRST(codec2_in,ibit);
-            ibit++;
-        }
+        fvhff_copy_bits(frame_out, 12, codec2_in, 0, 24);
+        fvhff_copy_bits(frame_out, 52, codec2_in, 24, 28);
     }
 }
 
-/* Place data and other bits into a frame */
-void fvhff_frame_data_bits(struct freedv_vhf_deframer * def, int frame_type,
-                        uint8_t bits_out[]){
-    int i,ibit;
+/* Place codec and other bits into a frame, one bit per uint8_t */
+void fvhff_frame_bits(  int frame_type,
+                        uint8_t bits_out[],
+                        uint8_t codec2_in[],
+                        uint8_t proto_in[],
+                        uint8_t vc_in[]){
+    uint8_t frame[FVHFF_MAX_FRAME_BITS/8];
+    int nbits;
+
+    if(frame_type == FREEDV_VHF_FRAME_A)
+        nbits = 96;
+    else if(frame_type == FREEDV_HF_FRAME_B)
+        nbits = 64;
+    else if(frame_type == FREEDV_VHF_FRAME_AT)
+        nbits = 88;
+    else
+        return;
+    fvhff_frame_bits_packed(frame_type, frame, codec2_in, proto_in, vc_in);
+    fvhff_unpack(bits_out, frame, nbits);
+}
+
+/* Place data and other bits into a packed frame */
+void fvhff_frame_data_bits_packed(struct freedv_vhf_deframer * def, int frame_type,
+                        uint8_t frame_out[]){
     if(frame_type == FREEDV_VHF_FRAME_A){
         uint8_t data[8];
         int end_bits;
@@ -221,39 +235,23 @@ void fvhff_frame_data_bits(struct freedv_vhf_deframer * def, int frame_type,
         int bcast_bit;
         int crc_bit;
 
-        /* Fill out frame with blank frame prototype */
-        for(i=0; i<4; i++)
-            bits_out[i] = A_blank[i];
-        for(i=92; i<96; i++)
-            bits_out[i] = A_blank[i];
-            
-        /* UW data */
-        for (i=0; i < 16; i++)
-            bits_out[40 + i] = A_uw_d[i];
+        /* Fill out frame with blank frame prototype and the data UW */
+        memcpy(frame_out, A_blank, sizeof(A_blank));
+        fvhff_put_bits(frame_out, 40, def->uw_packed[1].uw[0], 16);
         
         if (def->fdc)
                 freedv_data_channel_tx_frame(def->fdc, data, 8, &from_bit, &bcast_bit, &crc_bit, &end_bits);
         else
             return;
 
-        bits_out[4] = from_bit;
-        bits_out[5] = bcast_bit;
-        bits_out[6] = 0; /* unused */
-        bits_out[7] = 0; /* unused */
+        /* from, bcast and two unused bits */
+        fvhff_put_bits(frame_out, 4, (from_bit<<3) | (bcast_bit<<2), 4);
 
         /* Fill in data bits */
-        ibit = 0;
-        for(i=8; i<40; i++){   /* First half */
-            bits_out[i] = UNPACK_BIT_MSBFIRST(data,ibit);
-            ibit++;
-        }
-        for(i=56; i<88; i++){  /* Second half */
-            bits_out[i] = UNPACK_BIT_MSBFIRST(data,ibit);
-            ibit++;
-        }
+        fvhff_copy_bits(frame_out, 8, data, 0, 32);
+        fvhff_copy_bits(frame_out, 56, data, 32, 32);
 
-        for (i = 0; i < 4; i++)
-            bits_out[88 + i] = (end_bits >> (3-i)) & 0x1;
+        fvhff_put_bits(frame_out, 88, end_bits, 4);
     } else if (frame_type == FREEDV_HF_FRAME_B){
         uint8_t data[6];
         int end_bits;
@@ -261,39 +259,40 @@ void fvhff_frame_data_bits(struct freedv_vhf_deframer * def, int frame_type,
         int bcast_bit;
         int crc_bit;
 
-        /* Fill out frame with blank prototype */
-        for(i=0; i<64; i++)
-            bits_out[i] = B_blank[i];
-
-        /* UW data */
-        for (i=0; i < 8; i++)
-            bits_out[0 + i] = B_uw_d[i];
+        /* Fill out frame with blank prototype and the data UW */
+        memcpy(frame_out, B_blank, sizeof(B_blank));
+        fvhff_put_bits(frame_out, 0, def->uw_packed[1].uw[0], 8);
         
         if (def->fdc)
             freedv_data_channel_tx_frame(def->fdc, data, 6, &from_bit, &bcast_bit, &crc_bit, &end_bits);
         else
             return;
 
-        bits_out[56] = from_bit;
-        bits_out[57] = bcast_bit;
-        bits_out[58] = crc_bit;
-        bits_out[59] = 0; /* unused */
-
         /* Fill in data bits */
-        ibit = 0;
-        for(i=8; i<56; i++){   /* First half */
-            bits_out[i] = UNPACK_BIT_MSBFIRST(data,ibit);
-            ibit++;
-        }
-        for (i = 0; i < 4; i++)
-            bits_out[60 + i] = (end_bits >> (3-i)) & 0x1;
+        fvhff_copy_bits(frame_out, 8, data, 0, 48);
+
+        /* from, bcast, crc, one unused bit and the end bits */
+        fvhff_put_bits(frame_out, 56, (from_bit<<7) | (bcast_bit<<6) | (crc_bit<<5) | (end_bits&0xf), 8);
+    }
+}
+
+/* Place data and other bits into a frame, one bit per uint8_t */
+void fvhff_frame_data_bits(struct freedv_vhf_deframer * def, int frame_type,
+                        uint8_t bits_out[]){
+    uint8_t frame[FVHFF_MAX_FRAME_BITS/8];
+
+    if(frame_type == FREEDV_VHF_FRAME_A){
+        fvhff_frame_data_bits_packed(def, frame_type, frame);
+        fvhff_unpack(bits_out, frame, 96);
+    } else if (frame_type == FREEDV_HF_FRAME_B){
+        fvhff_frame_data_bits_packed(def, frame_type, frame);
+        fvhff_unpack(bits_out, frame, 64);
     }
 }
 
 /* Init and allocate memory for a freedv-vhf framer/deframer */
 struct freedv_vhf_deframer * fvhff_create_deframer(uint8_t frame_type, int enable_bit_flip){
     struct freedv_vhf_deframer * deframer;
-    uint8_t *bits,*invbits;
     int frame_size;
     int uw_size;
     
@@ -315,34 +314,27 @@ struct freedv_vhf_deframer * fvhff_create_deframer(uint8_t frame_type, int enabl
     if(deframer == NULL)
         return NULL;
         
-    /* Allocate the not-bit buffer */
-    if(enable_bit_flip){
-        invbits = malloc(sizeof(uint8_t)*frame_size);
-        if(invbits == NULL) {
-            free(deframer);
-            return NULL;
-        }
-    }else{
-        invbits = NULL;
-    }
-    
-    /* Allocate the bit buffer */
-    bits = malloc(sizeof(uint8_t)*frame_size);
-    if(bits == NULL) {
-        free(deframer);
-        return NULL;
-    }
-    
-    deframer->bits = bits;
-    deframer->invbits = invbits;
+    deframer->reg[0] = 0;
+    deframer->reg[1] = 0;
+    deframer->enable_bit_flip = enable_bit_flip;
     deframer->ftype = frame_type;
     deframer->state = ST_NOSYNC;
-    deframer->bitptr = 0;
     deframer->last_uw = 0;
     deframer->miss_cnt = 0;
     deframer->frame_size = frame_size;
     deframer->uw_size = uw_size;
     deframer->on_inv_bits = 0;
+
+    /* Pack the voice and data UWs for matching */
+    if(frame_type == FREEDV_VHF_FRAME_A){
+        uw_search_init(&deframer->uw_packed[0], A_uw_v, uw_size);
+        uw_search_init(&deframer->uw_packed[1], A_uw_d, uw_size);
+        deframer->uw_offset = 40;
+    }else{
+        uw_search_init(&deframer->uw_packed[0], B_uw_v, uw_size);
+        uw_search_init(&deframer->uw_packed[1], B_uw_d, uw_size);
+        deframer->uw_offset = 0;
+    }
     deframer->sym_size = 1;
     
     deframer->ber_est = 0;
@@ -394,7 +386,6 @@ int fvhff_get_varicode_size(struct freedv_vhf_deframer * def){
 
 void fvhff_destroy_deframer(struct freedv_vhf_deframer * def){
     freedv_data_channel_destroy(def->fdc);
-    free(def->bits);
     free(def);
 }
 
@@ -407,34 +398,52 @@ size_t fvhff_search_uw(const uint8_t bits[],size_t nbits,
                      const uint8_t uw[],    size_t uw_len,
                      size_t * delta_out,    size_t bits_per_sym){
 
-    size_t ibits,iuw;
-    size_t delta_min = uw_len;
-    size_t delta;
-    size_t offset_min = 0;
+    struct UW_SEARCH uw_packed;
+    int delta_min;
+    size_t offset_min;
+
     /* Walk through buffer bits */
-    for(ibits = 0; ibits < nbits-uw_len; ibits+=bits_per_sym){
-        delta = 0;
-        for(iuw = 0; iuw < uw_len; iuw++){
-            if(bits[ibits+iuw] != uw[iuw]) delta++;
-        }
-        if( delta < delta_min ){
-            delta_min = delta;
-            offset_min = ibits;
-        }
-    }
+    uw_search_init(&uw_packed, uw, uw_len);
+    offset_min = uw_search_best(&uw_packed, bits, nbits-uw_len, bits_per_sym, &delta_min);
     if(delta_out != NULL) *delta_out = delta_min;
     return offset_min;
 }
 
-/* See if the UW is where it should be, to within a tolerance, in a bit buffer */
-static int fvhff_match_uw(struct freedv_vhf_deframer * def,uint8_t bits[],int tol,int *rdiff, enum frame_payload_type *pt){
-    int frame_type  = def->ftype;
-    int bitptr      = def->bitptr;
-    int frame_size  = def->frame_size;
-    int uw_len      = def->uw_size;
-    int iuw,ibit;
-    const uint8_t * uw[2];
-    int uw_offset;
+/*
+ * The deframer keeps the last frame_size received bits in reg[], the
+ * newest in bit 0 of reg[0].  Bit i of a frame, once it is all in, has
+ * age frame_size-1-i.  For the inverted bitstream of 2400B fields are
+ * complemented as they are read out, so one register serves both.
+ */
+
+/* Shift n <= 56 bits, first bit most significant, into the register */
+static void fvhff_shift_in(struct freedv_vhf_deframer * def, uint64_t v, int n){
+    def->reg[1] = (def->reg[1]<<n) | (def->reg[0]>>(64-n));
+    def->reg[0] = (def->reg[0]<<n) | v;
+}
+
+/* Read field bits [pos, pos+n) of the frame in the register, n <= 56 */
+static uint64_t fvhff_field(struct freedv_vhf_deframer * def, int pos, int n, uint64_t inv){
+    int age = def->frame_size - pos - n;    /* age of the last bit of the field */
+    uint64_t v;
+
+    if(age >= 64)
+        v = def->reg[1] >> (age-64);
+    else if(age == 0)
+        v = def->reg[0];
+    else
+        v = (def->reg[0] >> age) | (def->reg[1] << (64-age));
+    return (v ^ inv) & ((1ULL<<n)-1);
+}
+
+/* Copy a field of the frame in the register to bit dst_pos of packed bytes */
+static void fvhff_extract_field(struct freedv_vhf_deframer * def, uint8_t dst[], int dst_pos, int pos, int n, uint64_t inv){
+    fvhff_put_bits(dst, dst_pos, fvhff_field(def, pos, n, inv), n);
+}
+
+/* See if the UW is where it should be, to within a tolerance, in the register */
+static int fvhff_match_uw(struct freedv_vhf_deframer * def,uint64_t inv,int tol,int *rdiff, enum frame_payload_type *pt){
+    uint64_t uw_bits = fvhff_field(def, def->uw_offset, def->uw_size, inv);
     int diff[2] = { 0, 0 };
     int i;
     int match[2];
@@ -445,32 +454,9 @@ static int fvhff_match_uw(struct freedv_vhf_deframer * def,uint8_t bits[],int to
     *pt = FRAME_PAYLOAD_TYPE_VOICE; 
     *rdiff = 0;
 
-    /* Set up parameters for the standard type of frame */
-    if(frame_type == FREEDV_VHF_FRAME_A){
-        uw[0] = A_uw_v;
-        uw[1] = A_uw_d;
-        uw_len = 16;
-        uw_offset = 40;
-    } else if(frame_type == FREEDV_HF_FRAME_B){
-        uw[0] = B_uw_v;
-        uw[1] = B_uw_d;
-        uw_len = 8;
-        uw_offset = 0;
-    } else {
-        return 0;
-    }
-    
     /* Check both the voice and data UWs */
     for (i = 0; i < 2; i++) {
-        /* Start bit pointer where UW should be */
-        ibit = bitptr + uw_offset;
-        if(ibit >= frame_size) ibit -= frame_size;
-        /* Walk through and match bits in frame with bits of UW */
-        for(iuw=0; iuw<uw_len; iuw++){
-            if(bits[ibit] != uw[i][iuw]) diff[i]++;
-            ibit++;
-            if(ibit >= frame_size) ibit = 0;
-        }
+        diff[i] = uw_search_errors_packed(&def->uw_packed[i], &uw_bits);
         match[i] = diff[i] <= tol;
     }
     /* Pick the best matching UW */
@@ -488,240 +474,100 @@ static int fvhff_match_uw(struct freedv_vhf_deframer * def,uint8_t bits[],int to
     return r;
 }
 
-static void fvhff_extract_frame_voice(struct freedv_vhf_deframer * def,uint8_t bits[],
+static void fvhff_extract_frame_voice(struct freedv_vhf_deframer * def,uint64_t inv,
     uint8_t codec2_out[],uint8_t proto_out[],uint8_t vc_out[]){
     int frame_type  = def->ftype;
-    int bitptr      = def->bitptr;
-    int frame_size  = def->frame_size;
-    int iframe,ibit;
+    uint64_t vc;
     
     if(frame_type == FREEDV_VHF_FRAME_A){
-        /* Extract codec2 bits */
+        /* Extract codec2 bits, packed MSB first */
         memset(codec2_out,0,7);
-        ibit = 0;
-        /* Extract and pack first half, MSB first */
-        iframe = bitptr+16;
-        if(iframe >= frame_size) iframe-=frame_size;
-        for(;ibit<24;ibit++){
-            codec2_out[ibit>>3] |= (bits[iframe]&0x1)<<(7-(ibit&0x7));
-            iframe++;
-            if(iframe >= frame_size) iframe=0;
-        }
-        
-        /* Extract and pack last half, MSB first */
-        iframe = bitptr+56;
-        if(iframe >= frame_size) iframe-=frame_size;
-        for(;ibit<52;ibit++){
-            codec2_out[ibit>>3] |= (bits[iframe]&0x1)<<(7-(ibit&0x7));
-            iframe++;
-            if(iframe >= frame_size) iframe=0;
-        }
+        fvhff_extract_field(def, codec2_out, 0, 16, 24, inv);
+        fvhff_extract_field(def, codec2_out, 24, 56, 28, inv);
+
         /* Extract varicode bits, if wanted */
         if(vc_out!=NULL){
-            iframe = bitptr+90;
-            if(iframe >= frame_size) iframe-=frame_size;
-            vc_out[0] = bits[iframe];
-            iframe++;
-            vc_out[1] = bits[iframe];
+            vc = fvhff_field(def, 90, 2, inv);
+            vc_out[0] = vc>>1;
+            vc_out[1] = vc&0x1;
         }
         /* Extract protocol bits, if proto is passed through */
         if(proto_out!=NULL){
             /* Clear protocol bit array */
             memset(proto_out,0,3);
-            ibit = 0;
-            /* Extract and pack first half, MSB first */
-            iframe = bitptr+4;
-            if(iframe >= frame_size) iframe-=frame_size;
-            for(;ibit<12;ibit++){
-                proto_out[ibit>>3] |= (bits[iframe]&0x1)<<(7-(ibit&0x7));
-                iframe++;
-                if(iframe >= frame_size) iframe=0;
-            }
-            
-            /* Extract and pack last half, MSB first */
-            iframe = bitptr+84;
-            if(iframe >= frame_size) iframe-=frame_size;
-            for(;ibit<20;ibit++){
-                proto_out[ibit>>3] |= (bits[iframe]&0x1)<<(7-(ibit&0x7));
-                iframe++;
-                if(iframe >= frame_size) iframe=0;
-            }
+            fvhff_extract_field(def, proto_out, 0, 4, 12, inv);
+            fvhff_extract_field(def, proto_out, 12, 84, 8, inv);
         }
 
     }else if(frame_type == FREEDV_HF_FRAME_B){
-        /* Pointers to both c2 frames */
-        uint8_t * codec2_out1 = &codec2_out[0];
-        uint8_t * codec2_out2 = &codec2_out[4];
-        
-        /* Extract codec2 bits */
+        /* Extract both c2 frames, the second starts at codec2_out[4] */
         memset(codec2_out,0,8);
-        ibit = 0;
-        
-        /* Extract and pack first c2 frame, MSB first */
-        iframe = bitptr+8;
-        if(iframe >= frame_size) iframe-=frame_size;
-        for(;ibit<28;ibit++){
-            codec2_out1[ibit>>3] |= (bits[iframe]&0x1)<<(7-(ibit&0x7));
-            iframe++;
-            if(iframe >= frame_size) iframe=0;
-        }
-        
-        /* Extract and pack second c2 frame, MSB first */
-        iframe = bitptr+36;
-        ibit = 0;
-        if(iframe >= frame_size) iframe-=frame_size;
-        for(;ibit<28;ibit++){
-            codec2_out2[ibit>>3] |= (bits[iframe]&0x1)<<(7-(ibit&0x7));
-            iframe++;
-            if(iframe >= frame_size) iframe=0;
-        }
+        fvhff_extract_field(def, codec2_out, 0, 8, 28, inv);
+        fvhff_extract_field(def, codec2_out, 32, 36, 28, inv);
     }else if(frame_type == FREEDV_VHF_FRAME_AT){
-        /* Extract codec2 bits */
+        /* Extract codec2 bits, packed MSB first */
         memset(codec2_out,0,7);
-        ibit = 0;
-        /* Extract and pack first half, MSB first */
-        iframe = bitptr+12;
-        if(iframe >= frame_size) iframe-=frame_size;
-        for(;ibit<24;ibit++){
-            codec2_out[ibit>>3] |= (bits[iframe]&0x1)<<(7-(ibit&0x7));
-            iframe++;
-            if(iframe >= frame_size) iframe=0;
-        }
-        
-        /* Extract and pack last half, MSB first */
-        iframe = bitptr+52;
-        if(iframe >= frame_size) iframe-=frame_size;
-        for(;ibit<52;ibit++){
-            codec2_out[ibit>>3] |= (bits[iframe]&0x1)<<(7-(ibit&0x7));
-            iframe++;
-            if(iframe >= frame_size) iframe=0;
-        }
+        fvhff_extract_field(def, codec2_out, 0, 12, 24, inv);
+        fvhff_extract_field(def, codec2_out, 24, 52, 28, inv);
+
         /* Extract varicode bits, if wanted */
         if(vc_out!=NULL){
-            iframe = bitptr+86;
-            if(iframe >= frame_size) iframe-=frame_size;
-            vc_out[0] = bits[iframe];
-            iframe++;
-            vc_out[1] = bits[iframe];
+            vc = fvhff_field(def, 86, 2, inv);
+            vc_out[0] = vc>>1;
+            vc_out[1] = vc&0x1;
         }
         /* Extract protocol bits, if proto is passed through */
         if(proto_out!=NULL){
             /* Clear protocol bit array */
             memset(proto_out,0,3);
-            ibit = 0;
-            /* Extract and pack first half, MSB first */
-            iframe = bitptr+4;
-            if(iframe >= frame_size) iframe-=frame_size;
-            for(;ibit<12;ibit++){
-                proto_out[ibit>>3] |= (bits[iframe]&0x1)<<(7-(ibit&0x7));
-                iframe++;
-                if(iframe >= frame_size) iframe=0;
-            }
-            
-            /* Extract and pack last half, MSB first */
-            iframe = bitptr+84;
-            if(iframe >= frame_size) iframe-=frame_size;
-            for(;ibit<20;ibit++){
-                proto_out[ibit>>3] |= (bits[iframe]&0x1)<<(7-(ibit&0x7));
-                iframe++;
-                if(iframe >= frame_size) iframe=0;
-            }
+            fvhff_extract_field(def, proto_out, 0, 0, 12, inv);
+            fvhff_extract_field(def, proto_out, 12, 80, 8, inv);
         }
 
     }
 }
 
-static void fvhff_extract_frame_data(struct freedv_vhf_deframer * def,uint8_t bits[]){
+static void fvhff_extract_frame_data(struct freedv_vhf_deframer * def,uint64_t inv){
     int frame_type  = def->ftype;
-    int bitptr      = def->bitptr;
-    int frame_size  = def->frame_size;
-    int iframe,ibit;
+    int flags;
     
     if(frame_type == FREEDV_VHF_FRAME_A){
         uint8_t data[8];
-        int end_bits = 0;
+        int end_bits;
         int from_bit;
         int bcast_bit;
     
-        iframe = bitptr+4;
-        if(iframe >= frame_size) iframe-=frame_size;
-        from_bit = bits[iframe];
-        iframe++;
-        if(iframe >= frame_size) iframe-=frame_size;
-        bcast_bit = bits[iframe];
-
-        /* Extract data bits */
-        memset(data,0,8);
-        ibit = 0;
-        /* Extract and pack first half, MSB first */
-        iframe = bitptr+8;
-        if(iframe >= frame_size) iframe-=frame_size;
-        for(;ibit<32;ibit++){
-            data[ibit>>3] |= (bits[iframe]&0x1)<<(7-(ibit&0x7));
-            iframe++;
-            if(iframe >= frame_size) iframe=0;
-        }
-        
-        /* Extract and pack last half, MSB first */
-        iframe = bitptr+56;
-        if(iframe >= frame_size) iframe-=frame_size;
-        for(;ibit<64;ibit++){
-            data[ibit>>3] |= (bits[iframe]&0x1)<<(7-(ibit&0x7));
-            iframe++;
-            if(iframe >= frame_size) iframe=0;
-        }
+        flags = fvhff_field(def, 4, 2, inv);
+        from_bit = flags>>1;
+        bcast_bit = flags&0x1;
+
+        /* Extract data bits, packed MSB first */
+        fvhff_extract_field(def, data, 0, 8, 32, inv);
+        fvhff_extract_field(def, data, 32, 56, 32, inv);
 
         /* Extract endbits value, MSB first*/
-        iframe = bitptr+88;
-        ibit = 0;
-        if(iframe >= frame_size) iframe-=frame_size;
-        for(;ibit<4;ibit++){
-            end_bits |= (bits[iframe]&0x1)<<(3-(ibit));
-            iframe++;
-            if(iframe >= frame_size) iframe=0;
-        }
+        end_bits = fvhff_field(def, 88, 4, inv);
     
         if (def->fdc) {
             freedv_data_channel_rx_frame(def->fdc, data, 8, from_bit, bcast_bit, 0, end_bits);
         }
     } else if(frame_type == FREEDV_HF_FRAME_B){
         uint8_t data[6];
-        int end_bits = 0;
+        int end_bits;
         int from_bit;
         int bcast_bit;
-	int crc_bit;
-        
-        ibit = 0;
-        memset(data,0,6);
+        int crc_bit;
         
-        /* Extract and pack first c2 frame, MSB first */
-        iframe = bitptr+8;
-        if(iframe >= frame_size) iframe-=frame_size;
-        for(;ibit<48;ibit++){
-            data[ibit>>3] |= (bits[iframe]&0x1)<<(7-(ibit&0x7));
-            iframe++;
-            if(iframe >= frame_size) iframe=0;
-        }
+        /* Extract data bits, packed MSB first */
+        fvhff_extract_field(def, data, 0, 8, 48, inv);
 
-        iframe = bitptr+56;
-        if(iframe >= frame_size) iframe-=frame_size;
-        from_bit = bits[iframe];
-        iframe++;
-        if(iframe >= frame_size) iframe-=frame_size;
-        bcast_bit = bits[iframe];
-        iframe++;
-        if(iframe >= frame_size) iframe-=frame_size;
-        crc_bit = bits[iframe];
+        flags = fvhff_field(def, 56, 3, inv);
+        from_bit = flags>>2;
+        bcast_bit = (flags>>1)&0x1;
+        crc_bit = flags&0x1;
         
         /* Extract endbits value, MSB first*/
-        iframe = bitptr+60;
-        ibit = 0;
-        if(iframe >= frame_size) iframe-=frame_size;
-        for(;ibit<4;ibit++){
-            end_bits |= (bits[iframe]&0x1)<<(3-(ibit));
-            iframe++;
-            if(iframe >= frame_size) iframe=0;
-        }
+        end_bits = fvhff_field(def, 60, 4, inv);
 
         if (def->fdc) {
             freedv_data_channel_rx_frame(def->fdc, data, 6, from_bit, bcast_bit, crc_bit, end_bits);
@@ -729,40 +575,39 @@ static void fvhff_extract_frame_data(struct freedv_vhf_deframer * def,uint8_t bi
     }
 }
 
-static void fvhff_extract_frame(struct freedv_vhf_deframer * def,uint8_t bits[],uint8_t codec2_out[],
+static void fvhff_extract_frame(struct freedv_vhf_deframer * def,uint64_t inv,uint8_t codec2_out[],
     uint8_t proto_out[],uint8_t vc_out[],enum frame_payload_type pt){
     switch (pt) {
         case FRAME_PAYLOAD_TYPE_VOICE:
-        fvhff_extract_frame_voice(def, bits, codec2_out, proto_out, vc_out);
+        fvhff_extract_frame_voice(def, inv, codec2_out, proto_out, vc_out);
         break;
     case FRAME_PAYLOAD_TYPE_DATA:
-        fvhff_extract_frame_data(def, bits);
+        fvhff_extract_frame_data(def, inv);
         break;
     }
 }
 
 /*
- * Try to find the UW and extract codec/proto/vc bits in def->frame_size bits 
+ * Try to find the UW and extract codec/proto/vc bits in def->frame_size
+ * bits, packed MSB first.  Once synchronised the bits up to the next UW
+ * are shifted in together, before that the UW is checked at every bit.
  */
-int fvhff_deframe_bits(struct freedv_vhf_deframer * def,uint8_t codec2_out[],uint8_t proto_out[],
-    uint8_t vc_out[],uint8_t bits_in[]){
-    uint8_t * strbits  = def->bits;
-    uint8_t * invbits  = def->invbits;
-    uint8_t * bits;
+int fvhff_deframe_bits_packed(struct freedv_vhf_deframer * def,uint8_t codec2_out[],uint8_t proto_out[],
+    uint8_t vc_out[],const uint8_t packed_in[]){
     int on_inv_bits = def->on_inv_bits;
     int frame_type  = def->ftype;
     int state       = def->state;
-    int bitptr      = def->bitptr;
     int last_uw     = def->last_uw;
     int miss_cnt    = def->miss_cnt;
     int frame_size  = def->frame_size;
     int uw_size     = def->uw_size;
     int uw_diff;
-    int i;
+    int i,n;
     int uw_first_tol;   
     int uw_sync_tol;
     int miss_tol;
     int extracted_frame = 0;
+    uint64_t inv;
     enum frame_payload_type pt = FRAME_PAYLOAD_TYPE_VOICE;
     
     /* Possibly set up frame-specific params here */
@@ -777,34 +622,21 @@ int fvhff_deframe_bits(struct freedv_vhf_deframer * def,uint8_t codec2_out[],uin
     }else{
         return 0;
     }
-    /* Skip N bits for multi-bit symbol modems */
-    for(i=0; i<frame_size; i++){
-        /* Put a bit in the buffer */
-        strbits[bitptr] = bits_in[i];
-        /* If we're checking the inverted bitstream, put a bit in it */
-        if(invbits!=NULL)
-            invbits[bitptr] = bits_in[i]?0:1;
-        
-        bitptr++;
-        if(bitptr >= frame_size) bitptr -= frame_size;
-        def->bitptr = bitptr;
+    for(i=0; i<frame_size; i+=n){
         /* Enter state machine */
         if(state==ST_SYNC){
             /* Already synchronized, just wait till UW is back where it should be */
-            last_uw++;
-            if(invbits!=NULL){
-                if(on_inv_bits)
-                    bits = invbits;
-                else
-                    bits = strbits;
-            }else{
-                bits=strbits;
-            }
+            n = frame_size - last_uw;
+            if(n > frame_size - i) n = frame_size - i;
+            if(n > 56) n = 56;
+            fvhff_shift_in(def, fvhff_get_bits(packed_in, i, n), n);
+            last_uw += n;
+            inv = on_inv_bits ? ~0ULL : 0;
             /* UW should be here. We're sunk, so deframe anyway */
             if(last_uw == frame_size){
                 last_uw = 0;
                 
-                if(!fvhff_match_uw(def,bits,uw_sync_tol,&uw_diff, &pt))
+                if(!fvhff_match_uw(def,inv,uw_sync_tol,&uw_diff, &pt))
                     miss_cnt++;
                 else
                     miss_cnt=0;
@@ -815,7 +647,7 @@ int fvhff_deframe_bits(struct freedv_vhf_deframer * def,uint8_t codec2_out[],uin
                 }
                 /* Extract the bits */
                 extracted_frame = 1;
-                fvhff_extract_frame(def,bits,codec2_out,proto_out,vc_out,pt);
+                fvhff_extract_frame(def,inv,codec2_out,proto_out,vc_out,pt);
                 
                 /* Update BER estimate */
                 def->ber_est = (.995*def->ber_est) + (.005*((float)uw_diff)/((float)uw_size));
@@ -824,28 +656,30 @@ int fvhff_deframe_bits(struct freedv_vhf_deframer * def,uint8_t codec2_out[],uin
             }
         /* Not yet sunk */
         }else{
+            n = 1;
+            fvhff_shift_in(def, fvhff_get_bits(packed_in, i, 1), 1);
             /* It's a sync!*/
-            if(invbits!=NULL){
-                if(fvhff_match_uw(def,invbits,uw_first_tol, &uw_diff, &pt)){
+            if(def->enable_bit_flip){
+                if(fvhff_match_uw(def,~0ULL,uw_first_tol, &uw_diff, &pt)){
                     state = ST_SYNC;
                     last_uw = 0;
                     miss_cnt = 0;
                     extracted_frame = 1;
                     on_inv_bits = 1;
-                    fvhff_extract_frame(def,invbits,codec2_out,proto_out,vc_out,pt);
+                    fvhff_extract_frame(def,~0ULL,codec2_out,proto_out,vc_out,pt);
                     /* Update BER estimate */
                     def->ber_est = (.995*def->ber_est) + (.005*((float)uw_diff)/((float)uw_size));
                     def->total_uw_bits += uw_size;
                     def->total_uw_err += uw_diff;
                 }
             }
-            if(fvhff_match_uw(def,strbits,uw_first_tol, &uw_diff, &pt)){
+            if(fvhff_match_uw(def,0,uw_first_tol, &uw_diff, &pt)){
                 state = ST_SYNC;
                 last_uw = 0;
                 miss_cnt = 0;
                 extracted_frame = 1;
                 on_inv_bits = 0;
-                fvhff_extract_frame(def,strbits,codec2_out,proto_out,vc_out,pt);
+                fvhff_extract_frame(def,0,codec2_out,proto_out,vc_out,pt);
                 /* Update BER estimate */
                 def->ber_est = (.995*def->ber_est) + (.005*((float)uw_diff)/((float)uw_size));
                 def->total_uw_bits += uw_size;
@@ -860,3 +694,18 @@ int fvhff_deframe_bits(struct freedv_vhf_deframer * def,uint8_t codec2_out[],uin
     /* return zero for data frames, they are already handled by callback */
     return extracted_frame && pt == FRAME_PAYLOAD_TYPE_VOICE;
 }
+
+/*
+ * As fvhff_deframe_bits_packed(), with def->frame_size bits in, one bit
+ * per uint8_t 
+ */
+int fvhff_deframe_bits(struct freedv_vhf_deframer * def,uint8_t codec2_out[],uint8_t proto_out[],
+    uint8_t vc_out[],uint8_t bits_in[]){
+    uint8_t packed_in[FVHFF_MAX_FRAME_BITS/8];
+    int i;
+
+    memset(packed_in, 0, sizeof(packed_in));
+    for(i=0; i<def->frame_size; i++)
+        packed_in[i>>3] |= (bits_in[i]&0x1)<<(7-(i&0x7));
+    return fvhff_deframe_bits_packed(def, codec2_out, proto_out, vc_out, packed_in);
+}
@@ -37,25 +37,30 @@
 #define _FREEDV_VHF_FRAMING_H
 
 #include "freedv_data_channel.h"
+#include "uw_search.h"
 
 /* Standard frame type */
 #define FREEDV_VHF_FRAME_A 1    /* 2400A/B Frame */
 #define FREEDV_HF_FRAME_B 2     /* 800XA Frame */
 #define FREEDV_VHF_FRAME_AT 3   /* 4800T Frame */
 
+/* Largest frame, in bits */
+#define FVHFF_MAX_FRAME_BITS 128
+
 struct freedv_vhf_deframer {
     int ftype;          /* Type of frame to be looking for */
     int state;          /* State of deframer */
-    uint8_t * bits;     /* Bits currently being decanted */
-    uint8_t * invbits;  /* Inversion of bits currently being decanted, for FMFSK */
+    uint64_t reg[2];    /* Last frame_size bits received, newest in bit 0 of reg[0] */
+    int enable_bit_flip;/* Also look for the inverted bits, for FMFSK */
     
-    int bitptr;         /* Pointer into circular bit buffer */
     int miss_cnt;       /* How many UWs have been missed */
     int last_uw;        /* How many bits since the last UW? */
     int frame_size;     /* How big is a frame? */
     int uw_size;        /* How big is the UW */
     int on_inv_bits;    /* Are we using the inverted bits? */
     int sym_size;       /* How many bits in a modem symbol */ 
+    struct UW_SEARCH uw_packed[2]; /* Voice and data UWs, packed for fvhff_match_uw */
+    int uw_offset;      /* Where the UW starts in a frame */
 
     float ber_est;      /* Bit error rate estimate */
     int total_uw_bits;  /* Total RX-ed bits of UW */
@@ -80,11 +85,20 @@ int fvhff_get_varicode_size(struct freedv_vhf_deframer * def);
 /* Free the memory used by a freedv-vhf framer/deframer */
 void fvhff_destroy_deframer(struct freedv_vhf_deframer * def);
 
+/*
+ * Frames are packed MSB first, 8 bits to a byte, as are codec2 and protocol
+ * bits.  The varicode bits are always one per uint8_t.  The functions
+ * without _packed take and give frames one bit per uint8_t.
+ */
+
 /* Place codec and other bits into a frame */
+void fvhff_frame_bits_packed(int frame_type,uint8_t frame_out[],uint8_t codec2_in[],uint8_t proto_in[],uint8_t vc_in[]);
 void fvhff_frame_bits(int frame_type,uint8_t bits_out[],uint8_t codec2_in[],uint8_t proto_in[],uint8_t vc_in[]);
+void fvhff_frame_data_bits_packed(struct freedv_vhf_deframer * def, int frame_type,uint8_t frame_out[]);
 void fvhff_frame_data_bits(struct freedv_vhf_deframer * def, int frame_type,uint8_t bits_out[]);
 
-/* Find and extract frames from a stream of bits */
+/* Find and extract frames from a stream of bits, frame size bits at a time */
+int fvhff_deframe_bits_packed(struct freedv_vhf_deframer * def,uint8_t codec2_out[],uint8_t proto_out[],uint8_t vc_out[],const uint8_t packed_in[]);
 int fvhff_deframe_bits(struct freedv_vhf_deframer * def,uint8_t codec2_out[],uint8_t proto_out[],uint8_t vc_out[],uint8_t bits_in[]);
 
 /* Is the de-framer synchronized? */
@@ -68,6 +68,7 @@
 
 \*---------------------------------------------------------------------------*/
 
+#include <string.h>
 #include <assert.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -676,7 +677,7 @@ void fsk_demod_freq_est(struct FSK *fsk, COMP fsk_in[],float *freqs,int M){
     #endif
 }
 
-void fsk2_demod(struct FSK *fsk, uint8_t rx_bits[], float rx_sd[], COMP fsk_in[]){
+void fsk2_demod(struct FSK *fsk, uint8_t rx_bits[], uint8_t rx_packed[], float rx_sd[], COMP fsk_in[]){
     int N = fsk->N;
     int Ts = fsk->Ts;
     int Rs = fsk->Rs;
@@ -946,7 +947,14 @@ void fsk2_demod(struct FSK *fsk, uint8_t rx_bits[], float rx_sd[], COMP fsk_in[]
             }
         }
         
-        /* Get the actual bit */
+        /* Get the actual bit, MSB first if packed */
+        if(rx_packed != NULL){
+            if(M==2){
+                rx_packed[i>>3] |= (sym==1)<<(7-(i&0x7));
+            }else if(M==4){
+                rx_packed[i>>2] |= sym<<(6-((i&0x3)<<1));
+            }
+        }
         if(rx_bits != NULL){
             /* Get bits for 2FSK and 4FSK */
             /* TODO: Replace this with something more generic maybe */
@@ -1108,11 +1116,20 @@ void fsk2_demod(struct FSK *fsk, uint8_t rx_bits[], float rx_sd[], COMP fsk_in[]
 }
 
 void fsk_demod(struct FSK *fsk, uint8_t rx_bits[], COMP fsk_in[]){
-    fsk2_demod(fsk,rx_bits,NULL,fsk_in);
+    fsk2_demod(fsk,rx_bits,NULL,NULL,fsk_in);
+}
+
+void fsk_demod_packed(struct FSK *fsk, uint8_t rx_packed[], COMP fsk_in[]){
+    memset(rx_packed,0,(fsk->Nbits+7)/8);
+    fsk2_demod(fsk,NULL,rx_packed,NULL,fsk_in);
 }
 
 void fsk_demod_sd(struct FSK *fsk, float rx_sd[], COMP fsk_in[]){
-    fsk2_demod(fsk,NULL,rx_sd,fsk_in);
+    fsk2_demod(fsk,NULL,NULL,rx_sd,fsk_in);
+}
+
+void fsk_demod_bits_sd(struct FSK *fsk, uint8_t rx_bits[], float rx_sd[], COMP fsk_in[]){
+    fsk2_demod(fsk,rx_bits,NULL,rx_sd,fsk_in);
 }
 
 void fsk_mod(struct FSK *fsk,float fsk_out[],uint8_t tx_bits[]){
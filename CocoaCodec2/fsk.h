@@ -183,6 +183,15 @@ uint32_t fsk_nin(struct FSK *fsk);
  */
 void fsk_demod(struct FSK *fsk, uint8_t rx_bits[],COMP fsk_in[]);
 
+/*
+ * As fsk_demod(), with the bits packed MSB first, 8 to a byte.
+ *
+ * struct FSK *fsk - FSK config/state struct, set up by fsk_create
+ * uint8_t rx_packed[] - Buffer for (Nbits+7)/8 bytes of packed bits
+ * float fsk_in[] - nin samples of modualted FSK
+ */
+void fsk_demod_packed(struct FSK *fsk, uint8_t rx_packed[], COMP fsk_in[]);
+
 /*
  * Demodulate some number of FSK samples. The number of samples to be 
  *  demodulated can be found by calling fsk_nin().
@@ -193,6 +202,17 @@ void fsk_demod(struct FSK *fsk, uint8_t rx_bits[],COMP fsk_in[]);
  */
 void fsk_demod_sd(struct FSK *fsk, float rx_bits[],COMP fsk_in[]);
 
+/*
+ * As fsk_demod() and fsk_demod_sd() together, from a single pass of
+ * the demodulator.
+ *
+ * struct FSK *fsk - FSK config/state struct, set up by fsk_create
+ * uint8_t rx_bits[] - Buffer for Nbits unpacked bits to be written
+ * float rx_sd[] - Buffer for Nbits soft decision bits to be written
+ * float fsk_in[] - nin samples of modualted FSK
+ */
+void fsk_demod_bits_sd(struct FSK *fsk, uint8_t rx_bits[], float rx_sd[], COMP fsk_in[]);
+
 /* enables/disables normalisation of eye diagram samples */
   
 void fsk_stats_normalise_eye(struct FSK *fsk, int normalise_enable);
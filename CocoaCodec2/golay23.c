@@ -40,9 +40,11 @@
 
 #ifndef NO_TABLES
 #ifdef RUN_TIME_TABLES
+#include <pthread.h>
 int static encoding_table[4096];
 int static decoding_table[2048];
 static int inited = 0;
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
 #else
 //default is to use precomputed tables
 #include "golayenctable.h"
@@ -126,10 +128,9 @@ static int golay23_decode_no_tables(int c) {
 }
 #endif
 
-void golay23_init(void) {
 #ifdef RUN_TIME_TABLES
+static void golay23_make_tables(void) {
     int x, y, z;
-    inited = 1;
     for (x = 0; x < 4096; x++) {
         encoding_table[x] = golay23_encode_no_tables(x);
     }
@@ -156,6 +157,16 @@ void golay23_init(void) {
             }
         }
     }
+    inited = 1;
+}
+#endif
+
+/* builds the tables on the first call only, as freedv and horus instances
+   on other threads may already be decoding with them */
+
+void golay23_init(void) {
+#ifdef RUN_TIME_TABLES
+    pthread_once(&tables_once, golay23_make_tables);
 #endif
 }
 
@@ -191,6 +202,76 @@ int  golay23_count_errors(int recd_codeword, int corrected_codeword) {
     return popcount(recd_codeword ^ corrected_codeword);
 }
 
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: golay23_decode_soft
+  DATE CREATED: October 2026
+
+  Chase-II soft decision decoder.  sd[0] is the soft value of codeword
+  bit 22 (the first bit sent) and sd[22] of bit 0, sd[] > 0 for a one.
+  Each pattern of flips over the GOLAY23_CHASE_BITS least reliable bits
+  is hard decoded, and the codeword whose differences from the hard
+  decisions have the smallest total |sd[]| wins.  Returns the codeword
+  in the same format as golay23_decode().
+
+\*---------------------------------------------------------------------------*/
+
+#define GOLAY23_CHASE_BITS 4
+
+int  golay23_decode_soft(const float sd[]) {
+    float mag[23], metric, best_metric;
+    int   weak[GOLAY23_CHASE_BITS];
+    int   i, j, k, hard, pattern, test, c, diff, best;
+
+    /* hard decisions and reliabilities, bit i of the codeword is sd[22-i] */
+
+    hard = 0;
+    for(i=0; i<23; i++) {
+        float x = sd[22-i];
+        hard |= (x > 0.0) << i;
+        mag[i] = (x > 0.0) ? x : -x;
+    }
+
+    /* least reliable bits, by insertion into a short sorted list */
+
+    for(k=0; k<GOLAY23_CHASE_BITS; k++)
+        weak[k] = -1;
+    for(i=0; i<23; i++) {
+        for(k=0; k<GOLAY23_CHASE_BITS; k++) {
+            if ((weak[k] == -1) || (mag[i] < mag[weak[k]])) {
+                for(j=GOLAY23_CHASE_BITS-1; j>k; j--)
+                    weak[j] = weak[j-1];
+                weak[k] = i;
+                break;
+            }
+        }
+    }
+
+    best = golay23_decode(hard);
+    best_metric = -1.0;
+    for(pattern=0; pattern<(1<<GOLAY23_CHASE_BITS); pattern++) {
+        test = hard;
+        for(k=0; k<GOLAY23_CHASE_BITS; k++)
+            if (pattern & (1<<k))
+                test ^= 1 << weak[k];
+        c = golay23_decode(test);
+
+        /* soft distance from the received word */
+
+        metric = 0.0;
+        diff = c ^ hard;
+        for(i=0; diff; i++, diff >>= 1)
+            if (diff & 1)
+                metric += mag[i];
+        if ((best_metric < 0.0) || (metric < best_metric)) {
+            best_metric = metric;
+            best = c;
+        }
+    }
+
+    return best;
+}
+
 /**
  * Table generation and testing code below
  */
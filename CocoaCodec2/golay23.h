@@ -38,6 +38,9 @@ int  golay23_decode(int received_codeword);
 int  golay23_count_errors(int recd_codeword, int corrected_codeword);
 int  golay23_syndrome(int c);
 
+/* soft decision decode, sd[0..22] > 0 for a one, first bit sent first */
+int  golay23_decode_soft(const float sd[]);
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,6 +30,7 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "gp_interleaver.h"
 
 /*
@@ -65,7 +66,7 @@ int choose_interleaver_b(int Nbits)
 {
     int i;
 
-    for(i=0; i<sizeof(b_table)/(2*sizeof(int)); i+=2) {
+    for(i=0; i<sizeof(b_table)/sizeof(int); i+=2) {
         if (b_table[i] == Nbits) {
             return b_table[i+1];
         }
@@ -74,14 +75,88 @@ int choose_interleaver_b(int Nbits)
     /* if we get it means a Nbits we dont have in our table so choke */
     
     assert(0);
+    return 0;
+}
+
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: gp_interleaver_create
+  DATE CREATED: October 2026
+
+  Works out the permutation for one Nbits, so the (de)interleave calls
+  are just a table driven copy.  Returns NULL if out of memory.
+
+\*---------------------------------------------------------------------------*/
+
+struct GP_INTERLEAVER *gp_interleaver_create(int Nbits)
+{
+    struct GP_INTERLEAVER *gp;
+    int i, j;
+
+    assert((Nbits > 0) && (Nbits <= 65536));
+
+    gp = (struct GP_INTERLEAVER*)malloc(sizeof(struct GP_INTERLEAVER));
+    if (gp == NULL)
+        return NULL;
+    gp->perm = (uint16_t*)malloc(sizeof(uint16_t)*Nbits);
+    if (gp->perm == NULL) {
+        free(gp);
+        return NULL;
+    }
+    gp->Nbits = Nbits;
+    gp->b = choose_interleaver_b(Nbits);
+
+    for (i=0, j=0; i<Nbits; i++) {
+        gp->perm[i] = j;
+        j += gp->b;
+        if (j >= Nbits)
+            j -= Nbits;
+    }
+
+    return gp;
+}
+
+void gp_interleaver_destroy(struct GP_INTERLEAVER *gp)
+{
+    assert(gp != NULL);
+    free(gp->perm);
+    free(gp);
+}
+
+void gp_interleaver_interleave_comp(struct GP_INTERLEAVER *gp, COMP interleaved_frame[], COMP frame[]) {
+  const uint16_t *perm = gp->perm;
+  int i;
+  for (i=0; i<gp->Nbits; i++)
+    interleaved_frame[perm[i]] = frame[i];
+}
+
+void gp_interleaver_deinterleave_comp(struct GP_INTERLEAVER *gp, COMP frame[], COMP interleaved_frame[]) {
+  const uint16_t *perm = gp->perm;
+  int i;
+  for (i=0; i<gp->Nbits; i++)
+    frame[i] = interleaved_frame[perm[i]];
+}
+
+void gp_interleaver_interleave_float(struct GP_INTERLEAVER *gp, float interleaved_frame[], float frame[]) {
+  const uint16_t *perm = gp->perm;
+  int i;
+  for (i=0; i<gp->Nbits; i++)
+    interleaved_frame[perm[i]] = frame[i];
+}
+
+void gp_interleaver_deinterleave_float(struct GP_INTERLEAVER *gp, float frame[], float interleaved_frame[]) {
+  const uint16_t *perm = gp->perm;
+  int i;
+  for (i=0; i<gp->Nbits; i++)
+    frame[i] = interleaved_frame[perm[i]];
 }
 
 
 void gp_interleave_comp(COMP interleaved_frame[], COMP frame[], int Nbits) {
   int b = choose_interleaver_b(Nbits);
   int i,j;
-  for (i=0; i<Nbits; i++) {
-    j = (b*i) % Nbits;
+  for (i=0, j=0; i<Nbits; i++, j=(j+b<Nbits)?j+b:j+b-Nbits) {
     interleaved_frame[j] = frame[i];
   }
 }
@@ -89,8 +164,7 @@ void gp_interleave_comp(COMP interleaved_frame[], COMP frame[], int Nbits) {
 void gp_deinterleave_comp(COMP frame[], COMP interleaved_frame[], int Nbits) {
   int b = choose_interleaver_b(Nbits);
   int i,j;
-  for (i=0; i<Nbits; i++) {
-    j = (b*i) % Nbits;
+  for (i=0, j=0; i<Nbits; i++, j=(j+b<Nbits)?j+b:j+b-Nbits) {
     frame[i] =  interleaved_frame[j];
   }
 }
@@ -99,8 +173,7 @@ void gp_interleave_float(float interleaved_frame[], float frame[], int Nbits) {
   int b = choose_interleaver_b(Nbits);
   int i,j;
    
-  for (i=0; i<Nbits; i++) {
-    j = (b*i) % Nbits;
+  for (i=0, j=0; i<Nbits; i++, j=(j+b<Nbits)?j+b:j+b-Nbits) {
     interleaved_frame[j] = frame[i];
   }
 }
@@ -109,8 +182,7 @@ void gp_deinterleave_float(float frame[], float interleaved_frame[], int Nbits)
   int b = choose_interleaver_b(Nbits);
   int i,j;
    
-  for (i=0; i<Nbits; i++) {
-    j = (b*i) % Nbits;
+  for (i=0, j=0; i<Nbits; i++, j=(j+b<Nbits)?j+b:j+b-Nbits) {
     frame[i] = interleaved_frame[j];
   }
 }
@@ -31,8 +31,27 @@
 #ifndef __GP_INTERLEAVER__
 #define __GP_INTERLEAVER__
 
+#include <stdint.h>
 #include "comp.h"
 
+/* an interleaver for one Nbits, with its permutation worked out once */
+
+struct GP_INTERLEAVER {
+    int       Nbits;
+    int       b;
+    uint16_t *perm;   /* de-interleaved element i is interleaved element perm[i] */
+};
+
+struct GP_INTERLEAVER *gp_interleaver_create(int Nbits);
+void gp_interleaver_destroy(struct GP_INTERLEAVER *gp);
+
+void gp_interleaver_interleave_comp(struct GP_INTERLEAVER *gp, COMP interleaved_frame[], COMP frame[]);
+void gp_interleaver_deinterleave_comp(struct GP_INTERLEAVER *gp, COMP frame[], COMP interleaved_frame[]);
+void gp_interleaver_interleave_float(struct GP_INTERLEAVER *gp, float interleaved_frame[], float frame[]);
+void gp_interleaver_deinterleave_float(struct GP_INTERLEAVER *gp, float frame[], float interleaved_frame[]);
+
+/* as above, but b is looked up on every call */
+
 void gp_interleave_comp(COMP interleaved_frame[], COMP frame[], int Nbits);
 void gp_deinterleave_comp(COMP frame[], COMP interleaved_frame[], int Nbits);
 void gp_interleave_float(float frame[], float interleaved_frame[], int Nbits);
@@ -34,6 +34,7 @@
 #include "horus_api.h"
 #include "fsk.h"
 #include "horus_l2.h"
+#include "uw_search.h"
 
 #define MAX_UW_LENGTH                  100
 #define HORUS_API_VERSION                1    /* unique number that is bumped if API changes */
@@ -47,12 +48,14 @@ struct horus {
     int         Fs;                  /* sample rate in Hz                   */
     int         mFSK;                /* number of FSK tones                 */
     int         Rs;                  /* symbol rate in Hz                   */
-    int         uw[MAX_UW_LENGTH];   /* unique word bits mapped to +/-1     */
+    struct UW_SEARCH uw;             /* packed unique word                  */
     int         uw_thresh;           /* threshold for UW detection          */
     int         uw_len;              /* length of unique word               */
     int         max_packet_len;      /* max length of a telemetry packet    */
-    uint8_t    *rx_bits;             /* buffer of received bits             */
-    int         rx_bits_len;         /* length of rx_bits buffer            */
+    uint8_t    *rx_bits;             /* ring of received bits, written twice */
+    int         rx_bits_len;         /* length of rx_bits ring              */
+    int         rx_bits_head;        /* index of oldest bit in rx_bits      */
+    float      *rx_sd;               /* soft decisions, same layout as rx_bits */
     int         crc_ok;              /* most recent packet checksum results */
     int         total_payload_bits;  /* num bits rx-ed in last RTTY packet  */
 };
@@ -88,11 +91,9 @@ struct horus *horus_open (int mode) {
         hstates->mFSK = 2;
         hstates->max_packet_len = 1000;
 
-        /* map UW to make it easier to search for */
+        /* pack UW to make it easier to search for */
 
-        for (i=0; i<sizeof(uw_horus_rtty); i++) {
-            hstates->uw[i] = 2*uw_horus_rtty[i] - 1;
-        }        
+        uw_search_init(&hstates->uw, (uint8_t*)uw_horus_rtty, sizeof(uw_horus_rtty));
         hstates->uw_len = sizeof(uw_horus_rtty);
         hstates->uw_thresh = sizeof(uw_horus_rtty) - 2;  /* allow a few bit errors in UW detection */
         hstates->rx_bits_len = hstates->max_packet_len;
@@ -101,9 +102,7 @@ struct horus *horus_open (int mode) {
     if (mode == HORUS_MODE_BINARY) {
         hstates->mFSK = 4;
         hstates->max_packet_len = HORUS_BINARY_NUM_BITS;
-        for (i=0; i<sizeof(uw_horus_binary); i++) {
-            hstates->uw[i] = 2*uw_horus_binary[i] - 1;
-        }
+        uw_search_init(&hstates->uw, (uint8_t*)uw_horus_binary, sizeof(uw_horus_binary));
         hstates->uw_len = sizeof(uw_horus_binary);
         hstates->uw_thresh = sizeof(uw_horus_binary) - 2; /* allow a few bit errors in UW detection */
         horus_l2_init();
@@ -112,15 +111,26 @@ struct horus *horus_open (int mode) {
    
     hstates->fsk = fsk_create(hstates->Fs, hstates->Rs, hstates->mFSK, 1000, 2*hstates->Rs);
 
-    /* allocate enough room for two packets so we know there will be
-       one complete packet if we find a UW at start */
+    /* allocate enough room for a packet plus the latest bits so we know
+       there will be one complete packet if we find a UW at start.  Each
+       bit is stored at i and i+rx_bits_len, so the last rx_bits_len bits
+       can always be read in order from rx_bits[rx_bits_head] */
     
     hstates->rx_bits_len += hstates->fsk->Nbits;
-    hstates->rx_bits = (uint8_t*)malloc(hstates->rx_bits_len);
+    hstates->rx_bits = (uint8_t*)malloc(2*hstates->rx_bits_len);
     assert(hstates->rx_bits != NULL);
-    for(i=0; i<hstates->rx_bits_len; i++) {
+    for(i=0; i<2*hstates->rx_bits_len; i++) {
         hstates->rx_bits[i] = 0;
     }
+    hstates->rx_bits_head = 0;
+
+    /* binary packets are decoded from soft decisions */
+
+    hstates->rx_sd = NULL;
+    if (mode == HORUS_MODE_BINARY) {
+        hstates->rx_sd = (float*)calloc(2*hstates->rx_bits_len, sizeof(float));
+        assert(hstates->rx_sd != NULL);
+    }
 
     hstates->crc_ok = 0;
     hstates->total_payload_bits = 0;
@@ -132,6 +142,7 @@ void horus_close (struct horus *hstates) {
     assert(hstates != NULL);
     fsk_destroy(hstates->fsk);
     free(hstates->rx_bits);
+    free(hstates->rx_sd);
     free(hstates);
 }
 
@@ -142,34 +153,22 @@ uint32_t horus_nin(struct horus *hstates) {
     return nin;
 }
 
-int horus_find_uw(struct horus *hstates, int n) {
-    int i, j, corr, mx, mx_ind;
-    int rx_bits_mapped[n+hstates->uw_len];
-    
-    /* map rx_bits to +/-1 for UW search */
+/* the last rx_bits_len received bits, oldest first */
 
-    for(i=0; i<n+hstates->uw_len; i++) {
-        rx_bits_mapped[i] = 2*hstates->rx_bits[i] - 1;
-    }
-    
-    /* look for UW  */
+static uint8_t *horus_rx_window(struct horus *hstates) {
+    return &hstates->rx_bits[hstates->rx_bits_head];
+}
 
-    mx = 0; mx_ind = 0;
-    for(i=0; i<n; i++) {
+int horus_find_uw(struct horus *hstates, int n) {
+    int errors, mx, mx_ind;
+    
+    /* look for UW, the +/-1 correlation is the number of matching bits
+       less the number of bit errors */
 
-        /* calculate correlation between bit stream and UW */
-        
-        corr = 0;
-        for(j=0; j<hstates->uw_len; j++) {
-            corr += rx_bits_mapped[i+j]*hstates->uw[j];
-        }
-        
-        /* peak pick maximum */
-        
-        if (corr > mx) {
-            mx = corr;
-            mx_ind = i;
-        }
+    mx_ind = uw_search_best(&hstates->uw, horus_rx_window(hstates), n, 1, &errors);
+    mx = hstates->uw_len - 2*errors;
+    if (mx <= 0) {
+        mx = 0; mx_ind = 0;
     }
 
     if (hstates->verbose) {
@@ -201,7 +200,7 @@ int extract_horus_rtty(struct horus *hstates, char ascii_out[], int uw_loc) {
     int en = hstates->max_packet_len - nfield;          /* last bit of max length packet  */
 
     int      i, j, endpacket, nout, crc_ok;
-    uint8_t  char_dec;
+    uint8_t  char_dec, *rx_bits = horus_rx_window(hstates);
     char    *pout, *ptx_crc;
     uint16_t rx_crc, tx_crc;
 
@@ -213,8 +212,8 @@ int extract_horus_rtty(struct horus *hstates, char ascii_out[], int uw_loc) {
 
         char_dec = 0;
         for(j=0; j<nfield; j++) {
-            assert(hstates->rx_bits[i+j] <= 1);
-            char_dec |= hstates->rx_bits[i+j] * (1<<j);
+            assert(rx_bits[i+j] <= 1);
+            char_dec |= rx_bits[i+j] * (1<<j);
         }
         if (hstates->verbose) {
             fprintf(stderr, "  extract_horus_rtty i: %4d 0x%02x %c ", i, char_dec, char_dec);
@@ -280,32 +279,36 @@ int extract_horus_binary(struct horus *hstates, char hex_out[], int uw_loc) {
     int st = uw_loc;                           /* first bit of first char        */
     int en = uw_loc + hstates->max_packet_len; /* last bit of max length packet  */
 
-    int      j, b, nout;
-    uint8_t  rxpacket[hstates->max_packet_len];
-    uint8_t  rxbyte, *pout;
- 
-    /* convert bits to a packet of bytes */
-    
-    pout = rxpacket; nout = 0;
-    
-    for (b=st; b<en; b+=nfield) {
+    int      j, b, nout = 0;
 
-        /* assemble bytes MSB to LSB */
+    /* the packet is decoded from the soft decisions, the hard decision
+       bytes are only assembled to be printed */
 
-        rxbyte = 0;
-        for(j=0; j<nfield; j++) {
-            assert(hstates->rx_bits[b+j] <= 1);
-            rxbyte <<= 1;
-            rxbyte |= hstates->rx_bits[b+j];
+    if (hstates->verbose) {
+        uint8_t  rxpacket[hstates->max_packet_len];
+        uint8_t  rxbyte, *pout, *rx_bits = horus_rx_window(hstates);
+
+        /* convert bits to a packet of bytes */
+
+        pout = rxpacket;
+
+        for (b=st; b<en; b+=nfield) {
+
+            /* assemble bytes MSB to LSB */
+
+            rxbyte = 0;
+            for(j=0; j<nfield; j++) {
+                assert(rx_bits[b+j] <= 1);
+                rxbyte <<= 1;
+                rxbyte |= rx_bits[b+j];
+            }
+
+            /* build up output array */
+
+            *pout++ = rxbyte;
+            nout++;
         }
-        
-        /* build up output array */
-        
-        *pout++ = rxbyte;
-        nout++;
-    }
 
-    if (hstates->verbose) {
         fprintf(stderr, "  extract_horus_binary nout: %d\n  Received Packet before decoding:\n  ", nout);
         for (b=0; b<nout; b++) {
             fprintf(stderr, "%02X", rxpacket[b]);
@@ -314,7 +317,8 @@ int extract_horus_binary(struct horus *hstates, char hex_out[], int uw_loc) {
     }
     
     uint8_t payload_bytes[HORUS_BINARY_NUM_PAYLOAD_BYTES];
-    horus_l2_decode_rx_packet(payload_bytes, rxpacket, HORUS_BINARY_NUM_PAYLOAD_BYTES);
+    horus_l2_decode_rx_packet_soft(payload_bytes, &hstates->rx_sd[hstates->rx_bits_head + uw_loc],
+                                   HORUS_BINARY_NUM_PAYLOAD_BYTES);
 
     uint16_t crc_tx, crc_rx;
     crc_rx = horus_l2_gen_crc16(payload_bytes, HORUS_BINARY_NUM_PAYLOAD_BYTES-2);
@@ -349,7 +353,7 @@ int extract_horus_binary(struct horus *hstates, char hex_out[], int uw_loc) {
 
 
 int horus_rx(struct horus *hstates, char ascii_out[], short demod_in[]) {
-    int i, j, uw_loc, packet_detected;
+    int i, uw_loc, packet_detected;
     
     assert(hstates != NULL);
     packet_detected = 0;
@@ -362,13 +366,11 @@ int horus_rx(struct horus *hstates, char ascii_out[], short demod_in[]) {
                 hstates->max_packet_len, rx_bits_len, Nbits, hstates->fsk->nin);
     }
     
-    /* shift buffer of bits to make room for new bits */
+    /* demodulate latest bits over the oldest ones, they are contiguous
+       as the ring is written twice */
 
-    for(i=0,j=Nbits; j<rx_bits_len; i++,j++) {
-        hstates->rx_bits[i] = hstates->rx_bits[j];
-    }
-                   
-    /* demodulate latest bits */
+    uint8_t *new_bits = &hstates->rx_bits[hstates->rx_bits_head];
+    float   *new_sd = NULL;
 
     /* Note: allocating this array as an automatic variable caused OSX to
        "Bus Error 10" (segfault), so lets malloc() it.  TODO: A real
@@ -380,8 +382,27 @@ int horus_rx(struct horus *hstates, char ascii_out[], short demod_in[]) {
         demod_in_comp[i].real = demod_in[i];
         demod_in_comp[i].imag = 0;
     }
-    fsk_demod(hstates->fsk, &hstates->rx_bits[rx_bits_len-Nbits], demod_in_comp);
+    if (hstates->rx_sd != NULL) {
+        new_sd = &hstates->rx_sd[hstates->rx_bits_head];
+        fsk_demod_bits_sd(hstates->fsk, new_bits, new_sd, demod_in_comp);
+    }
+    else {
+        fsk_demod(hstates->fsk, new_bits, demod_in_comp);
+    }
     free(demod_in_comp);
+
+    /* copy them to the other half of the ring, then they are the newest */
+
+    for (i=0; i<Nbits; i++) {
+        int k = hstates->rx_bits_head + i;
+        k = (k < rx_bits_len) ? k + rx_bits_len : k - rx_bits_len;
+        hstates->rx_bits[k] = new_bits[i];
+        if (new_sd != NULL)
+            hstates->rx_sd[k] = new_sd[i];
+    }
+    hstates->rx_bits_head += Nbits;
+    if (hstates->rx_bits_head >= rx_bits_len)
+        hstates->rx_bits_head -= rx_bits_len;
     
     /* UW search to see if we can find the start of a packet in the buffer */
     
@@ -403,7 +424,7 @@ int horus_rx(struct horus *hstates, char ascii_out[], short demod_in[]) {
             #ifdef DUMP_BINARY_PACKET
             FILE *f = fopen("packetbits.txt", "wt"); assert(f != NULL);
             for(i=0; i<hstates->max_packet_len; i++) {
-                fprintf(f,"%d ", hstates->rx_bits[uw_loc+i]);
+                fprintf(f,"%d ", horus_rx_window(hstates)[uw_loc+i]);
             }
             fclose(f);
             exit(0);
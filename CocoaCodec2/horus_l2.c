@@ -65,9 +65,11 @@ static char uw[] = {'$','$'};
 
 #ifdef INTERLEAVER
 static void interleave(unsigned char *inout, int nbytes, int dir);
+static void deinterleave_soft(float *inout, int nbits);
 #endif
 #ifdef SCRAMBLER
 static void scramble(unsigned char *inout, int nbytes);
+static void scramble_soft(float *inout, int nbits);
 #endif
 
 /* Functions ----------------------------------------------------------*/
@@ -111,151 +113,92 @@ void horus_l2_init(void) {
 }
 
 /*
-  Takes an array of payload data bytes, prepends a unique word and appends
-  parity bits.
-
-  The encoder will run on the payload on a small 8-bit uC.  As we are
-  memory constrained so we do a lot of burrowing for bits out of
-  packed arrays, and don't use a LUT for Golay encoding.  Hopefully it
-  will run fast enough.  This was quite difficult to get going,
-  suspect there is a better way to write this.  Oh well, have to start
-  somewhere.
+  Bits are moved between the packed arrays in groups of up to 12 with
+  a small accumulator, MSB first, rather than one at a time.  The
+  encoder may run on a small 8-bit uC, so it still doesn't use a LUT
+  for Golay encoding.
  */
 
+struct horus_l2_bits {
+    unsigned char *p;       /* next byte to read or write */
+    uint32_t       acc;     /* bits not yet read or written, LSB aligned */
+    int            nacc;    /* number of bits in acc */
+};
+
+static void bits_init(struct horus_l2_bits *b, unsigned char *p) {
+    b->p = p; b->acc = 0; b->nacc = 0;
+}
+
+/* read n <= 16 bits, first bit read is the MSB of the result */
+
+static uint32_t bits_read(struct horus_l2_bits *b, int n) {
+    while (b->nacc < n) {
+        b->acc = (b->acc << 8) | *b->p++;
+        b->nacc += 8;
+    }
+    b->nacc -= n;
+    return (b->acc >> b->nacc) & ((1UL << n) - 1);
+}
+
+/* write the n <= 16 LSBs of x, MSB first */
+
+static void bits_write(struct horus_l2_bits *b, uint32_t x, int n) {
+    b->acc = (b->acc << n) | (x & ((1UL << n) - 1));
+    b->nacc += n;
+    while (b->nacc >= 8) {
+        b->nacc -= 8;
+        *b->p++ = (unsigned char)(b->acc >> b->nacc);
+    }
+}
+
+/* write any partial byte, padded with zeros in the LS bits */
+
+static void bits_flush(struct horus_l2_bits *b) {
+    if (b->nacc)
+        bits_write(b, 0, 8 - b->nacc);
+}
+
 int horus_l2_encode_tx_packet(unsigned char *output_tx_data,
                               unsigned char *input_payload_data,
                               int            num_payload_data_bytes)
 {
-    int            num_tx_data_bytes, num_payload_data_bits;
-    unsigned char *pout = output_tx_data;
-    int            ninbit, ningolay, nparitybits;
-    int32_t        ingolay, paritybyte, inbit, golayparity;
-    int            ninbyte, shift, golayparitybit, i;
+    int                  num_tx_data_bytes, num_payload_data_bits;
+    unsigned char       *pout = output_tx_data;
+    struct horus_l2_bits in, parity;
+    int32_t              ingolay, golayparity;
+    int                  ninbit, n;
 
     num_tx_data_bytes = horus_l2_get_num_tx_data_bytes(num_payload_data_bytes);
     #warning is the data block at pout really large enough to hold 2 bytes more than the data bytes ?
     memcpy(pout, uw, sizeof(uw)); pout += sizeof(uw);
     memcpy(pout, input_payload_data, num_payload_data_bytes); pout += num_payload_data_bytes;
 
-    /* Read input bits one at a time.  Fill input Golay codeword.  Find output Golay codeword.
-       Write this to parity bits.  Write parity bytes when we have 8 parity bits.  Bits are
-       written MSB first. */
+    /* Golay encode each 12 data bits and write the 11 parity bits after
+       the payload.  A final short codeword has its data bits shifted up
+       one more place. */
 
     num_payload_data_bits = num_payload_data_bytes*8;
-    ninbit = 0;
-    ingolay = 0;
-    ningolay = 0;
-    paritybyte = 0;
-    nparitybits = 0;
-
-    while (ninbit < num_payload_data_bits) {
-
-        /* extract input data bit */
-
-        ninbyte = ninbit/8;
-        shift = 7 - (ninbit % 8);
-        inbit = (input_payload_data[ninbyte] >> shift) & 0x1;
-        #ifdef DEBUG1
-        fprintf(stderr, "inbit %d ninbyte: %d inbyte: 0x%02x inbit: %d\n", 
-                ninbit, ninbyte, input_payload_data[ninbyte], inbit);
-        #endif
-        ninbit++;
-
-        /* build up input golay codeword */
-
-        ingolay = ingolay | inbit;
-        ningolay++;
-
-        /* when we get 12 bits do a Golay encode */
-
-        if (ningolay % 12) {
-            ingolay <<= 1;
-        }
-        else {
-            #ifdef DEBUG0
-            fprintf(stderr, "  ningolay: %d ingolay: 0x%04x\n", ningolay, ingolay);
-            #endif
+    bits_init(&in, input_payload_data);
+    bits_init(&parity, pout);
+
+    for(ninbit=0; ninbit<num_payload_data_bits; ninbit+=n) {
+        n = num_payload_data_bits - ninbit;
+        if (n >= 12) {
+            n = 12;
+            ingolay = bits_read(&in, 12);
             golayparity = golay23_syndrome(ingolay<<11);
-            ingolay = 0;
-
-            #ifdef DEBUG0
-            fprintf(stderr, "  golayparity: 0x%04x\n", golayparity);
-            #endif
-
-            /* write parity bits to output data */
-
-            for (i=0; i<11; i++) {
-                golayparitybit = (golayparity >> (10-i)) & 0x1;
-                paritybyte = paritybyte | golayparitybit;
-                #ifdef DEBUG0
-                fprintf(stderr, "    i: %d golayparitybit: %d paritybyte: 0x%02x\n", 
-                        i, golayparitybit, paritybyte);
-                #endif
-                nparitybits++;
-                if (nparitybits % 8) {
-                   paritybyte <<= 1;
-                }
-                else {
-                    /* OK we have a full byte ready */
-                    *pout = paritybyte;
-                    #ifdef DEBUG0
-                    fprintf(stderr,"      Write paritybyte: 0x%02x\n", paritybyte);
-                    #endif
-                    pout++;
-                    paritybyte = 0;
-                }
-            }
         }
-    } /* while(.... */
-
-
-    /* Complete final Golay encode, we may have partially finished ingolay, paritybyte */
-
-    #ifdef DEBUG0
-    fprintf(stderr, "finishing up .....\n");
-    #endif
-
-    if (ningolay % 12) {
-        ingolay >>= 1;
-        golayparity = golay23_syndrome(ingolay<<12);
-        #ifdef DEBUG0
-        fprintf(stderr, "  ningolay: %d ingolay: 0x%04x\n", ningolay, ingolay);
-        fprintf(stderr, "  golayparity: 0x%04x\n", golayparity);
-        #endif
-
-        /* write parity bits to output data */
-
-        for (i=0; i<11; i++) {
-            golayparitybit = (golayparity >> (10 - i)) & 0x1;
-            paritybyte = paritybyte | golayparitybit;
-            #ifdef DEBUG1
-            fprintf(stderr, "    i: %d golayparitybit: %d paritybyte: 0x%02x\n", 
-                    i, golayparitybit, paritybyte);
-            #endif
-            nparitybits++;
-            if (nparitybits % 8) {
-                paritybyte <<= 1;
-            }
-            else {
-                /* OK we have a full byte ready */
-                *pout++ = (unsigned char)paritybyte;
-                #ifdef DEBUG0
-                fprintf(stderr,"      Write paritybyte: 0x%02x\n", paritybyte);
-                #endif
-                paritybyte = 0;
-            }
+        else {
+            ingolay = bits_read(&in, n);
+            golayparity = golay23_syndrome(ingolay<<12);
         }
-    }
- 
-    /* and final, partially complete, parity byte */
-
-    if (nparitybits % 8) {
-        paritybyte <<= 7 - (nparitybits % 8);  // use MS bits first
-        *pout++ = (unsigned char)paritybyte;
         #ifdef DEBUG0
-        fprintf(stderr,"      Write last paritybyte: 0x%02x nparitybits: %d \n", paritybyte, nparitybits);
+        fprintf(stderr, "  ingolay: 0x%04x golayparity: 0x%04x\n", ingolay, golayparity);
         #endif
+        bits_write(&parity, golayparity, 11);
     }
+    bits_flush(&parity);
+    pout = parity.p;
 
     #ifdef DEBUG0
     fprintf(stderr, "\npout - output_tx_data: %ld num_tx_data_bytes: %d\n",
@@ -285,11 +228,9 @@ void horus_l2_decode_rx_packet(unsigned char *output_payload_data,
                                unsigned char *input_rx_data,
                                int            num_payload_data_bytes)
 {
-    int            num_payload_data_bits;
-    unsigned char *pout = output_payload_data;
-    unsigned char *pin  = input_rx_data;
-    int            ninbit, ingolay, ningolay, paritybyte, nparitybits;
-    int            ninbyte, shift, inbit, golayparitybit, i, outbit, outbyte, noutbits, outdata;
+    int                  num_payload_data_bits;
+    struct horus_l2_bits in, parity, out;
+    int                  ninbit, n, ingolay, golayparity, outdata;
     #if defined(SCRAMBLER) || defined(INTERLEAVER)
     int num_tx_data_bytes = horus_l2_get_num_tx_data_bytes(num_payload_data_bytes);
     #endif
@@ -304,165 +245,126 @@ void horus_l2_decode_rx_packet(unsigned char *output_payload_data,
     interleave(&input_rx_data[sizeof(uw)], num_tx_data_bytes-2, 1);
     #endif
 
-    pin = input_rx_data + sizeof(uw) + num_payload_data_bytes;
-
-    /* Read input data bits one at a time.  When we have 12 read 11 parity bits. Golay decode.
-       Write decoded (output data) bits every time we have 8 of them. */
+    /* Read 12 data bits and their 11 parity bits, Golay decode, write the
+       corrected data bits.  The final codeword may be short, see
+       horus_l2_encode_tx_packet(). */
 
     num_payload_data_bits = num_payload_data_bytes*8;
-    ninbit = 0;
-    ingolay = 0;
-    ningolay = 0;
-    nparitybits = 0;
-    paritybyte = *pin++;
+    bits_init(&in, input_rx_data + sizeof(uw));
+    bits_init(&parity, input_rx_data + sizeof(uw) + num_payload_data_bytes);
+    bits_init(&out, output_payload_data);
+
+    for(ninbit=0; ninbit<num_payload_data_bits; ninbit+=n) {
+        n = num_payload_data_bits - ninbit;
+        if (n > 12)
+            n = 12;
+        ingolay = bits_read(&in, n);
+        golayparity = bits_read(&parity, 11);
+        if (n == 12) {
+            outdata = golay23_decode((ingolay<<11) | golayparity) >> 11;
+        }
+        else {
+            outdata = golay23_decode((ingolay<<12) | golayparity) >> 12;
+        }
+        #ifdef DEBUG0
+        fprintf(stderr, "  golay code word: 0x%04x outdata: 0x%04x\n", ingolay, outdata);
+        #endif
+        bits_write(&out, outdata, n);
+    }
+
     #ifdef DEBUG0
-    fprintf(stderr,"  Read paritybyte: 0x%02x\n", paritybyte);
+    fprintf(stderr, "\npin - output_payload_data: %ld num_payload_data_bytes: %d\n",
+            out.p - output_payload_data, num_payload_data_bytes);
     #endif
-    pout = output_payload_data;
-    noutbits = 0;
-    outbyte = 0;
 
-    while (ninbit < num_payload_data_bits) {
+    assert(out.p == (output_payload_data + num_payload_data_bytes));
+
+}
 
-        /* extract input data bit */
+/*
+  Soft decision version of horus_l2_decode_rx_packet().  input_rx_sd[]
+  holds one soft value per bit of the received packet (including the
+  UW) in the order sent, MSB of each byte first, > 0 for a one.  The
+  descrambler and deinterleaver work on the soft values, so the Golay
+  decoder sees the reliability of each bit.
+ */
 
-        ninbyte = ninbit/8 + sizeof(uw);
-        shift = 7 - (ninbit % 8);
-        inbit = (input_rx_data[ninbyte] >> shift) & 0x1;
-        #ifdef DEBUG1
-        fprintf(stderr, "inbit %d ninbyte: %d inbyte: 0x%02x inbit: %d\n", 
-                ninbit, ninbyte, input_rx_data[ninbyte], inbit);
-        #endif
-        ninbit++;
-
-        /* build up golay codeword */
-
-        ingolay = ingolay | inbit;
-        ningolay++;
-        ingolay <<= 1;
-
-        /* when we get 12 data bits start reading parity bits */
-
-        if ((ningolay % 12) == 0) {
-            #ifdef DEBUG0
-            fprintf(stderr, "  ningolay: %d ingolay: 0x%04x\n", ningolay, ingolay>>1);
-            #endif
-            for (i=0; i<11; i++) {
-                shift = 7 - (nparitybits % 8);
-                golayparitybit = (paritybyte >> shift) & 0x1;
-                ingolay |= golayparitybit;
-                if (i != 10)
-                    ingolay <<=1;
-                nparitybits++;
-                if ((nparitybits % 8) == 0) {
-                    /* OK grab a new byte */
-                    paritybyte = *pin++;
-                    #ifdef DEBUG0
-                    fprintf(stderr,"  Read paritybyte: 0x%02x\n", paritybyte);
-                    #endif
-                }
-            }
+/* position of bit i, counted MSB first, when counted LSB first within its byte */
 
-            #ifdef DEBUG0
-            fprintf(stderr, "  golay code word: 0x%04x\n", ingolay);
-            fprintf(stderr, "  golay decode...: 0x%04x\n", golay23_decode(ingolay));
-            #endif
-           
-            /* write decoded/error corrected bits to output payload data */
-
-            outdata = golay23_decode(ingolay) >> 11;
-            #ifdef DEBUG0
-            fprintf(stderr, "  outdata...: 0x%04x\n", outdata);
-            #endif
-
-            for(i=0; i<12; i++) {   
-                shift = 11 - i;
-                outbit = (outdata >> shift) & 0x1;
-                outbyte |= outbit;
-                noutbits++;
-                if (noutbits % 8) {
-                    outbyte <<= 1;
-                }
-                else {
-                    #ifdef DEBUG0
-                    fprintf(stderr, "  output payload byte: 0x%02x\n", outbyte);
-                    #endif
-                    *pout++ = outbyte;
-                    outbyte = 0;
-                }
-            }
+#define HORUS_L2_BIT_LSB(i) (((i) & ~7) + 7 - ((i) & 7))
 
-            ingolay = 0;
-        }
-    } /* while(.... */
+#define HORUS_L2_KNOWN_ZERO (-1E30)
 
+void horus_l2_decode_rx_packet_soft(unsigned char *output_payload_data,
+                                    const float   *input_rx_sd,
+                                    int            num_payload_data_bytes)
+{
+    int            num_tx_data_bytes = horus_l2_get_num_tx_data_bytes(num_payload_data_bytes);
+    int            num_payload_data_bits = num_payload_data_bytes*8;
+    int            nbits = (num_tx_data_bytes - sizeof(uw))*8;
+    const float   *pin = &input_rx_sd[sizeof(uw)*8];
+    unsigned char *pout = output_payload_data;
+    float          sd[nbits], lsb[nbits], codeword[23];
+    int            ninbit, ndata, nparitybits, outdata, outbyte, noutbits, i;
 
-    #ifdef DEBUG0
-    fprintf(stderr, "finishing up .....\n");
+    /* the scrambler and interleaver number bits LSB first within each byte */
+
+    for(i=0; i<nbits; i++)
+        lsb[HORUS_L2_BIT_LSB(i)] = pin[i];
+
+    #ifdef SCRAMBLER
+    scramble_soft(lsb, nbits);
     #endif
 
-    /* Complete final Golay decode  */
-
-    int golayparity = 0;
-    if (ningolay % 12) {
-        for (i=0; i<11; i++) {
-            shift = 7 - (nparitybits % 8);
-            golayparitybit = (paritybyte >> shift) & 0x1;
-            golayparity |= golayparitybit;
-            if (i != 10)
-                golayparity <<=1;
-            nparitybits++;
-            if ((nparitybits % 8) == 0) {
-                /* OK grab a new byte */
-                paritybyte = *pin++;
-                #ifdef DEBUG0
-                fprintf(stderr,"  Read paritybyte: 0x%02x\n", paritybyte);
-                #endif
-            }
+    #ifdef INTERLEAVER
+    deinterleave_soft(lsb, nbits);
+    #endif
+
+    for(i=0; i<nbits; i++)
+        sd[i] = lsb[HORUS_L2_BIT_LSB(i)];
+
+    /* the data bits come first, then 11 parity bits for each 12 data bits */
+
+    nparitybits = num_payload_data_bits;
+    outbyte = 0;
+    noutbits = 0;
+
+    for(ninbit=0; ninbit<num_payload_data_bits; ninbit+=12) {
+        ndata = num_payload_data_bits - ninbit;
+        if (ndata >= 12) {
+            for(i=0; i<12; i++)
+                codeword[i] = sd[ninbit+i];
+            ndata = 12;
         }
+        else {
+            /* the final short codeword has its data bits just above the
+               parity, with a zero between, see horus_l2_encode_tx_packet() */
 
-        ingolay >>= 1;
-        int codeword = (ingolay<<12) + golayparity;
-        #ifdef DEBUG0
-        fprintf(stderr, "  ningolay: %d ingolay: 0x%04x\n", ningolay, ingolay);
-        fprintf(stderr, "  golay code word: 0x%04x\n", codeword);
-        fprintf(stderr, "  golay decode...: 0x%04x\n", golay23_decode(codeword));
-        #endif
+            for(i=0; i<12; i++)
+                codeword[i] = HORUS_L2_KNOWN_ZERO;
+            for(i=0; i<ndata; i++)
+                codeword[11-ndata+i] = sd[ninbit+i];
+        }
+        for(i=0; i<11; i++)
+            codeword[12+i] = sd[nparitybits++];
 
-        outdata = golay23_decode(codeword) >> 11;
-        #ifdef DEBUG0
-        fprintf(stderr, "  outdata...: 0x%04x\n", outdata);
-        fprintf(stderr, "  num_payload_data_bits: %d noutbits: %d\n", num_payload_data_bits, noutbits);
-        #endif
+        outdata = golay23_decode_soft(codeword) >> 11;
+        if (ndata < 12)
+            outdata >>= 1;
 
-        /* write final byte */
+        /* write decoded bits to output payload data */
 
-        int ntogo = num_payload_data_bits - noutbits;
-        for(i=0; i<ntogo; i++) {   
-            shift = ntogo - i;
-            outbit = (outdata >> shift) & 0x1;
-            outbyte |= outbit;
+        for(i=0; i<ndata; i++) {
+            outbyte = (outbyte << 1) | ((outdata >> (ndata-1-i)) & 0x1);
             noutbits++;
-            if (noutbits % 8) {
-                outbyte <<= 1;
-            }
-            else {
-                #ifdef DEBUG0
-                fprintf(stderr, "  output payload byte: 0x%02x\n", outbyte);
-                #endif
+            if ((noutbits % 8) == 0) {
                 *pout++ = outbyte;
                 outbyte = 0;
             }
         }
     }
 
-    #ifdef DEBUG0
-    fprintf(stderr, "\npin - output_payload_data: %ld num_payload_data_bytes: %d\n",
-            pout - output_payload_data, num_payload_data_bytes);
-    #endif
-
     assert(pout == (output_payload_data + num_payload_data_bytes));
-
 }
 #endif
 
@@ -478,57 +380,63 @@ uint16_t primes[] = {
     283,    293,    307,    311,    313,    317,    331,    337,    347
 };
 
-void interleave(unsigned char *inout, int nbytes, int dir)
-{
-    /* note: to work on small uCs (e.g. AVR) needed to declare specific words sizes */
-    uint16_t nbits = (uint16_t)nbytes*8;
-    uint32_t i, j, n, ibit, ibyte, ishift, jbyte, jshift;
-    uint32_t b;
-    unsigned char out[nbytes];
+/* b chosen to be co-prime with nbits, I'm cheating by just finding the 
+   nearest prime to nbits.  It also uses storage, is run on every call,
+   and has an upper limit.  Oh Well, still seems to interleave OK. */
 
-    memset(out, 0, nbytes);
-           
-    /* b chosen to be co-prime with nbits, I'm cheating by just finding the 
-       nearest prime to nbits.  It also uses storage, is run on every call,
-       and has an upper limit.  Oh Well, still seems to interleave OK. */
-    i = 1;
+static uint32_t interleave_prime(uint16_t nbits)
+{
+    uint16_t i = 1;
     uint16_t imax = sizeof(primes)/sizeof(uint16_t);
     while ((primes[i] < nbits) && (i < imax))
         i++;
-    b = primes[i-1];
-
-    for(n=0; n<nbits; n++) {
-
-        /*
-          "On the Analysis and Design of Good Algebraic Interleavers", Xie et al,eq (5)
-        */
+    return primes[i-1];
+}
 
-        i = n;
-        j = (b*i) % nbits; /* note these all need to be 32-bit ints to make multiply work without overflow */
-        
-        if (dir) {
-            uint16_t tmp = j;
-            j = i;
-            i = tmp;
-        }
-        
-        #ifdef DEBUG0
-        printf("i: %d j: %d\n",i, j);
-        #endif
+/*
+  "On the Analysis and Design of Good Algebraic Interleavers", Xie et al,eq (5)
 
-        /* read bit i and write to bit j postion */
+  Bit i moves to bit (b*i) % nbits, bits numbered LSB first within each
+  byte.  The position is stepped by b rather than recomputed, and the
+  de-interleaver gathers whole output bytes at a time.
+*/
 
-        ibyte = i/8;
-        ishift = i%8;
-        ibit = (inout[ibyte] >> ishift) & 0x1;
+void interleave(unsigned char *inout, int nbytes, int dir)
+{
+    /* note: to work on small uCs (e.g. AVR) needed to declare specific words sizes */
+    uint16_t nbits = (uint16_t)nbytes*8;
+    uint32_t i, j, n, b;
+    unsigned char out[nbytes];
+    unsigned char outbyte;
 
-        jbyte = j/8;
-        jshift = j%8;
+    b = interleave_prime(nbits);
 
-        /* write jbit to ibit position */
+    if (dir) {
+        /* output bit n is input bit (b*n) % nbits */
 
-        out[jbyte] |= ibit << jshift; // replace with i-th bit
-        //out[ibyte] |= ibit << ishift; // replace with i-th bit
+        j = 0;
+        for(n=0; n<nbytes; n++) {
+            outbyte = 0;
+            for(i=0; i<8; i++) {
+                outbyte |= ((inout[j >> 3] >> (j & 7)) & 0x1) << i;
+                j += b;
+                if (j >= nbits)
+                    j -= nbits;
+            }
+            out[n] = outbyte;
+        }
+    }
+    else {
+        /* input bit n goes to output bit (b*n) % nbits */
+
+        memset(out, 0, nbytes);
+        j = 0;
+        for(n=0; n<nbits; n++) {
+            out[j >> 3] |= ((inout[n >> 3] >> (n & 7)) & 0x1) << (j & 7);
+            j += b;
+            if (j >= nbits)
+                j -= nbits;
+        }
     }
  
     memcpy(inout, out, nbytes);
@@ -539,6 +447,22 @@ void interleave(unsigned char *inout, int nbytes, int dir)
         printf("%02d 0x%02x\n", i, inout[i]);
     #endif
 }
+
+/* interleave(inout, nbits/8, 1) on soft bits, numbered as in interleave() */
+
+static void deinterleave_soft(float *inout, int nbits)
+{
+    uint32_t n, j, b = interleave_prime(nbits);
+    float    out[nbits];
+
+    for(n=0, j=0; n<nbits; n++) {
+        out[n] = inout[j];
+        j += b;
+        if (j >= nbits)
+            j -= nbits;
+    }
+    memcpy(inout, out, sizeof(float)*nbits);
+}
 #endif
 
 
@@ -577,40 +501,37 @@ int main(void) {
 
 /* 16 bit DVB additive scrambler as per Wikpedia example */
 
+/*
+  The scrambler register holds the next 15 bits of a sequence y[] with
+  y[k+15] = y[k+1] ^ y[k], and the scrambler output is y[k+15].  So the
+  next 14 output bits can be found from the register in one go, and the
+  register then jumps 14 steps.
+*/
+
+static uint32_t scrambler_next14(uint16_t *scrambler)
+{
+    uint32_t out = ((*scrambler >> 1) ^ *scrambler) & 0x3fff;
+    *scrambler = (*scrambler >> 14) | (out << 1);
+    return out;
+}
+
 void scramble(unsigned char *inout, int nbytes)
 {
-    int nbits = nbytes*8;
-    int i, ibit, ibits, ibyte, ishift, mask;
+    int      i;
     uint16_t scrambler = 0x4a80;  /* init additive scrambler at start of every frame */
-    uint16_t scrambler_out;
-
-    /* in place modification of each bit */
-
-    for(i=0; i<nbits; i++) {
-
-        scrambler_out = ((scrambler & 0x2) >> 1) ^ (scrambler & 0x1);
-
-        /* modify i-th bit by xor-ing with scrambler output sequence */
-
-        ibyte = i/8;
-        ishift = i%8;
-        ibit = (inout[ibyte] >> ishift) & 0x1;
-        ibits = ibit ^ scrambler_out;                  // xor ibit with scrambler output
-
-        mask = 1 << ishift;
-        inout[ibyte] &= ~mask;                  // clear i-th bit
-        inout[ibyte] |= ibits << ishift;         // set to scrambled value
-
-        /* update scrambler */
-
-        scrambler >>= 1;
-        scrambler |= scrambler_out << 14;
+    uint32_t scrambler_out = 0;   /* output bits not used yet, next one is the LSB */
+    int      nout = 0;
 
-        #ifdef DEBUG0
-        printf("i: %02d ibyte: %d ishift: %d ibit: %d ibits: %d scrambler_out: %d\n", 
-               i, ibyte, ishift, ibit, ibits, scrambler_out);
-        #endif
+    /* xor each byte with the next 8 scrambler outputs, LSB first */
 
+    for(i=0; i<nbytes; i++) {
+        if (nout < 8) {
+            scrambler_out |= scrambler_next14(&scrambler) << nout;
+            nout += 14;
+        }
+        inout[i] ^= scrambler_out & 0xff;
+        scrambler_out >>= 8;
+        nout -= 8;
     }
 
     #ifdef DEBUG0
@@ -619,6 +540,22 @@ void scramble(unsigned char *inout, int nbytes)
         printf("%02d 0x%02x\n", i, inout[i]);
     #endif
 }
+
+/* scramble() on soft bits, a scrambler output of one flips the sign */
+
+static void scramble_soft(float *inout, int nbits)
+{
+    int      i, j;
+    uint16_t scrambler = 0x4a80;
+    uint32_t scrambler_out;
+
+    for(i=0; i<nbits; i+=14) {
+        scrambler_out = scrambler_next14(&scrambler);
+        for(j=0; (j<14) && (i+j<nbits); j++)
+            if ((scrambler_out >> j) & 0x1)
+                inout[i+j] = -inout[i+j];
+    }
+}
 #endif
 
 #ifdef HORUS_L2_UNITTEST
@@ -25,6 +25,12 @@ void horus_l2_decode_rx_packet(unsigned char *output_payload_data,
                                unsigned char *input_rx_data,
                                int            num_payload_data_bytes);
 
+/* as above, from soft decisions of each received bit, > 0 for a one */
+
+void horus_l2_decode_rx_packet_soft(unsigned char *output_payload_data,
+                                    const float   *input_rx_sd,
+                                    int            num_payload_data_bytes);
+
 unsigned short horus_l2_gen_crc16(unsigned char* data_p, unsigned char length);
 
 #endif
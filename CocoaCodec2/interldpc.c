@@ -60,6 +60,7 @@ void printf_n(COMP v[], int n) {
 
 void set_up_hra_112_112(struct LDPC *ldpc, struct OFDM_CONFIG *config) {
     ldpc->max_iter = HRA_112_112_MAX_ITER;
+    ldpc->budget = NULL;
     ldpc->dec_type = 0;
     ldpc->q_scale_factor = 1;
     ldpc->r_scale_factor = 1;
@@ -70,6 +71,7 @@ void set_up_hra_112_112(struct LDPC *ldpc, struct OFDM_CONFIG *config) {
     ldpc->max_col_weight = HRA_112_112_MAX_COL_WEIGHT;
     ldpc->H_rows = HRA_112_112_H_rows;
     ldpc->H_cols = HRA_112_112_H_cols;
+    ldpc->enc = NULL;
 
     /* provided for convenience and to match Octave vaiable names */
     
@@ -78,10 +80,34 @@ void set_up_hra_112_112(struct LDPC *ldpc, struct OFDM_CONFIG *config) {
     ldpc->coded_syms_per_frame = ldpc->coded_bits_per_frame/config->bps;
 }
 
+/* one bit per byte to packed MSB first, a byte at a time */
+
+static void pack_bits_msb(uint8_t packed[], const uint8_t bits[], int nbits) {
+    int i, j, byte;
+
+    for(i=0; i<nbits; i+=8) {
+        byte = 0;
+        for(j=0; j<8; j++)
+            byte = (byte << 1) | ((i+j < nbits) ? (bits[i+j] & 1) : 0);
+        packed[i >> 3] = byte;
+    }
+}
+
 void ldpc_encode_frame(struct LDPC *ldpc, int codeword[], unsigned char tx_bits_char[]) {
     unsigned char pbits[ldpc->NumberParityBits];
     int           i,j;
-    
+
+    if (ldpc->enc) {
+        uint8_t data[(ldpc->data_bits_per_frame + 7)/8];
+        uint8_t packed[(ldpc->coded_bits_per_frame + 7)/8];
+
+        pack_bits_msb(data, tx_bits_char, ldpc->data_bits_per_frame);
+        ldpc_enc_packed(ldpc->enc, packed, data, 1);
+        for(i=0; i<ldpc->coded_bits_per_frame; i++)
+            codeword[i] = (packed[i >> 3] >> (7 - (i & 7))) & 1;
+        return;
+    }
+
     encode(ldpc, tx_bits_char, pbits);
     for(i=0; i<ldpc->data_bits_per_frame; i++) {
         codeword[i] = tx_bits_char[i];
@@ -91,6 +117,53 @@ void ldpc_encode_frame(struct LDPC *ldpc, int codeword[], unsigned char tx_bits_
     }
 }
 
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: ldpc_encode_frames_qpsk
+  DATE CREATED: October 2026
+
+  Encodes nframes frames of tx_bits[] (one bit per byte) and writes the
+  QPSK symbols of the codewords straight out, as ldpc_encode_frame() then
+  qpsk_modulate_frame().  With scatter[] symbol i goes to
+  tx_symbols[scatter[i]], e.g. the perm[] of a GP_INTERLEAVER to
+  interleave as we go.  Needs ldpc->enc.
+
+\*---------------------------------------------------------------------------*/
+
+void ldpc_encode_frames_qpsk(struct LDPC *ldpc, COMP tx_symbols[], uint8_t tx_bits[], int nframes,
+                             const uint16_t scatter[]) {
+    int     data_bits = ldpc->data_bits_per_frame;
+    int     code_bits = ldpc->coded_bits_per_frame;
+    uint8_t data[(data_bits + 7)/8];
+    uint8_t packed[(code_bits + 7)/8];
+    COMP    points[4];
+    int     dibit[2], d, f, i, s, n;
+    complex float qpsk_symb;
+
+    assert(ldpc->enc != NULL);
+    assert((code_bits & 1) == 0);
+
+    /* symbol for each pair of codeword bits, first bit MSB */
+
+    for(d=0; d<4; d++) {
+        dibit[0] = d & 1;
+        dibit[1] = d >> 1;
+        qpsk_symb = qpsk_mod(dibit);
+        points[d].real = crealf(qpsk_symb);
+        points[d].imag = cimagf(qpsk_symb);
+    }
+
+    n = 0;
+    for(f=0; f<nframes; f++) {
+        pack_bits_msb(data, &tx_bits[f*data_bits], data_bits);
+        ldpc_enc_packed(ldpc->enc, packed, data, 1);
+        for(i=0; i<code_bits; i+=2, n++) {
+            s = (packed[i >> 3] >> (6 - (i & 6))) & 3;
+            tx_symbols[scatter ? scatter[n] : n] = points[s];
+        }
+    }
+}
+
 void qpsk_modulate_frame(COMP tx_symbols[], int codeword[], int n) {
     int s,i;
     int dibit[2];
@@ -108,8 +181,9 @@ void qpsk_modulate_frame(COMP tx_symbols[], int codeword[], int n) {
 void interleaver_sync_state_machine(struct OFDM *ofdm,
                                     struct LDPC *ldpc,
                                     struct OFDM_CONFIG *config,
-                                    COMP codeword_symbols_de[],
-                                    float codeword_amps_de[],
+                                    COMP codeword_symbols[],
+                                    float codeword_amps[],
+                                    struct GP_INTERLEAVER *gp,
                                     float EsNo, int interleave_frames,
                                     int *iter, int *parityCheckCount, int *Nerrs_coded)
 {
@@ -123,7 +197,9 @@ void interleaver_sync_state_machine(struct OFDM *ofdm,
     strncpy(next_sync_state_interleaver, ofdm->sync_state_interleaver, config->state_str);
 
     if ((strcmp(ofdm->sync_state_interleaver,"search") == 0) && (ofdm->frame_count >= (interleave_frames-1))) {
-        symbols_to_llrs(llr, codeword_symbols_de, codeword_amps_de, EsNo, ofdm->mean_amp, coded_syms_per_frame);               
+        /* try the first frame, de-interleaving as we go */
+
+        symbols_to_llrs_gather(llr, codeword_symbols, codeword_amps, gp->perm, EsNo, ofdm->mean_amp, coded_syms_per_frame);
         iter[0] =  run_ldpc_decoder(ldpc, out_char, llr, parityCheckCount);
         Nerrs_coded[0] = data_bits_per_frame - parityCheckCount[0];
 
@@ -244,6 +320,14 @@ void build_modulated_uw(struct OFDM *ofdm, complex float tx_symbols[], uint8_t t
 */
 
 void ofdm_ldpc_interleave_tx(struct OFDM *ofdm, struct LDPC *ldpc, complex float tx_sams[], uint8_t tx_bits[], uint8_t txt_bits[], int interleave_frames, struct OFDM_CONFIG *config)
+{
+    ofdm_ldpc_interleave_tx_gp(ofdm, ldpc, NULL, tx_sams, tx_bits, txt_bits, interleave_frames, config);
+}
+
+/* As ofdm_ldpc_interleave_tx(), gp (may be NULL) interleaves the symbols as they are modulated */
+
+void ofdm_ldpc_interleave_tx_gp(struct OFDM *ofdm, struct LDPC *ldpc, struct GP_INTERLEAVER *gp, complex float tx_sams[],
+                                uint8_t tx_bits[], uint8_t txt_bits[], int interleave_frames, struct OFDM_CONFIG *config)
 {
     int coded_syms_per_frame = ldpc->coded_syms_per_frame;
     int coded_bits_per_frame = ldpc->coded_bits_per_frame;
@@ -256,12 +340,22 @@ void ofdm_ldpc_interleave_tx(struct OFDM *ofdm, struct LDPC *ldpc, complex float
     int Nsamperframe = ofdm_get_samples_per_frame();
     complex float tx_symbols[ofdm_bitsperframe/config->bps];
     int j;
-    
-    for (j=0; j<interleave_frames; j++) {
-        ldpc_encode_frame(ldpc, codeword, &tx_bits[j*data_bits_per_frame]);
-        qpsk_modulate_frame(&coded_symbols[j*coded_syms_per_frame], codeword, coded_syms_per_frame);
+
+    if (ldpc->enc && gp) {
+        assert(gp->Nbits == interleave_frames*coded_syms_per_frame);
+        ldpc_encode_frames_qpsk(ldpc, coded_symbols_inter, tx_bits, interleave_frames, gp->perm);
+    }
+    else {
+        if (ldpc->enc)
+            ldpc_encode_frames_qpsk(ldpc, coded_symbols, tx_bits, interleave_frames, NULL);
+        else {
+            for (j=0; j<interleave_frames; j++) {
+                ldpc_encode_frame(ldpc, codeword, &tx_bits[j*data_bits_per_frame]);
+                qpsk_modulate_frame(&coded_symbols[j*coded_syms_per_frame], codeword, coded_syms_per_frame);
+            }
+        }
+        gp_interleave_comp(coded_symbols_inter, coded_symbols, interleave_frames*coded_syms_per_frame);
     }
-    gp_interleave_comp(coded_symbols_inter, coded_symbols, interleave_frames*coded_syms_per_frame);
     for (j=0; j<interleave_frames; j++) {            
         ofdm_assemble_modem_frame_symbols(tx_symbols, &coded_symbols_inter[j*coded_syms_per_frame], &txt_bits[config->txtbits * j]);
         ofdm_txframe(ofdm, &tx_sams[j*Nsamperframe], tx_symbols);
@@ -32,6 +32,7 @@
 #include "comp.h"
 #include "mpdecode_core.h"
 #include "ofdm_internal.h"
+#include "gp_interleaver.h"
 
 /* CRC type function, used to compare QPSK vectors when debugging */
 
@@ -39,15 +40,20 @@ COMP test_acc(COMP v[], int n);
 void printf_n(COMP v[], int n);
 void set_up_hra_112_112(struct LDPC *ldpc, struct OFDM_CONFIG *);
 void ldpc_encode_frame(struct LDPC *ldpc, int codeword[], unsigned char tx_bits_char[]);
+void ldpc_encode_frames_qpsk(struct LDPC *ldpc, COMP tx_symbols[], uint8_t tx_bits[], int nframes,
+                             const uint16_t scatter[]);
 void qpsk_modulate_frame(COMP tx_symbols[], int codeword[], int n);
 void interleaver_sync_state_machine(struct OFDM *ofdm, struct LDPC *ldpc, struct OFDM_CONFIG *config,
-                                    COMP codeword_symbols_de[],
-                                    float codeword_amps_de[],
+                                    COMP codeword_symbols[],
+                                    float codeword_amps[],
+                                    struct GP_INTERLEAVER *gp,
                                     float EsNo, int interleave_frames,
                                     int *inter, int *parityCheckCount, int *Nerrs_coded);
 int count_uncoded_errors(struct LDPC *ldpc, struct OFDM_CONFIG *config, int Nerrs_raw[], int interleave_frames, COMP codeword_symbols_de[]);
 int count_errors(int tx_bits[], char rx_bits[], int n);
 void ofdm_ldpc_interleave_tx(struct OFDM *ofdm, struct LDPC *ldpc, complex float tx_sams[], uint8_t tx_bits[], uint8_t txt_bits[], int interleave_frames, struct OFDM_CONFIG *config);
+void ofdm_ldpc_interleave_tx_gp(struct OFDM *ofdm, struct LDPC *ldpc, struct GP_INTERLEAVER *gp, complex float tx_sams[],
+                                uint8_t tx_bits[], uint8_t txt_bits[], int interleave_frames, struct OFDM_CONFIG *config);
 void build_modulated_uw(struct OFDM *ofdm, complex float tx_symbols[], uint8_t txt_bits[], struct OFDM_CONFIG *config);
 
 #endif
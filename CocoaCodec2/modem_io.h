@@ -0,0 +1,107 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: modem_io.h
+  DATE CREATED: October 2026
+
+  Describes a buffer of modem samples in the caller's own format, so a
+  modem can read its input, or write its output, in the first or last
+  stage of processing rather than going through a converted copy.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License version 2.1, as
+  published by the Free Software Foundation.  This program is
+  distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __MODEM_IO__
+#define __MODEM_IO__
+
+#include "comp.h"
+
+#define MODEM_IO_SHORT     0   /* int16 real                          */
+#define MODEM_IO_FLOAT     1   /* float real                          */
+#define MODEM_IO_FLOAT_IQ  2   /* float I,Q interleaved, same as COMP */
+#define MODEM_IO_SHORT_IQ  3   /* int16 I,Q interleaved               */
+
+struct MODEM_IO {
+    int   format;              /* one of MODEM_IO_xxx                            */
+    float scale;               /* modem sample = buffer sample * scale on input, */
+                               /* buffer sample = modem sample * scale on output */
+};
+
+/* the format of COMP buffers, as passed to the original API functions */
+
+static const struct MODEM_IO modem_io_comp = { MODEM_IO_FLOAT_IQ, 1.0 };
+
+/* bytes per sample in buf */
+
+static inline int modem_io_size(const struct MODEM_IO *io) {
+    switch(io->format) {
+    case MODEM_IO_SHORT:    return sizeof(short);
+    case MODEM_IO_FLOAT:    return sizeof(float);
+    case MODEM_IO_SHORT_IQ: return 2*sizeof(short);
+    default:                return sizeof(COMP);
+    }
+}
+
+/* sample i of buf, scaled */
+
+static inline COMP modem_io_get(const struct MODEM_IO *io, const void *buf, int i) {
+    COMP x;
+
+    switch(io->format) {
+    case MODEM_IO_SHORT:
+        x.real = ((const short *)buf)[i];
+        x.imag = 0.0;
+        break;
+    case MODEM_IO_FLOAT:
+        x.real = ((const float *)buf)[i];
+        x.imag = 0.0;
+        break;
+    case MODEM_IO_SHORT_IQ:
+        x.real = ((const short *)buf)[2*i];
+        x.imag = ((const short *)buf)[2*i+1];
+        break;
+    default:
+        x = ((const COMP *)buf)[i];
+        break;
+    }
+    x.real *= io->scale;
+    x.imag *= io->scale;
+
+    return x;
+}
+
+/* scales x and stores it as sample i of buf, the real formats drop x.imag */
+
+static inline void modem_io_put(const struct MODEM_IO *io, void *buf, int i, COMP x) {
+    x.real *= io->scale;
+    x.imag *= io->scale;
+
+    switch(io->format) {
+    case MODEM_IO_SHORT:
+        ((short *)buf)[i] = x.real;
+        break;
+    case MODEM_IO_FLOAT:
+        ((float *)buf)[i] = x.real;
+        break;
+    case MODEM_IO_SHORT_IQ:
+        ((short *)buf)[2*i] = x.real;
+        ((short *)buf)[2*i+1] = x.imag;
+        break;
+    default:
+        ((COMP *)buf)[i] = x;
+        break;
+    }
+}
+
+#endif
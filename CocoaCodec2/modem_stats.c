@@ -29,6 +29,7 @@
 #include <math.h>
 #include "modem_stats.h"
 #include "codec2_fdmdv.h"
+#include "filter.h"
 
 void modem_stats_open(struct MODEM_STATS *f)
 {
@@ -40,8 +41,9 @@ void modem_stats_open(struct MODEM_STATS *f)
 
     /* init the FFT */
     
-    for(i=0; i<2*MODEM_STATS_NSPEC; i++)
+    for(i=0; i<4*MODEM_STATS_NSPEC; i++)
 	f->fft_buf[i] = 0.0;
+    f->fft_buf_index = 0;
     f->fft_cfg = kiss_fft_alloc (2*MODEM_STATS_NSPEC, 0, NULL, NULL);
     assert(f->fft_cfg != NULL);
 
@@ -83,23 +85,25 @@ void modem_stats_close(struct MODEM_STATS *f)
 
 void modem_stats_get_rx_spectrum(struct MODEM_STATS *f, float mag_spec_dB[], COMP rx_fdm[], int nin)
 {
-    int   i,j;
+    int   i;
     COMP  fft_in[2*MODEM_STATS_NSPEC];
     COMP  fft_out[2*MODEM_STATS_NSPEC];
+    float rx_real[2*MODEM_STATS_NSPEC];
+    float *fft_buf;
     float full_scale_dB;
 
     /* update buffer of input samples */
 
-    for(i=0; i<2*MODEM_STATS_NSPEC-nin; i++)
-	f->fft_buf[i] = f->fft_buf[i+nin];
-    for(j=0; j<nin; j++,i++)
-	f->fft_buf[i] = rx_fdm[j].real;
-    assert(i == 2*MODEM_STATS_NSPEC);
+    assert(nin <= 2*MODEM_STATS_NSPEC);
+    for(i=0; i<nin; i++)
+	rx_real[i] = rx_fdm[i].real;
+    quisk_fDelayPut(f->fft_buf, 2*MODEM_STATS_NSPEC, &f->fft_buf_index, rx_real, nin);
+    fft_buf = &f->fft_buf[f->fft_buf_index];
 
     /* window and FFT */
 
     for(i=0; i<2*MODEM_STATS_NSPEC; i++) {
-	fft_in[i].real = f->fft_buf[i] * (0.5 - 0.5*cosf((float)i*2.0*M_PI/(2*MODEM_STATS_NSPEC)));
+	fft_in[i].real = fft_buf[i] * (0.5 - 0.5*cosf((float)i*2.0*M_PI/(2*MODEM_STATS_NSPEC)));
 	fft_in[i].imag = 0.0;
     }
 
@@ -67,7 +67,8 @@ struct MODEM_STATS {
     
     /* Buf for FFT/waterfall */
 
-    float        fft_buf[2*MODEM_STATS_NSPEC];
+    float        fft_buf[4*MODEM_STATS_NSPEC];   /* double-length delay line of 2*MODEM_STATS_NSPEC */
+    int          fft_buf_index;                  /* position of the oldest sample in fft_buf        */
     kiss_fft_cfg fft_cfg;
 };
 
@@ -15,8 +15,12 @@
 
 #include "comp.h"
 
+struct LDPC_BUDGET;
+struct LDPC_ENC;
+
 struct LDPC {
-    int max_iter;
+    int max_iter;                   /* iteration cap for each decode          */
+    struct LDPC_BUDGET *budget;     /* shared iteration budget, may be NULL   */
     int dec_type;
     int q_scale_factor;
     int r_scale_factor;
@@ -30,17 +34,66 @@ struct LDPC {
     int coded_syms_per_frame;
     uint16_t *H_rows;
     uint16_t *H_cols;
+    struct LDPC_ENC *enc;           /* packed encoder, may be NULL            */
 };
 
 void encode(struct LDPC *ldpc, unsigned char ibits[], unsigned char pbits[]);
 
+/*
+ * Bit packed systematic encoder, gives the same codewords as encode().
+ * Bits are packed MSB first.  ldpc_enc_packed() encodes nframes frames
+ * of data, each padded to whole bytes, into codewords of data then
+ * parity bits, also padded to whole bytes.
+ */
+struct LDPC_ENC *ldpc_enc_create(struct LDPC *ldpc);
+void ldpc_enc_destroy(struct LDPC_ENC *enc);
+void ldpc_enc_packed(struct LDPC_ENC *enc, uint8_t codeword[], const uint8_t data[], int nframes);
+int  ldpc_enc_data_bits(struct LDPC_ENC *enc);
+int  ldpc_enc_code_bits(struct LDPC_ENC *enc);
+
+/* Parity of one frame, MSB first in (NumberParityBits+63)/64 words */
+void ldpc_enc_parity(struct LDPC_ENC *enc, uint64_t parity[], const uint8_t data[]);
+
 int run_ldpc_decoder(struct LDPC *ldpc, char out_char[], float input[], int *parityCheckCount);
 
+/* what a decode did */
+
+struct LDPC_STATS {
+    int iter;               /* iterations used, 0 if the input was already a codeword */
+    int max_iter;           /* iterations allowed, after any budget limit             */
+    int unsatisfied;        /* parity checks the decoded bits don't satisfy           */
+};
+
+/* As run_ldpc_decoder(), returns the number of iterations */
+int run_ldpc_decoder_stats(struct LDPC *ldpc, char out_char[], float input[], struct LDPC_STATS *stats);
+
+/*
+ * An iteration budget shared by several decoders, e.g. all the channels
+ * of a server, and safe to use from several threads.  The caller adds
+ * iterations as real time passes, at most max_bank are saved up.  Each
+ * decode then runs no more iterations than are left, but always at
+ * least min_iter, so decoding degrades gracefully under load.
+ */
+struct LDPC_BUDGET *ldpc_budget_create(int min_iter, long max_bank);
+void ldpc_budget_destroy(struct LDPC_BUDGET *budget);
+void ldpc_budget_add(struct LDPC_BUDGET *budget, long iters);
+long ldpc_budget_get(struct LDPC_BUDGET *budget);
+
 void sd_to_llr(float llr[], double sd[], int n);
 void Demod2D(float symbol_likelihood[], COMP r[], COMP S_matrix[], float EsNo, float fading[], float mean_amp, int number_symbols);
 void Somap(float bit_likelihood[], float symbol_likelihood[], int number_symbols);
+
+/* QPSK LLRs straight from the symbols and amplitudes, Demod2D() then Somap() negated */
 void symbols_to_llrs(float llr[], COMP rx_qpsk_symbols[], float rx_amps[], float EsNo, float mean_amp, int nsyms);
 
+/* symbols_to_llrs() on symbol index[i] for i = 0 ... nsyms-1, e.g. to de-interleave as we go */
+void symbols_to_llrs_gather(float llr[], COMP rx_qpsk_symbols[], float rx_amps[], const uint16_t index[],
+                            float EsNo, float mean_amp, int nsyms);
+
+/* Exact LLRs for a constellation of 2^bps points, point i carries bits i MSB first */
+void symbols_to_llrs_mary(float llr[], COMP rx_symbols[], float rx_amps[], COMP constellation[], int bps,
+                          float EsNo, float mean_amp, int nsyms);
+
 void ldpc_print_info(struct LDPC *ldpc);
 
 struct v_node {
@@ -29,6 +29,7 @@
 #include "nlp.h"
 #include "dump.h"
 #include "codec2_fft.h"
+#include "filter.h"
 #undef PROFILE
 #include "machdep.h"
 #include "os.h"
@@ -126,9 +127,9 @@ typedef struct {
     float         w[PMAX_M/DEC];     /* DFT window                   */
     float         sq[PMAX_M];	     /* squared speech samples       */
     float         mem_x,mem_y;       /* memory for notch filter      */
-    float         mem_fir[NLP_NTAP]; /* decimation FIR filter memory */
+    struct quisk_fFilter fir;        /* decimation FIR filter        */
     codec2_fft_cfg  fft_cfg;         /* kiss FFT config              */
-    float        *Sn16k;	     /* Fs=16kHz input speech vector */
+    struct quisk_fFilter os_filt;    /* Fs=16kHz to 8kHz decimator   */
     FILE         *f;
 } NLP;
 
@@ -139,7 +140,6 @@ float post_process_mbe(COMP Fw[], int pmin, int pmax, float gmax, COMP Sw[], COM
 float post_process_sub_multiples(COMP Fw[],
 				 int pmin, int pmax, float gmax, int gmax_bin,
 				 float *prev_f0);
-static void fdmdv_16_to_8(float out8k[], float in16k[], int n);
 
 /*---------------------------------------------------------------------------*\
 
@@ -165,17 +165,13 @@ void *nlp_create(C2CONST *c2const)
 
     nlp->m = m;
 
-    /* if running at 16kHz allocate storage for decimating filter memory */
+    /* if running at 16kHz set up the decimating filter, the same low
+       pass filter as fdmdv_16_to_8().  Its first output is taken on the
+       first input sample, as fdmdv_16_to_8() does. */
 
     if (Fs == 16000) {
-        nlp->Sn16k = (float*)malloc(sizeof(float)*(FDMDV_OS_TAPS_16K + c2const->n_samp));
-        for(i=0; i<FDMDV_OS_TAPS_16K; i++) {
-           nlp->Sn16k[i] = 0.0;
-        }
-        if (nlp->Sn16k == NULL) {
-            free(nlp);
-            return NULL;
-        }
+        quisk_filt_fInit(&nlp->os_filt, fdmdv_os_filter, FDMDV_OS_TAPS_16K);
+        nlp->os_filt.decim_index = FDMDV_OS - 1;
 
         /* most processing occurs at 8 kHz sample rate so halve m */
 
@@ -192,8 +188,7 @@ void *nlp_create(C2CONST *c2const)
 	nlp->sq[i] = 0.0;
     nlp->mem_x = 0.0;
     nlp->mem_y = 0.0;
-    for(i=0; i<NLP_NTAP; i++)
-	nlp->mem_fir[i] = 0.0;
+    quisk_filt_fInit(&nlp->fir, nlp_fir, NLP_NTAP);
 
     nlp->fft_cfg = codec2_fft_alloc (PE_FFT_SIZE, 0, NULL, NULL);
     assert(nlp->fft_cfg != NULL);
@@ -216,8 +211,9 @@ void nlp_destroy(void *nlp_state)
     nlp = (NLP*)nlp_state;
 
     codec2_fft_free(nlp->fft_cfg);
+    quisk_filt_fDestroy(&nlp->fir);
     if (nlp->Fs == 16000) {
-        free(nlp->Sn16k);
+        quisk_filt_fDestroy(&nlp->os_filt);
     }
     free(nlp_state);
 }
@@ -293,15 +289,11 @@ float nlp(
 
         /* re-sample at 8 KHz */
 
-        for(i=0; i<n; i++) {
-            nlp->Sn16k[FDMDV_OS_TAPS_16K+i] = Sn[m-n+i];
-        }
+        float Sn8k[n/2];
+        quisk_fDecim(&Sn[m-n], Sn8k, n, &nlp->os_filt, FDMDV_OS);
 
         m /= 2; n /= 2;
 
-        float Sn8k[n];
-        fdmdv_16_to_8(Sn8k, &nlp->Sn16k[FDMDV_OS_TAPS_16K], n);
-
         /* Square latest input samples */
 
         for(i=m-n, j=0; i<m; i++, j++) {
@@ -330,16 +322,9 @@ float nlp(
 
     PROFILE_SAMPLE_AND_LOG(tnotch, start, "      square and notch");
 
-    for(i=m-n; i<m; i++) {	/* FIR filter vector */
+    /* FIR filter vector */
 
-	for(j=0; j<NLP_NTAP-1; j++)
-	    nlp->mem_fir[j] = nlp->mem_fir[j+1];
-	nlp->mem_fir[NLP_NTAP-1] = nlp->sq[i];
-
-	nlp->sq[i] = 0.0;
-	for(j=0; j<NLP_NTAP; j++)
-	    nlp->sq[i] += nlp->mem_fir[j]*nlp_fir[j];
-    }
+    quisk_fDecim(&nlp->sq[m-n], &nlp->sq[m-n], n, &nlp->fir, 1);
 
     PROFILE_SAMPLE_AND_LOG(filter, tnotch, "      filter");
 
@@ -663,40 +648,3 @@ float test_candidate_mbe(
 
 #endif
 
-/*---------------------------------------------------------------------------*\
-
-  FUNCTION....: fdmdv_16_to_8()
-  AUTHOR......: David Rowe
-  DATE CREATED: 9 May 2012
-
-  Changes the sample rate of a signal from 16 to 8 kHz.
-
-  n is the number of samples at the 8 kHz rate, there are FDMDV_OS*n
-  samples at the 48 kHz rate.  As above however a memory of
-  FDMDV_OS_TAPS samples is reqd for in16k[] (see t16_8.c unit test as example).
-
-  Low pass filter the 16 kHz signal at 4 kHz using the same filter as
-  the upsampler, then just output every FDMDV_OS-th filtered sample.
-
-  Note: this function copied from fdmdv.c, included in nlp.c as a convenience
-  to avoid linking with another source file.
-
-\*---------------------------------------------------------------------------*/
-
-static void fdmdv_16_to_8(float out8k[], float in16k[], int n)
-{
-    float acc;
-    int   i,j,k;
-
-    for(i=0, k=0; k<n; i+=FDMDV_OS, k++) {
-	acc = 0.0;
-	for(j=0; j<FDMDV_OS_TAPS_16K; j++)
-	    acc += fdmdv_os_filter[j]*in16k[i-j];
-        out8k[k] = acc;
-    }
-
-    /* update filter memory */
-
-    for(i=-FDMDV_OS_TAPS_16K; i<0; i++)
-	in16k[i] = in16k[i + n*FDMDV_OS];
-}
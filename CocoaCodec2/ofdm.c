@@ -116,6 +116,7 @@ static int ofdm_rxbuf;
 static int ofdm_ntxtbits; /* reserve bits/frame for auxillary text information */
 static int ofdm_nuwbits; /* Unique word, used for positive indication of lock */
 static int ofdm_state_str;
+static int ofdm_config_set;
 
 /* Functions -------------------------------------------------------------------*/
 
@@ -126,6 +127,46 @@ static float cnormf(complex float val) {
     return realf * realf + imagf * imagf;
 }
 
+static int ofdm_config_equal(const struct OFDM_CONFIG *a, const struct OFDM_CONFIG *b) {
+    return (a->centre == b->centre) && (a->fs == b->fs) && (a->rs == b->rs) && (a->ts == b->ts) &&
+           (a->tcp == b->tcp) && (a->ofdm_timing_mx_thresh == b->ofdm_timing_mx_thresh) &&
+           (a->nc == b->nc) && (a->ns == b->ns) && (a->bps == b->bps) && (a->txtbits == b->txtbits) &&
+           (a->state_str == b->state_str) && (a->ftwindowwidth == b->ftwindowwidth);
+}
+
+/* set the globals, and the sizes that follow from them, from a config */
+
+static void ofdm_config_apply(const struct OFDM_CONFIG *c) {
+    ofdm_nc = c->nc;
+    ofdm_ns = c->ns;
+    ofdm_bps = c->bps;
+    ofdm_ts = c->ts;
+    ofdm_rs = c->rs;
+    ofdm_tcp = c->tcp;
+    ofdm_centre = c->centre;
+    ofdm_fs = c->fs;
+    ofdm_m = (int) (ofdm_fs / ofdm_rs); /* 144 */
+    ofdm_ncp = (int) (ofdm_tcp * ofdm_fs); /* 16 */
+    ofdm_ntxtbits = c->txtbits;
+    ofdm_state_str = c->state_str;
+    ofdm_ftwindowwidth = c->ftwindowwidth;
+    ofdm_timing_mx_thresh = c->ofdm_timing_mx_thresh;
+
+    /* Copy structure into global */
+
+    ofdm_config = *c;
+
+    /* Calculate sizes from config param */
+
+    ofdm_bitsperframe = (ofdm_ns - 1) * (ofdm_nc * ofdm_bps);
+    ofdm_rowsperframe = ofdm_bitsperframe / (ofdm_nc * ofdm_bps);
+    ofdm_samplesperframe = ofdm_ns * (ofdm_m + ofdm_ncp);
+    ofdm_max_samplesperframe = ofdm_samplesperframe + (ofdm_m + ofdm_ncp) / 4;
+    ofdm_rxbuf = 3 * ofdm_samplesperframe + 3 * (ofdm_m + ofdm_ncp);
+    ofdm_nuwbits = (ofdm_ns - 1) * ofdm_bps - ofdm_ntxtbits;
+    ofdm_config_set = 1;
+}
+
 /*
  * ------------
  * ofdm_create
@@ -149,65 +190,37 @@ struct OFDM *ofdm_create(const struct OFDM_CONFIG *config) {
         return NULL;
     }
 
+    struct OFDM_CONFIG c;
+
     if (config->nc == 0) {
         /* Fill in default values */
 
-        ofdm_nc = 17; /* Number of carriers */
-        ofdm_ns = 8; /* Number of Symbol frames */
-        ofdm_bps = 2; /* Bits per Symbol */
-        ofdm_ts = 0.018f;
-        ofdm_rs = 1.0f / ofdm_ts; /* Symbol Rate */
-        ofdm_tcp = .002f; /* Cyclic Prefix duration */
-        ofdm_centre = 1500.0f; /* Centre Audio Frequency */
-        ofdm_fs = 8000.0f; /* Sample Frequency */
-        ofdm_m = (int) (ofdm_fs / ofdm_rs); /* 144 */
-        ofdm_ncp = (int) (ofdm_tcp * ofdm_fs); /* 16 */
-        ofdm_ntxtbits = 4;
-        ofdm_state_str = 16;
-        ofdm_ftwindowwidth = 11;
-        ofdm_timing_mx_thresh = 0.30f;
+        c.nc = 17; /* Number of carriers */
+        c.ns = 8; /* Number of Symbol frames */
+        c.bps = 2; /* Bits per Symbol */
+        c.ts = 0.018f;
+        c.tcp = .002f; /* Cyclic Prefix duration */
+        c.centre = 1500.0f; /* Centre Audio Frequency */
+        c.fs = 8000.0f; /* Sample Frequency */
+        c.txtbits = 4;
+        c.state_str = 16;
+        c.ftwindowwidth = 11;
+        c.ofdm_timing_mx_thresh = 0.30f;
      } else {
         /* Use the users values */
 
-        ofdm_nc = config->nc; /* Number of carriers */
-        ofdm_ns = config->ns; /* Number of Symbol frames */
-        ofdm_bps = config->bps; /* Bits per Symbol */
-        ofdm_ts = config->ts;
-        ofdm_rs = (1.0f / ofdm_ts); /* Symbol Rate */
-        ofdm_tcp = config->tcp; /* Cyclic Prefix duration */
-        ofdm_centre = config->centre; /* Centre Audio Frequency */
-        ofdm_fs = config->fs; /* Sample Frequency */
-        ofdm_m = (int) (ofdm_fs / ofdm_rs); /* 144 */
-        ofdm_ncp = (int) (ofdm_tcp * ofdm_fs); /* 16 */
-        ofdm_ntxtbits = config->txtbits;
-        ofdm_state_str = config->state_str;
-        ofdm_ftwindowwidth = config->ftwindowwidth;
-        ofdm_timing_mx_thresh = config->ofdm_timing_mx_thresh;
+        c = *config;
     }
+    c.rs = 1.0f / c.ts; /* Symbol Rate */
 
-    /* Copy structure into global */
-
-    ofdm_config.centre = ofdm_centre;
-    ofdm_config.fs = ofdm_fs;
-    ofdm_config.rs = ofdm_rs;
-    ofdm_config.ts = ofdm_ts;
-    ofdm_config.tcp = ofdm_tcp;
-    ofdm_config.ofdm_timing_mx_thresh = ofdm_timing_mx_thresh;
-    ofdm_config.nc = ofdm_nc;
-    ofdm_config.ns = ofdm_ns;
-    ofdm_config.bps = ofdm_bps;
-    ofdm_config.txtbits = ofdm_ntxtbits;
-    ofdm_config.state_str = ofdm_state_str;
-    ofdm_config.ftwindowwidth = ofdm_ftwindowwidth;
+    /* The sizes are shared by every modem, so leave them alone if they
+       are not changing, then creating another modem doesn't write to
+       anything modems running on other threads read */
 
-    /* Calculate sizes from config param */
+    if (!ofdm_config_set || !ofdm_config_equal(&c, &ofdm_config)) {
+        ofdm_config_apply(&c);
+    }
 
-    ofdm_bitsperframe = (ofdm_ns - 1) * (ofdm_nc * ofdm_bps);
-    ofdm_rowsperframe = ofdm_bitsperframe / (ofdm_nc * ofdm_bps);
-    ofdm_samplesperframe = ofdm_ns * (ofdm_m + ofdm_ncp);
-    ofdm_max_samplesperframe = ofdm_samplesperframe + (ofdm_m + ofdm_ncp) / 4;
-    ofdm_rxbuf = 3 * ofdm_samplesperframe + 3 * (ofdm_m + ofdm_ncp);
-    ofdm_nuwbits = (ofdm_ns - 1) * ofdm_bps - ofdm_ntxtbits;
 
     /* Were ready to start filling in the OFDM structure now */
 
@@ -669,6 +682,18 @@ int ofdm_get_bits_per_frame() {
     return ofdm_bitsperframe;
 }
 
+/* centre frequency of each carrier including the two edge pilots, returns Nc+2 */
+
+int ofdm_get_carrier_freqs(struct OFDM *ofdm, float *freq_hz) {
+    int i;
+
+    for (i = 0; i < (ofdm_nc + 2); i++) {
+        freq_hz[i] = ofdm->w[i] * ofdm_fs / TAU;
+    }
+
+    return ofdm_nc + 2;
+}
+
 void ofdm_set_verbose(struct OFDM *ofdm, int level) {
     ofdm->verbose = level;
 }
@@ -743,21 +768,31 @@ void ofdm_mod(struct OFDM *ofdm, COMP *result, const int *tx_bits) {
  * ----------------------------------------------------------------------------------
  */
 
-int ofdm_sync_search(struct OFDM *ofdm, COMP *rxbuf_in) {
-    int i, j;
+/* shift the buffer left based on nin, converting the latest input samples onto its tail */
 
-    /* insert latest input samples into rxbuf so it is primed for when
-       we have to call ofdm_demod() */
+static void ofdm_rxbuf_insert(struct OFDM *ofdm, const void *rxbuf_in, const struct MODEM_IO *io) {
+    COMP x;
+    int i, j;
 
     for (i = 0, j = ofdm->nin; i < (ofdm_rxbuf - ofdm->nin); i++, j++) {
         ofdm->rxbuf[i] = ofdm->rxbuf[j];
     }
 
-    /* insert latest input samples onto tail of rxbuf */
-
     for (i = (ofdm_rxbuf - ofdm->nin), j = 0; i < ofdm_rxbuf; i++, j++) {
-        ofdm->rxbuf[i] = rxbuf_in[j].real + rxbuf_in[j].imag * I;
+        x = modem_io_get(io, rxbuf_in, j);
+        ofdm->rxbuf[i] = x.real + x.imag * I;
     }
+}
+
+int ofdm_sync_search(struct OFDM *ofdm, COMP *rxbuf_in) {
+    return ofdm_sync_search_io(ofdm, rxbuf_in, &modem_io_comp);
+}
+
+int ofdm_sync_search_io(struct OFDM *ofdm, const void *rxbuf_in, const struct MODEM_IO *io) {
+    /* insert latest input samples into rxbuf so it is primed for when
+       we have to call ofdm_demod() */
+
+    ofdm_rxbuf_insert(ofdm, rxbuf_in, io);
 
     /* Attempt coarse timing estimate (i.e. detect start of frame) */
 
@@ -790,6 +825,24 @@ int ofdm_sync_search(struct OFDM *ofdm, COMP *rxbuf_in) {
     return ofdm->timing_valid;
 }
 
+/*
+ * ----------------------------------------------------------------------------------
+ * ofdm_sync_idle - buffers samples in place of ofdm_sync_search() when it is
+ * already known there is no signal, skipping the timing and freq estimates
+ * ----------------------------------------------------------------------------------
+ */
+
+void ofdm_sync_idle(struct OFDM *ofdm, COMP *rxbuf_in) {
+    ofdm_sync_idle_io(ofdm, rxbuf_in, &modem_io_comp);
+}
+
+void ofdm_sync_idle_io(struct OFDM *ofdm, const void *rxbuf_in, const struct MODEM_IO *io) {
+    ofdm_rxbuf_insert(ofdm, rxbuf_in, io);
+
+    ofdm->timing_valid = 0;
+    ofdm->nin = ofdm_samplesperframe;
+}
+
 /*
  * ------------------------------------------
  * ofdm_demod - Demodulates one frame of bits
@@ -797,6 +850,10 @@ int ofdm_sync_search(struct OFDM *ofdm, COMP *rxbuf_in) {
  */
 
 void ofdm_demod(struct OFDM *ofdm, int *rx_bits, COMP *rxbuf_in) {
+    ofdm_demod_io(ofdm, rx_bits, rxbuf_in, &modem_io_comp);
+}
+
+void ofdm_demod_io(struct OFDM *ofdm, int *rx_bits, const void *rxbuf_in, const struct MODEM_IO *io) {
     complex float aphase_est_pilot_rect;
     float aphase_est_pilot[ofdm_nc + 2];
     float aamp_est_pilot[ofdm_nc + 2];
@@ -804,17 +861,7 @@ void ofdm_demod(struct OFDM *ofdm, int *rx_bits, COMP *rxbuf_in) {
     int i, j, k, rr, st, en, ft_est;
     int prev_timing_est = ofdm->timing_est;
 
-    /* shift the buffer left based on nin */
-
-    for (i = 0, j = ofdm->nin; i < (ofdm_rxbuf - ofdm->nin); i++, j++) {
-        ofdm->rxbuf[i] = ofdm->rxbuf[j];
-    }
-
-    /* insert latest input samples onto tail of rxbuf */
-
-    for (i = (ofdm_rxbuf - ofdm->nin), j = 0; i < ofdm_rxbuf; i++, j++) {
-        ofdm->rxbuf[i] = rxbuf_in[j].real + rxbuf_in[j].imag * I;
-    }
+    ofdm_rxbuf_insert(ofdm, rxbuf_in, io);
 
     /*
      * get user and calculated freq offset
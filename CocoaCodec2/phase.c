@@ -161,7 +161,8 @@ void phase_synth_zero_order(
     int    n_samp,
     MODEL *model,
     float *ex_phase,            /* excitation phase of fundamental        */
-    COMP   H[]                  /* L synthesis filter freq domain samples */
+    COMP   H[],                 /* L synthesis filter freq domain samples */
+    unsigned long *rand_seed    /* state of the unvoiced phase generator  */
 
 )
 {
@@ -197,7 +198,7 @@ void phase_synth_zero_order(
                phase is not needed in the unvoiced case, but no harm in
                keeping it.
             */
-            float phi = TWO_PI*(float)codec2_rand()/CODEC2_RAND_MAX;
+            float phi = TWO_PI*(float)codec2_rand_r(rand_seed)/CODEC2_RAND_MAX;
             Ex[m].real = cosf(phi);
             Ex[m].imag = sinf(phi);
         }
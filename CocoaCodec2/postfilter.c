@@ -100,7 +100,8 @@
 
 void postfilter(
   MODEL *model,
-  float *bg_est
+  float *bg_est,
+  unsigned long *rand_seed
 )
 {
   int   m, uv;
@@ -131,7 +132,7 @@ void postfilter(
   if (model->voiced)
       for(m=1; m<=model->L; m++)
 	  if (model->A[m] < thresh) {
-	      model->phi[m] = TWO_PI*(float)codec2_rand()/CODEC2_RAND_MAX;
+	      model->phi[m] = TWO_PI*(float)codec2_rand_r(rand_seed)/CODEC2_RAND_MAX;
 	      uv++;
 	  }
 
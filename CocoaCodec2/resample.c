@@ -0,0 +1,293 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: resample.c
+  DATE CREATED: October 2026
+
+  Streaming rational sample rate converter.  The rate is changed by
+  L/M with a polyphase Kaiser windowed sinc filter, so only the output
+  samples that are kept are computed, each from one phase of
+  RESAMPLE_NTAPS (scaled for decimation) taps.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License version 2.1, as
+  published by the Free Software Foundation.  This program is
+  distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*---------------------------------------------------------------------------*\
+
+                               DEFINES
+
+\*---------------------------------------------------------------------------*/
+
+#define RESAMPLE_NTAPS   48     /* taps per phase at the lower of the two rates  */
+#define RESAMPLE_CUTOFF  0.45   /* filter cutoff as a fraction of the lower rate */
+#define RESAMPLE_BETA    8.0    /* Kaiser window, about 80 dB stop band          */
+#define RESAMPLE_NBUF    256    /* block size of the short to float conversion   */
+
+/*---------------------------------------------------------------------------*\
+
+                               INCLUDES
+
+\*---------------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "resample.h"
+#include "filter.h"
+
+struct RESAMPLE {
+    int    L, M;        /* interpolate by L then decimate by M              */
+    int    ntaps;       /* taps per phase                                   */
+    int    phase;       /* phase of the next output, kept outputs step by M */
+    float *coeff;       /* L phases of ntaps, oldest sample first           */
+    float *mem;         /* double-length delay line of ntaps samples        */
+    int    index;       /* position of the oldest sample in mem             */
+};
+
+/*---------------------------------------------------------------------------*\
+
+                               FUNCTIONS
+
+\*---------------------------------------------------------------------------*/
+
+static int gcd(int a, int b) {
+    while (b) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* zeroth order modified Bessel function of the first kind */
+
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    int    k;
+
+    for(k=1; k<50; k++) {
+        term *= (x/(2*k))*(x/(2*k));
+        sum += term;
+        if (term < 1E-12*sum)
+            break;
+    }
+    return sum;
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: resample_create
+  DATE CREATED: October 2026
+
+  Designs the prototype low pass filter at the intermediate rate L*fs_in
+  and splits it into L phases.  The cutoff is set by the lower of the
+  two rates so the same design serves both up and down conversion.
+
+\*---------------------------------------------------------------------------*/
+
+struct RESAMPLE *resample_create(int fs_in, int fs_out)
+{
+    struct RESAMPLE *r;
+    int    g, n, N, p, j;
+    double fc, x, w, arg;
+
+    if ((fs_in <= 0) || (fs_out <= 0))
+        return NULL;
+    g = gcd(fs_in, fs_out);
+    if ((fs_out/g > RESAMPLE_MAX_L) || (fs_out > 64*fs_in))
+        return NULL;
+
+    r = (struct RESAMPLE*)malloc(sizeof(struct RESAMPLE));
+    if (r == NULL)
+        return NULL;
+    r->L = fs_out/g;
+    r->M = fs_in/g;
+    r->phase = 0;
+    r->index = 0;
+
+    /* matching rates just copy */
+
+    if (r->L == r->M) {
+        r->ntaps = 0;
+        r->coeff = NULL;
+        r->mem = NULL;
+        return r;
+    }
+
+    /* keep RESAMPLE_NTAPS taps at the lower rate, so decimating filters
+       span the same time as interpolating ones */
+
+    r->ntaps = RESAMPLE_NTAPS;
+    if (r->M > r->L)
+        r->ntaps = (RESAMPLE_NTAPS*r->M + r->L - 1)/r->L;
+    N = r->ntaps*r->L;
+
+    r->coeff = (float*)malloc(sizeof(float)*N);
+    r->mem = (float*)calloc(2*r->ntaps, sizeof(float));
+    if ((r->coeff == NULL) || (r->mem == NULL)) {
+        resample_destroy(r);
+        return NULL;
+    }
+
+    /* cutoff normalised to the intermediate rate, gain of L restores the
+       level lost to the zeros stuffed between input samples */
+
+    fc = RESAMPLE_CUTOFF/((r->L > r->M) ? r->L : r->M);
+    for(p=0; p<r->L; p++) {
+        for(j=0; j<r->ntaps; j++) {
+            n = p + (r->ntaps - 1 - j)*r->L;
+            x = n - (N - 1)/2.0;
+            arg = 2.0*x/(N - 1);
+            w = bessel_i0(RESAMPLE_BETA*sqrt(fmax(0.0, 1.0 - arg*arg)))/bessel_i0(RESAMPLE_BETA);
+            if (fabs(x) < 1E-9)
+                r->coeff[p*r->ntaps + j] = 2.0*fc*w*r->L;
+            else
+                r->coeff[p*r->ntaps + j] = sin(2.0*M_PI*fc*x)/(M_PI*x)*w*r->L;
+        }
+    }
+
+    return r;
+}
+
+
+void resample_destroy(struct RESAMPLE *r)
+{
+    assert(r != NULL);
+    free(r->coeff);
+    free(r->mem);
+    free(r);
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: resample_float
+  DATE CREATED: October 2026
+
+  Each input sample is added to the delay line, then every output that
+  falls before the next input sample is computed from its own phase.
+  in[] and out[] must not overlap.
+
+\*---------------------------------------------------------------------------*/
+
+int resample_float(struct RESAMPLE *r, float out[], float in[], int nin)
+{
+    int i, nout;
+    float *window;
+
+    if (r->ntaps == 0) {
+        memcpy(out, in, sizeof(float)*nin);
+        return nin;
+    }
+
+    nout = 0;
+    for(i=0; i<nin; i++) {
+        quisk_fDelayPut(r->mem, r->ntaps, &r->index, &in[i], 1);
+        window = r->mem + r->index;
+        while (r->phase < r->L) {
+            out[nout++] = quisk_dot_ff(window, r->coeff + r->phase*r->ntaps, r->ntaps);
+            r->phase += r->M;
+        }
+        r->phase -= r->L;
+    }
+
+    return nout;
+}
+
+
+int resample_short(struct RESAMPLE *r, short out[], short in[], int nin)
+{
+    float in_float[RESAMPLE_NBUF];
+    float out_float[RESAMPLE_NBUF];
+    int   i, n, nout, nblock, max_block;
+    float x;
+
+    /* largest input block whose output fits out_float[] */
+
+    max_block = ((RESAMPLE_NBUF - 1)*r->M)/r->L;
+    if (max_block > RESAMPLE_NBUF)
+        max_block = RESAMPLE_NBUF;
+    assert(max_block > 0);
+
+    nout = 0;
+    while (nin > 0) {
+        nblock = (nin < max_block) ? nin : max_block;
+        for(i=0; i<nblock; i++)
+            in_float[i] = in[i];
+        n = resample_float(r, out_float, in_float, nblock);
+        for(i=0; i<n; i++) {
+            x = out_float[i];
+            if (x > 32767.0)
+                x = 32767.0;
+            if (x < -32767.0)
+                x = -32767.0;
+            out[nout++] = (short)lrintf(x);
+        }
+        in += nblock;
+        nin -= nblock;
+    }
+
+    return nout;
+}
+
+
+int resample_nout(struct RESAMPLE *r, int nin)
+{
+    int i, phase, nout;
+
+    if (r->ntaps == 0)
+        return nin;
+
+    phase = r->phase;
+    nout = 0;
+    for(i=0; i<nin; i++) {
+        while (phase < r->L) {
+            nout++;
+            phase += r->M;
+        }
+        phase -= r->L;
+    }
+
+    return nout;
+}
+
+
+int resample_nin(struct RESAMPLE *r, int nout)
+{
+    int nin, phase, n;
+
+    if (r->ntaps == 0)
+        return (nout > 0) ? nout : 0;
+
+    phase = r->phase;
+    nin = 0;
+    n = 0;
+    while (n < nout) {
+        while (phase < r->L) {
+            n++;
+            phase += r->M;
+        }
+        phase -= r->L;
+        nin++;
+    }
+
+    return nin;
+}
+
+
+int resample_max_nout(struct RESAMPLE *r, int nin)
+{
+    return (int)(((long)nin*r->L + r->M - 1)/r->M) + 1;
+}
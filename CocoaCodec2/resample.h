@@ -0,0 +1,66 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: resample.h
+  DATE CREATED: October 2026
+
+  Streaming rational sample rate converter, for example to run the
+  8 kHz modems and codec from a 44.1 or 48 kHz sound card.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License version 2.1, as
+  published by the Free Software Foundation.  This program is
+  distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __RESAMPLE__
+#define __RESAMPLE__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct RESAMPLE;
+
+/*
+ * Create a converter from fs_in to fs_out Hz.  fs_out/fs_in is reduced to
+ * L/M and L must not exceed RESAMPLE_MAX_L, which covers every pair of 8,
+ * 16, 44.1 and 48 kHz, nor may the rate go up more than 64 times.  All
+ * memory is allocated here, none per call.
+ * Returns NULL if the rates are not supported.
+ */
+#define RESAMPLE_MAX_L 1024
+
+struct RESAMPLE *resample_create(int fs_in, int fs_out);
+void resample_destroy(struct RESAMPLE *r);
+
+/*
+ * Convert nin samples, returning the number of samples written to out[].
+ * State is kept between calls so nin can be any size.  out[] must hold
+ * resample_max_nout(r, nin) samples.  The short version clips its output.
+ */
+int resample_float(struct RESAMPLE *r, float out[], float in[], int nin);
+int resample_short(struct RESAMPLE *r, short out[], short in[], int nin);
+
+/* Number of output samples the next nin input samples will produce */
+int resample_nout(struct RESAMPLE *r, int nin);
+
+/* Fewest input samples that will produce at least nout output samples */
+int resample_nin(struct RESAMPLE *r, int nout);
+
+/* Most output samples nin input samples can produce, whatever the state */
+int resample_max_nout(struct RESAMPLE *r, int nin);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -679,11 +679,15 @@ void synthesise(
 }
 
 
-/* todo: this should probably be in some states rather than a static */
+/* shared state for codec2_rand(), each decoder keeps its own for codec2_rand_r() */
 static unsigned long next = 1;
 
 int codec2_rand(void) {
-    next = next * 1103515245 + 12345;
-    return((unsigned)(next/65536) % 32768);
+    return codec2_rand_r(&next);
+}
+
+int codec2_rand_r(unsigned long *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return((unsigned)(*seed/65536) % 32768);
 }
 
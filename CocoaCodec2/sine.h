@@ -45,5 +45,6 @@ void synthesise(int n_samp, codec2_fftr_cfg fftr_inv_cfg, float Sn_[], MODEL *mo
 
 #define CODEC2_RAND_MAX 32767
 int codec2_rand(void);
+int codec2_rand_r(unsigned long *seed);
 
 #endif
@@ -33,6 +33,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
 
 /* Easy handle to enable/disable a whole slew of debug printouts */
 //#define VERY_DEBUG 1
@@ -45,6 +48,43 @@ static const uint8_t TDMA_UW_D[] =    {1,1,1,1,0,0,0,1,
                                        
 static const uint8_t * TDMA_UW_LIST_A[] = {&TDMA_UW_V[0],&TDMA_UW_D[0]};
 
+/* One slot scheduled for demodulation, and what the demod found */
+struct TDMA_RX_JOB {
+    slot_t * slot;                  /* Slot to demod */
+    i64 slot_timestamp;             /* Where the slot starts */
+    bool skip;                      /* TX slot, don't demod unless it turns back to RX */
+    bool demodded;                  /* Has the demod been run yet? */
+    bool f_valid;                   /* Was a good UW found? */
+    bool local_offset_valid;        /* Was local_offset measured from a good UW? */
+    i32 local_offset;               /* Frame offset from the slot start, in samples */
+    i32 f_start;                    /* Start of the frame in bit_buf */
+    size_t off, delta;              /* UW position and bit errors */
+    f32 demod_us;                   /* How long the demod took */
+    u8 * bit_buf;                   /* Demodulated bits */
+};
+
+/* Worker threads for demodulating several slots at once */
+struct TDMA_POOL {
+    tdma_t * tdma;
+    pthread_t * threads;
+    u32 n_threads;
+    pthread_mutex_t lock;
+    pthread_cond_t work_cv;         /* Signalled when a batch of jobs is ready */
+    pthread_cond_t done_cv;         /* Signalled when the last job of a batch is finished */
+    int n_jobs;                     /* Jobs in the current batch, 0 when idle */
+    int next_job;                   /* Next job to be taken */
+    int n_done;                     /* Jobs finished */
+    bool quit;
+};
+
+static i64 tdma_time_us(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (i64)ts.tv_sec*1000000 + ts.tv_nsec/1000;
+}
+
+static void tdma_pool_destroy(struct TDMA_POOL * pool);
+
 tdma_t * tdma_create(struct TDMA_MODE_SETTINGS mode){
     tdma_t * tdma;
     
@@ -56,6 +96,7 @@ tdma_t * tdma_create(struct TDMA_MODE_SETTINGS mode){
     u32 P = Fs/Rs;
     u32 Ts = Fs/Rs;
     COMP * samp_buffer = NULL;
+    fsk_t * pilot = NULL;
     
     size_t i;
 
@@ -65,19 +106,25 @@ tdma_t * tdma_create(struct TDMA_MODE_SETTINGS mode){
     /* allocate the modem */
     tdma = (tdma_t *) malloc(sizeof(tdma_t));
     if(tdma == NULL) goto cleanup_bad_alloc;
+    tdma->slots = NULL;
+    tdma->slot_table = NULL;
+    tdma->rx_jobs = NULL;
+    tdma->rx_pool = NULL;
+    tdma->rx_batch = 1;
 
     /* Symbols over which pilot modem operates */
     u32 pilot_nsyms = slot_size/2;
 
     /* Set up pilot modem */
-    fsk_t * pilot = fsk_create_hbr(Fs,Rs,P,M,Rs,Rs);
+    pilot = fsk_create_hbr(Fs,Rs,P,M,Rs,Rs);
     if(pilot == NULL) goto cleanup_bad_alloc;
     fsk_enable_burst_mode(pilot,pilot_nsyms);
     tdma->fsk_pilot = pilot;
     tdma->settings = mode;
     tdma->state = no_sync;
-    tdma->sample_sync_offset = 960;
     tdma->slot_cur = 0;
+    tdma->loop_delay = 0;
+    tdma->tx_multislot_delay = 0;
     tdma->rx_callback = NULL;
     tdma->tx_callback = NULL;
     tdma->tx_burst_callback = NULL;
@@ -89,17 +136,21 @@ tdma_t * tdma_create(struct TDMA_MODE_SETTINGS mode){
         tdma->uw_types = 2;
         tdma->uw_list = (uint8_t**)TDMA_UW_LIST_A;
         tdma->master_bit_pos = 35;
+        for(i=0; i<tdma->uw_types; i++)
+            uw_search_init(&tdma->uw_packed[i], tdma->uw_list[i], mode.uw_len);
     }
-    /* Allocate buffer for incoming samples */
-    /* TODO: We may only need a single slot's worth of samps -- look into this */
-    samp_buffer = (COMP *) malloc(sizeof(COMP)*slot_size*Ts*(n_slots+1));
+    /* Allocate the circular store for incoming samples. It is written twice, at
+       i and i+ring_len, so the demods can read straight out of it. It holds
+       enough for a batch of every slot to wait for its last slot to arrive */
+    tdma->ring_len = slot_size*Ts*(n_slots+2);
+    samp_buffer = (COMP *) calloc(2*tdma->ring_len, sizeof(COMP));
     if(samp_buffer == NULL) goto cleanup_bad_alloc;
 
     tdma->sample_buffer = samp_buffer;
-    for(i=0; i<slot_size*Ts*n_slots; i++){
-        tdma->sample_buffer[i].real = 0;
-        tdma->sample_buffer[i].imag = 0;
-    }
+    tdma->ring_end = 0;
+    tdma->ring_started = false;
+    tdma->slot_timestamp = 0;
+    tdma->timestamp = 0;
 
     slot_t * slot;
     slot_t * last_slot;
@@ -116,6 +167,12 @@ tdma_t * tdma_create(struct TDMA_MODE_SETTINGS mode){
         slot->single_tx = true;
         slot->bad_uw_count = 0;
         slot->master_count = 0;
+        slot->rx_demods = 0;
+        slot->rx_due_us = 0;
+        slot->rx_demod_us = 0;
+        slot->rx_latency_us = 0;
+        slot->rx_latency_us_max = 0;
+        slot->rx_latency_samps = 0;
         slot_fsk = fsk_create_hbr(Fs,Rs,P,M,Rs,Rs);
         
         if(slot_fsk == NULL) goto cleanup_bad_alloc;
@@ -125,6 +182,23 @@ tdma_t * tdma_create(struct TDMA_MODE_SETTINGS mode){
         last_slot = slot;
     }
 
+    /* Slot 0 is at the head of the list */
+    tdma->slot_table = (slot_t **) malloc(sizeof(slot_t *)*n_slots);
+    if(tdma->slot_table == NULL) goto cleanup_bad_alloc;
+    slot = tdma->slots;
+    for(i=0; i<n_slots; i++){
+        tdma->slot_table[i] = slot;
+        slot = slot->next_slot;
+    }
+
+    /* One demod job per slot, for when a whole frame is demodulated at once */
+    size_t nbits = (slot_size+1)*((M==2)?1:2);
+    tdma->rx_jobs = (struct TDMA_RX_JOB *) malloc(n_slots*(sizeof(struct TDMA_RX_JOB)+nbits));
+    if(tdma->rx_jobs == NULL) goto cleanup_bad_alloc;
+    for(i=0; i<n_slots; i++){
+        tdma->rx_jobs[i].bit_buf = (u8 *)&tdma->rx_jobs[n_slots] + i*nbits;
+    }
+
     return tdma;
 
     /* Clean up after a failed malloc */
@@ -141,6 +215,8 @@ tdma_t * tdma_create(struct TDMA_MODE_SETTINGS mode){
     }
     if(pilot != NULL) fsk_destroy(pilot);
     if(samp_buffer != NULL) free(samp_buffer);
+    free(tdma->slot_table);
+    free(tdma->rx_jobs);
     free(tdma);
     return NULL;
 }
@@ -148,6 +224,7 @@ tdma_t * tdma_create(struct TDMA_MODE_SETTINGS mode){
 void tdma_destroy(tdma_t * tdma){
     slot_t * slot = tdma->slots;
     slot_t * next_slot;
+    tdma_pool_destroy(tdma->rx_pool);
     while(slot != NULL){
         next_slot = slot->next_slot;
         fsk_destroy(slot->fsk);
@@ -156,6 +233,8 @@ void tdma_destroy(tdma_t * tdma){
     }
     fsk_destroy(tdma->fsk_pilot);
     free(tdma->sample_buffer);
+    free(tdma->slot_table);
+    free(tdma->rx_jobs);
     free(tdma);
 }
 
@@ -174,10 +253,7 @@ size_t tdma_search_uw(tdma_t * tdma, u8 bits[], size_t nbits, size_t * delta_out
 
     size_t uw_len = tdma->settings.uw_len;
     size_t bits_per_sym = (tdma->settings.fsk_m==2)?1:2;
-    u8 ** uw_list = tdma->uw_list;
-    size_t ibits,iuw;
-    size_t delta_min = uw_len;
-    size_t delta;
+    int delta_min;
     size_t j;
     size_t uw_type_min = 0;
     size_t uw_delta_min = uw_len;
@@ -185,19 +261,8 @@ size_t tdma_search_uw(tdma_t * tdma, u8 bits[], size_t nbits, size_t * delta_out
     /* Check each UW */
     for(j = 0; j < tdma->uw_types; j++){
         /* Walk through buffer bits */
-        u8 * uw = uw_list[j];
-        size_t offset_min = 0;
-        for(ibits = 0; ibits < nbits-uw_len; ibits+=bits_per_sym){
-            delta = 0;
-            for(iuw = 0; iuw < uw_len; iuw++){
-                if(bits[ibits+iuw] != uw[iuw]) delta++;
-            }
-            if( delta < delta_min ){
-                delta_min = delta;
-                offset_min = ibits;
-            }
-        }
-        if( delta_min < uw_delta_min ){
+        size_t offset_min = uw_search_best(&tdma->uw_packed[j], bits, nbits-uw_len, bits_per_sym, &delta_min);
+        if( (size_t)delta_min < uw_delta_min ){
             uw_delta_min = delta_min;
             uw_offset_min = offset_min;
             uw_type_min = j;
@@ -214,14 +279,49 @@ slot_t * tdma_get_slot(tdma_t * tdma, u32 slot_idx){
     /* Don't try and index beyond the end */
     if(slot_idx >= tdma->settings.n_slots) return NULL;
 
-    size_t i;
-    slot_t * cur = tdma->slots;
-    for(i = 0; i < slot_idx; i++){
-        /* Don't break */
-        if(cur == NULL) return NULL;
-        cur = cur->next_slot;
+    return tdma->slot_table[slot_idx];
+}
+
+/* Pointer to n_samps contiguous samples starting at timestamp, or NULL if they
+   are not all in the sample store */
+COMP * tdma_get_samples(tdma_t * tdma, i64 timestamp, size_t n_samps){
+    i64 ring_len = (i64)tdma->ring_len;
+    i64 pos;
+
+    if((i64)n_samps > ring_len) return NULL;
+    if(timestamp < tdma->ring_end - ring_len) return NULL;
+    if(timestamp + (i64)n_samps > tdma->ring_end) return NULL;
+
+    pos = timestamp % ring_len;
+    if(pos < 0) pos += ring_len;
+    return &tdma->sample_buffer[pos];
+}
+
+/* Copy samples into the sample store at their timestamp, both halves */
+static void tdma_put_samples(tdma_t * tdma, COMP * samps, size_t n_samps, i64 timestamp){
+    i64 ring_len = (i64)tdma->ring_len;
+    COMP * sample_buffer = tdma->sample_buffer;
+    size_t n;
+    i64 pos;
+
+    /* Only the newest ring_len samples can be kept */
+    if((i64)n_samps > ring_len){
+        samps += n_samps - ring_len;
+        timestamp += n_samps - ring_len;
+        n_samps = ring_len;
+    }
+
+    pos = timestamp % ring_len;
+    if(pos < 0) pos += ring_len;
+    while(n_samps > 0){
+        n = ring_len - pos;
+        if(n > n_samps) n = n_samps;
+        memcpy(&sample_buffer[pos],&samps[0],n*sizeof(COMP));
+        memcpy(&sample_buffer[pos+ring_len],&samps[0],n*sizeof(COMP));
+        samps += n;
+        n_samps -= n;
+        pos = 0;
     }
-    return cur;
 }
 
 #pragma GCC diagnostic push
@@ -275,22 +375,18 @@ void tdma_do_tx_frame(tdma_t * tdma, int slot_idx){
 
     /* Calculate TX time and send frame down to radio */
     /* timestamp of head of slot currently being demod'ed */
-    i64 tx_timestamp = tdma->timestamp + (i64)tdma->sample_sync_offset;
+    i64 tx_timestamp = tdma->slot_timestamp;
 
-    /* Figure out how far in future the next instance of 'this' slot will be */
-    int delta_slots = 0;
-    u32 slot_cur = tdma->slot_cur;
-    if(slot_idx > slot_cur){
-        delta_slots = slot_idx-slot_cur;
-    }else if(slot_idx < slot_cur){
-        delta_slots = (slot_cur+slot_idx+2)%n_slots;
-    }
+    /* Figure out how far in future the next instance of 'this' slot will be.
+       The current slot has already been received, so at least one slot on */
+    i64 delta_slots = (((i64)slot_idx - (i64)tdma->slot_cur - 1 + n_slots) % n_slots) + 1;
     
     /* Point timestamp to next available slot */
     tx_timestamp += delta_slots*slot_size*Ts;
 
-    /* Add multi-slot/frame offset to tx timestamp */
-    tx_timestamp += tdma->tx_multislot_delay*slot_size*Ts;
+    /* Add multi-slot/frame offset and radio loop delay to tx timestamp */
+    tx_timestamp += (i64)tdma->tx_multislot_delay*slot_size*Ts;
+    tx_timestamp += tdma->loop_delay;
 
     /* Send frame on to radio if callback is setup */
     if(tdma->tx_burst_callback != NULL){
@@ -348,40 +444,120 @@ void tdma_deframe_cbcall(u8 demod_bits[], u32 slot_i, tdma_t * tdma, slot_t * sl
     }
 }
 
-/* We got a new slot's worth of samples. Run the slot modem and try to get slot sync */
-/* This will probably also work for the slot_sync state */
-void tdma_rx_pilot_sync(tdma_t * tdma){
+/* Demodulate one scheduled slot and look for its UW. This only touches the
+   slot's own FSK modem and job, so different slots can run at the same time */
+static void tdma_demod_slot(tdma_t * tdma, struct TDMA_RX_JOB * job){
     struct TDMA_MODE_SETTINGS mode = tdma->settings;
     u32 Rs = mode.sym_rate;
     u32 Fs = mode.samp_rate;
     u32 slot_size = mode.slot_size;
     u32 frame_size = mode.frame_size;
-    u32 n_slots = mode.n_slots;
     u32 M = mode.fsk_m;
     u32 Ts = Fs/Rs;
     u32 slot_samps = slot_size*Ts;
     u32 bits_per_sym = M==2?1:2;
     size_t uw_len = mode.uw_len;
-    slot_t * slot = tdma_get_slot(tdma,tdma->slot_cur);
+    slot_t * slot = job->slot;
     fsk_t * fsk = slot->fsk;
     size_t nbits = (slot_size+1)*bits_per_sym;
-    size_t slot_offset = tdma->sample_sync_offset;
-    u8 bit_buf[nbits];
-    COMP * sample_buffer = tdma->sample_buffer;
-    COMP frame_samps[(slot_size+1)*Ts];
+    u8 * bit_buf = job->bit_buf;
+    COMP * frame_samps;
+    i64 t_start = tdma_time_us();
 
     u32 frame_bits = frame_size*bits_per_sym;
 
-    /* Compensate for frame timing offset sliding towards end of buffer */
-    /* As in, don't demodulate this slot since we're getting ahead of ourselves */
-    if( (slot_offset+slot_samps) > (slot_samps*(n_slots+1)-(slot_samps/4)) ){
-        /* Move slot offset back by 1 slot and don't increment slot index. We'll just handle this one on the next batch of samps */
-        tdma->sample_sync_offset -= slot_samps;
+    /* The demod takes one symbol past the end of the slot so we can get the last
+       symbol out of it, the scheduler has waited for that to arrive */
+
+    /* Flag to indicate whether or not we should re-do the demodulation */
+    bool repeat_demod = false;
+    int rdemod_offset = 0;
+    size_t delta,off,uw_type;
+    i32 f_start;
+    i32 frame_offset;
+    bool f_valid = false;
+    job->local_offset_valid = false;
+    /* Demod section in do-while loop so we can repeat once if frame is just outside of bit buffer */
+    do{
+        /* Demod the frame in place in the sample store */
+        frame_samps = tdma_get_samples(tdma,job->slot_timestamp+rdemod_offset,(slot_size+1)*Ts);
+        assert(frame_samps != NULL);
+
+        /* Demodulate the frame */
+        fsk_demod(fsk,bit_buf,frame_samps);
+
+        off = tdma_search_uw(tdma, bit_buf, nbits, &delta, &uw_type);
+        f_start = off- (frame_bits-uw_len)/2;
+
+        /* Check frame tolerance and sync state*/
+        if(slot->state == rx_sync){
+            f_valid = delta <= tdma->settings.frame_sync_tol;
+        }else if(slot->state == rx_no_sync){
+            f_valid = delta <= tdma->settings.first_sync_tol;
+        }
+
+        /* Calculate offset (in samps) from start of frame */
+        /* Note: FSK outputs one symbol from the last batch, so we have to account for that */
+        i32 target_frame_offset = ((slot_size-frame_size)/2)*Ts;
+        frame_offset = ((f_start-bits_per_sym)*(Ts/bits_per_sym)) - target_frame_offset;
+
+        /* Flag a large frame offset as a bad UW sync */
+        if( abs(frame_offset) > (slot_samps/4) )
+            f_valid = false;
+        
+        if(f_valid && !repeat_demod){
+            job->local_offset = frame_offset;
+            job->local_offset_valid = true;
+        }
+
+
+        /* Check to see if the bits are outside of the demod buffer. If so, adjust and re-demod*/
+        /* Disabled for now; will re-enable when worked out better in head */
+        /* No, this is enabled. I have it more or less worked out */
+        if(f_valid && !repeat_demod){
+            if((f_start < bits_per_sym) || ((f_start+(bits_per_sym*frame_size)) > (bits_per_sym*(slot_size+1)))){
+                repeat_demod = true;
+            }
+        }else repeat_demod = false;
+
+
         #ifdef VERY_DEBUG
-        fprintf(stderr,"Skipping\n");
+        if(repeat_demod){
+            fprintf(stderr,"f_start: %d, Re-demod-ing\n",f_start);
+        }
+        if(f_valid){
+            fprintf(stderr,"Good UW, type %zd\n",uw_type);
+        }else{
+            fprintf(stderr,"Bad UW\n");
+        }
         #endif
-        return;
-    }
+
+        rdemod_offset = frame_offset;
+        
+    }while(repeat_demod);
+
+    job->f_valid = f_valid;
+    job->off = off;
+    job->delta = delta;
+    job->f_start = f_start;
+    job->demodded = true;
+    job->demod_us = (f32)(tdma_time_us() - t_start);
+}
+
+/* We got a new slot's worth of samples. Run the slot modem and try to get slot sync */
+/* This will probably also work for the slot_sync state */
+/* Slots are passed through here in order, after their demods have been run */
+void tdma_rx_pilot_sync(tdma_t * tdma, struct TDMA_RX_JOB * job){
+    struct TDMA_MODE_SETTINGS mode = tdma->settings;
+    u32 Rs = mode.sym_rate;
+    u32 Fs = mode.samp_rate;
+    u32 slot_size = mode.slot_size;
+    u32 n_slots = mode.n_slots;
+    u32 Ts = Fs/Rs;
+    u32 slot_samps = slot_size*Ts;
+    slot_t * slot = job->slot;
+    fsk_t * fsk = slot->fsk;
+    u8 * bit_buf = job->bit_buf;
 
     /* Do TX if this is a TX slot */
     if(slot->state == tx_client){
@@ -390,76 +566,15 @@ void tdma_rx_pilot_sync(tdma_t * tdma){
     /* If we're set up to ignore RX during a TX frame, and we're in a TX frame, ignore RX */
     if(!(tdma->ignore_rx_on_tx && slot->state == tx_client))
     {
-        /* Zero out tail end of bit buffer so we can get last symbol out of demod */
-        /* TODO: This is a hack. Look into better burst mode support in FSK */
         size_t i;
-        for(i = slot_samps; i< (slot_size+1)*Ts; i++){
-            frame_samps[i].real = 0;
-            frame_samps[i].imag = 0;
-        }
+        bool f_valid;
 
-        /* Flag to indicate whether or not we should re-do the demodulation */
-        bool repeat_demod = false;
-        int rdemod_offset = 0;
-        size_t delta,off,uw_type;
-        i32 f_start;
-        i32 frame_offset;
-        bool f_valid = false;
-        /* Demod section in do-while loop so we can repeat once if frame is just outside of bit buffer */
-        do{
-            /* Pull out the frame and demod */
-            memcpy(&frame_samps[0],&sample_buffer[tdma->sample_sync_offset+rdemod_offset],slot_samps*sizeof(COMP));
-
-            /* Demodulate the frame */
-            fsk_demod(fsk,bit_buf,frame_samps);
-
-            off = tdma_search_uw(tdma, bit_buf, nbits, &delta, &uw_type);
-            f_start = off- (frame_bits-uw_len)/2;
-
-            /* Check frame tolerance and sync state*/
-            if(slot->state == rx_sync){
-                f_valid = delta <= tdma->settings.frame_sync_tol;
-            }else if(slot->state == rx_no_sync){
-                f_valid = delta <= tdma->settings.first_sync_tol;
-            }
-
-            /* Calculate offset (in samps) from start of frame */
-            /* Note: FSK outputs one symbol from the last batch, so we have to account for that */
-            i32 target_frame_offset = ((slot_size-frame_size)/2)*Ts;
-            frame_offset = ((f_start-bits_per_sym)*(Ts/bits_per_sym)) - target_frame_offset;
-
-            /* Flag a large frame offset as a bad UW sync */
-            if( abs(frame_offset) > (slot_samps/4) )
-                f_valid = false;
-            
-            if(f_valid && !repeat_demod)
-                slot->slot_local_frame_offset = frame_offset;
-
-
-            /* Check to see if the bits are outside of the demod buffer. If so, adjust and re-demod*/
-            /* Disabled for now; will re-enable when worked out better in head */
-            /* No, this is enabled. I have it more or less worked out */
-            if(f_valid && !repeat_demod){
-                if((f_start < bits_per_sym) || ((f_start+(bits_per_sym*frame_size)) > (bits_per_sym*(slot_size+1)))){
-                    repeat_demod = true;
-                }
-            }else repeat_demod = false;
-
-
-            #ifdef VERY_DEBUG
-            if(repeat_demod){
-                fprintf(stderr,"f_start: %d, Re-demod-ing\n",f_start);
-            }
-            if(f_valid){
-                fprintf(stderr,"Good UW, type %d\n",uw_type);
-            }else{
-                fprintf(stderr,"Bad UW\n");
-            }
-            #endif
-
-            rdemod_offset = frame_offset;
-            
-        }while(repeat_demod);
+        /* The scheduler skips TX slots, but the TX callback may have just ended this one */
+        if(!job->demodded)
+            tdma_demod_slot(tdma,job);
+        f_valid = job->f_valid;
+        if(job->local_offset_valid)
+            slot->slot_local_frame_offset = job->local_offset;
 
         /* Flag indicating whether or not we should call the callback */
         bool do_frame_found_call = false;   
@@ -510,12 +625,25 @@ void tdma_rx_pilot_sync(tdma_t * tdma){
             tdma_deframe_cbcall(bit_buf,tdma->slot_cur,tdma,slot);
         }
 
+        /* Latency from the last sample of the slot arriving to here */
+        slot->rx_demod_us = job->demod_us;
+        slot->rx_latency_us = (f32)(tdma_time_us() - slot->rx_due_us);
+        if(slot->rx_latency_us > slot->rx_latency_us_max)
+            slot->rx_latency_us_max = slot->rx_latency_us;
+        slot->rx_latency_samps = tdma->ring_end - (job->slot_timestamp + slot_samps);
+        slot->rx_demods++;
+
         #ifdef VERY_DEBUG
         /* Unicode underline for pretty printing */
         char underline[] = {0xCC,0xB2,0x00};
-
-        fprintf(stderr,"slot: %d fstart:%d offset: %d delta: %d f1:%.3f EbN0:%f\n",
-            tdma->slot_cur,f_start,off,delta,fsk->f_est[0],fsk->EbNodB);
+        size_t nbits = (slot_size+1)*((mode.fsk_m==2)?1:2);
+        size_t uw_len = mode.uw_len;
+        size_t off = job->off;
+        i32 f_start = job->f_start;
+        u32 frame_bits = mode.frame_size*((mode.fsk_m==2)?1:2);
+
+        fprintf(stderr,"slot: %d fstart:%d offset: %zd delta: %zd f1:%.3f EbN0:%f\n",
+            tdma->slot_cur,f_start,off,job->delta,fsk->f_est[0],fsk->EbNodB);
         for(i=0; i<nbits; i++){
             fprintf(stderr,"%d",bit_buf[i]);
             if((i>off && i<=off+uw_len) || i==f_start || i==(f_start+frame_bits-1)){
@@ -560,15 +688,14 @@ void tdma_rx_pilot_sync(tdma_t * tdma){
             offset_total = offset_slots>0 ? offset_total/offset_slots:0;
             /* Use master slot for timing if available, otherwise take average of all frames */
             if(master_max >= mode.mastersat_min){
-                tdma->sample_sync_offset +=  (offset_master/4);
+                tdma->slot_timestamp +=  (offset_master/4);
                 #ifdef VERY_DEBUG
-                fprintf(stderr,"Syncing to master offset %d\n",tdma->sample_sync_offset);
+                fprintf(stderr,"Syncing to master offset %d\n",offset_master);
                 #endif
             }else{
-                tdma->sample_sync_offset +=  (offset_total/4);
+                tdma->slot_timestamp +=  (offset_total/4);
                 #ifdef VERY_DEBUG
                 fprintf(stderr,"Total Offset:%d\n",offset_total);
-                fprintf(stderr,"Slot offset: %d of %d\n",tdma->sample_sync_offset,slot_samps*n_slots);
                 #endif
             }
             #ifdef VERY_DEBUG
@@ -577,29 +704,203 @@ void tdma_rx_pilot_sync(tdma_t * tdma){
         }
     }
 
+    /* On to the next slot in the timeline */
+    tdma->slot_timestamp += slot_samps;
     tdma->slot_cur++;
     if(tdma->slot_cur >= n_slots)
         tdma->slot_cur = 0;
+}
 
-    
-    /* Compensate for frame timing offset sliding towards the start of buffer */
-    /* Do so by running this again, demodulating two slots, and moving the slot offset one slot forward */
-    if( slot_offset < (slot_samps/4) ){
+/* Number of slots from slot_cur on whose samples, including the quarter slot
+   re-demod margin either side and one symbol past the end, have arrived by ring_end */
+static i64 tdma_slots_due(tdma_t * tdma, i64 ring_end){
+    struct TDMA_MODE_SETTINGS mode = tdma->settings;
+    u32 Ts = mode.samp_rate/mode.sym_rate;
+    i64 slot_samps = mode.slot_size*Ts;
+    i64 need = tdma->slot_timestamp + slot_samps + Ts + slot_samps/4;
+
+    if(ring_end < need) return 0;
+    return (ring_end - need)/slot_samps + 1;
+}
+
+/* Take jobs from the current batch until there are none left */
+static void tdma_pool_work(struct TDMA_POOL * pool){
+    int j;
+    while(1){
+        pthread_mutex_lock(&pool->lock);
+        if(pool->next_job >= pool->n_jobs){
+            pthread_mutex_unlock(&pool->lock);
+            return;
+        }
+        j = pool->next_job++;
+        pthread_mutex_unlock(&pool->lock);
+
+        if(!pool->tdma->rx_jobs[j].skip)
+            tdma_demod_slot(pool->tdma,&pool->tdma->rx_jobs[j]);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->n_done++;
+        if(pool->n_done == pool->n_jobs)
+            pthread_cond_signal(&pool->done_cv);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+static void * tdma_pool_thread(void * arg){
+    struct TDMA_POOL * pool = (struct TDMA_POOL *)arg;
+    pthread_mutex_lock(&pool->lock);
+    while(!pool->quit){
+        if(pool->next_job < pool->n_jobs){
+            pthread_mutex_unlock(&pool->lock);
+            tdma_pool_work(pool);
+            pthread_mutex_lock(&pool->lock);
+        }else{
+            pthread_cond_wait(&pool->work_cv,&pool->lock);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+static struct TDMA_POOL * tdma_pool_create(tdma_t * tdma, u32 n_threads){
+    struct TDMA_POOL * pool = (struct TDMA_POOL *) malloc(sizeof(struct TDMA_POOL));
+    if(pool == NULL) return NULL;
+    pool->threads = (pthread_t *) malloc(sizeof(pthread_t)*n_threads);
+    if(pool->threads == NULL){
+        free(pool);
+        return NULL;
+    }
+    pool->tdma = tdma;
+    pool->n_threads = 0;
+    pool->n_jobs = 0;
+    pool->next_job = 0;
+    pool->n_done = 0;
+    pool->quit = false;
+    pthread_mutex_init(&pool->lock,NULL);
+    pthread_cond_init(&pool->work_cv,NULL);
+    pthread_cond_init(&pool->done_cv,NULL);
+    for(pool->n_threads=0; pool->n_threads<n_threads; pool->n_threads++){
+        if(pthread_create(&pool->threads[pool->n_threads],NULL,tdma_pool_thread,pool) != 0){
+            tdma_pool_destroy(pool);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+static void tdma_pool_destroy(struct TDMA_POOL * pool){
+    u32 i;
+    if(pool == NULL) return;
+    pthread_mutex_lock(&pool->lock);
+    pool->quit = true;
+    pthread_cond_broadcast(&pool->work_cv);
+    pthread_mutex_unlock(&pool->lock);
+    for(i=0; i<pool->n_threads; i++)
+        pthread_join(pool->threads[i],NULL);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_cv);
+    pthread_cond_destroy(&pool->done_cv);
+    free(pool->threads);
+    free(pool);
+}
+
+/* Demod the first n_jobs jobs, on the worker threads and this one if there is a pool */
+static void tdma_run_jobs(tdma_t * tdma, int n_jobs){
+    struct TDMA_POOL * pool = tdma->rx_pool;
+    int j;
+
+    if(pool == NULL || n_jobs < 2){
+        for(j=0; j<n_jobs; j++)
+            if(!tdma->rx_jobs[j].skip)
+                tdma_demod_slot(tdma,&tdma->rx_jobs[j]);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->next_job = 0;
+    pool->n_done = 0;
+    pool->n_jobs = n_jobs;
+    pthread_cond_broadcast(&pool->work_cv);
+    pthread_mutex_unlock(&pool->lock);
+
+    tdma_pool_work(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while(pool->n_done < pool->n_jobs)
+        pthread_cond_wait(&pool->done_cv,&pool->lock);
+    pool->n_jobs = 0;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/* Demodulate, in order, every slot whose samples are all in the sample store.
+   Slots are demodulated rx_batch or more at a time, at most one frame's worth,
+   then their frames are handled and delivered in slot order.
+   Returns the number of slots demodulated */
+int tdma_rx_schedule(tdma_t * tdma){
+    struct TDMA_MODE_SETTINGS mode = tdma->settings;
+    u32 Ts = mode.samp_rate/mode.sym_rate;
+    i64 slot_samps = mode.slot_size*Ts;
+    i64 n_slots = mode.n_slots;
+    /* The demod may shift by up to a quarter slot either way */
+    i64 margin = slot_samps/4;
+    i64 oldest = tdma->ring_end - (i64)tdma->ring_len;
+    i64 n_due, n_jobs, j;
+    int n_demod = 0;
+
+    /* Slots that have already left the store can't be demodulated, skip over them */
+    if(tdma->slot_timestamp - margin < oldest){
+        i64 n_skip = (oldest - (tdma->slot_timestamp - margin) + slot_samps - 1)/slot_samps;
+        tdma->slot_timestamp += n_skip*slot_samps;
+        tdma->slot_cur = (u32)((tdma->slot_cur + n_skip) % n_slots);
         #ifdef VERY_DEBUG
-        fprintf(stderr,"Recursing\n");
+        fprintf(stderr,"Skipping %lld slots\n",(long long)n_skip);
         #endif
-        tdma->sample_sync_offset = tdma->sample_sync_offset + slot_samps;
-        tdma_rx_pilot_sync(tdma);
     }
+
+    n_due = tdma_slots_due(tdma,tdma->ring_end);
+    while(n_due > 0 && n_due >= tdma->rx_batch){
+        n_jobs = n_due < n_slots ? n_due : n_slots;
+        for(j=0; j<n_jobs; j++){
+            struct TDMA_RX_JOB * job = &tdma->rx_jobs[j];
+            job->slot = tdma->slot_table[(tdma->slot_cur + j) % n_slots];
+            job->slot_timestamp = tdma->slot_timestamp + j*slot_samps;
+            job->skip = tdma->ignore_rx_on_tx && job->slot->state == tx_client;
+            job->demodded = false;
+        }
+        tdma_run_jobs(tdma,(int)n_jobs);
+        for(j=0; j<n_jobs; j++){
+            tdma_rx_pilot_sync(tdma,&tdma->rx_jobs[j]);
+            n_demod++;
+        }
+        n_due = tdma_slots_due(tdma,tdma->ring_end);
+    }
+    return n_demod;
+}
+
+int tdma_set_rx_parallel(tdma_t * tdma, u32 n_threads, u32 batch){
+    u32 n_slots = tdma->settings.n_slots;
+
+    tdma_pool_destroy(tdma->rx_pool);
+    tdma->rx_pool = NULL;
+
+    if(batch < 1) batch = 1;
+    if(batch > n_slots) batch = n_slots;
+    tdma->rx_batch = batch;
+
+    if(n_threads == 0) return 0;
+    tdma->rx_pool = tdma_pool_create(tdma,n_threads);
+    return tdma->rx_pool == NULL ? -1 : 0;
 }
 
 /* Attempt at 'plot modem' search for situations where no synchronization is had */
 /* This currently preforms worse than just running tdma_rx_pilot_sync on every frame */
 /* It may still be needed to acquire first frames -- more testing is needed */
 void tdma_rx_no_sync(tdma_t * tdma, COMP * samps, u64 timestamp){
+    #ifdef VERY_DEBUG
     fprintf(stderr,"searching for pilot\n");
+    #endif
     struct TDMA_MODE_SETTINGS mode = tdma->settings;
-    COMP * sample_buffer = tdma->sample_buffer;
+    COMP * pilot_samps;
     u32 Rs = mode.sym_rate;
     u32 Fs = mode.samp_rate;
     u32 slot_size = mode.slot_size;
@@ -623,18 +924,24 @@ void tdma_rx_no_sync(tdma_t * tdma, COMP * samps, u64 timestamp){
     size_t search_offset_i = (3*samps_per_slot)/4;
     size_t best_match_offset = 0;
     u32 best_delta = uw_len;
-    /* Search every half slot at quarter slot offsets */
+    /* Search every half slot at quarter slot offsets. The estimators are cleared
+       and settled on the first half slot once, rather than demodulating every
+       half slot twice */
+    fsk_clear_estimators(fsk);
+    pilot_samps = tdma_get_samples(tdma,tdma->timestamp+search_offset_i,fsk_nin(fsk));
+    if(pilot_samps == NULL) return;
+    fsk_demod(fsk,pilot_bits,pilot_samps);
     for(i = 0; i < 4; i++){
-        fsk_clear_estimators(fsk);
-        fsk_demod(fsk,pilot_bits,&sample_buffer[search_offset_i]);
-        fsk_demod(fsk,pilot_bits,&sample_buffer[search_offset_i]);
+        pilot_samps = tdma_get_samples(tdma,tdma->timestamp+search_offset_i,fsk_nin(fsk));
+        if(pilot_samps == NULL) break;
+        fsk_demod(fsk,pilot_bits,pilot_samps);
         
         offset = tdma_search_uw(tdma, pilot_bits, n_pilot_bits, &delta, NULL);
         f_start = offset - (frame_bits-uw_len)/2;
 
+        #ifdef VERY_DEBUG
         fprintf(stderr,"delta: %zd offset %zd so:%zd\n",delta,offset,search_offset_i);
-        if(delta <= mode.pilot_sync_tol){
-        }
+        #endif
         search_offset_i += samps_per_slot/4;
         if(delta<best_delta){
             best_delta = delta;
@@ -642,16 +949,15 @@ void tdma_rx_no_sync(tdma_t * tdma, COMP * samps, u64 timestamp){
         }
     }
     if(best_delta <= mode.pilot_sync_tol){
+        #ifdef VERY_DEBUG
         fprintf(stderr,"Pilot got UW delta %u search offset %zd\n",best_delta,best_match_offset);
-        tdma->sample_sync_offset = best_match_offset;
-        tdma_rx_pilot_sync(tdma);
+        #endif
+        tdma->slot_timestamp = tdma->timestamp + (i64)best_match_offset;
+        tdma_rx_schedule(tdma);
     }
 
     /*
     Pseudocode:
-        copy into samp buffer 
-            (? may want to let the downstream stuff do this; We may not even really need a local samp buffer)
-            (could/probably should do this in tdma_rx)
         demod a half slot
         look for UW in slot-wide bit buffer
         if UW found
@@ -665,7 +971,6 @@ void tdma_rx_no_sync(tdma_t * tdma, COMP * samps, u64 timestamp){
 }
 
 void tdma_rx(tdma_t * tdma, COMP * samps,u64 timestamp){
-    COMP * sample_buffer = tdma->sample_buffer;
     struct TDMA_MODE_SETTINGS mode = tdma->settings;
     u32 Rs = mode.sym_rate;
     u32 Fs = mode.samp_rate;
@@ -673,17 +978,27 @@ void tdma_rx(tdma_t * tdma, COMP * samps,u64 timestamp){
     u32 n_slots = mode.n_slots;
     u32 Ts = Fs/Rs;
     u32 slot_samps = slot_size*Ts;
+    int n_demod = 0;
+    i64 now = tdma_time_us();
+    i64 n_due, k;
+
+    /* Start the slot timeline at the first samples we get */
+    if(!tdma->ring_started){
+        tdma->ring_end = (i64)timestamp;
+        tdma->slot_timestamp = (i64)timestamp;
+        tdma->ring_started = true;
+    }
+    n_due = tdma_slots_due(tdma,tdma->ring_end);
 
-    /* Copy samples into the local buffer for some reason */
-    /* Move the current samps in the buffer back by a slot or so */
-    size_t move_samps = slot_samps*n_slots*sizeof(COMP);
-    memmove(&sample_buffer[0],&sample_buffer[slot_samps],move_samps);
-
-    move_samps = slot_samps*sizeof(COMP);
-    memcpy(&sample_buffer[n_slots*slot_samps],&samps[0],move_samps);
+    /* Put the samples in the store at their timestamp, nothing already there moves */
+    tdma_put_samples(tdma,samps,slot_samps,(i64)timestamp);
+    if((i64)timestamp + (i64)slot_samps > tdma->ring_end)
+        tdma->ring_end = (i64)timestamp + slot_samps;
+    tdma->timestamp = tdma->ring_end - (i64)tdma->ring_len;
 
-    /* Set the timestamp. Not sure if this makes sense */
-    tdma->timestamp = timestamp - (slot_samps*(n_slots-1));
+    /* Note when slots become ready, for the latency figures */
+    for(k=n_due; k<tdma_slots_due(tdma,tdma->ring_end) && k<n_slots; k++)
+        tdma->slot_table[(tdma->slot_cur + k) % n_slots]->rx_due_us = now;
 
     /* Staate machine for TDMA modem */
     switch(tdma->state){
@@ -693,7 +1008,7 @@ void tdma_rx(tdma_t * tdma, COMP * samps,u64 timestamp){
         //case pilot_sync:
         case slot_sync:
         case master_sync:
-            tdma_rx_pilot_sync(tdma);
+            n_demod = tdma_rx_schedule(tdma);
             break;
         default:
             tdma->state = no_sync;
@@ -726,8 +1041,8 @@ void tdma_rx(tdma_t * tdma, COMP * samps,u64 timestamp){
     }
 
     /* If we have no sync and no idea, nudge slot offset a bit so maybe we'll line up with any active frames */
-    if( (!have_slot_sync) && (tdma->state == no_sync)){
-        tdma->sample_sync_offset += (slot_samps/8);
+    if( (!have_slot_sync) && (tdma->state == no_sync) && (n_demod > 0)){
+        tdma->slot_timestamp += (slot_samps/8);
     }
 }
 
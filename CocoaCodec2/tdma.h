@@ -41,6 +41,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "comp_prim.h"
+#include "uw_search.h"
 
 
 #define TDMA_FRAME_A 3   /* 4800T Frame */
@@ -97,6 +98,14 @@ struct TDMA_SLOT {
     i32 master_count;               /* How likely is this frame to be a synchronization master */
     slot_t * next_slot;             /* Next slot in a linked list of slots */
     bool single_tx;                 /* Are we TXing a single frame? */
+
+    /* RX timing of this slot */
+    u32 rx_demods;                  /* How many times the slot has been received */
+    int64_t rx_due_us;              /* When the last sample of the slot arrived, in us */
+    f32 rx_demod_us;                /* Time taken by the last demod, in us */
+    f32 rx_latency_us;              /* From the last sample arriving to the frame being handled, in us */
+    f32 rx_latency_us_max;          /* Largest rx_latency_us so far */
+    int64_t rx_latency_samps;       /* Samples received after the slot, before it was handled */
 };
 
 /* Structure for tracking basic TDMA modem config */
@@ -140,9 +149,14 @@ struct TDMA_MODEM {
     fsk_t * fsk_pilot;              /* Pilot modem */
     enum tdma_state state;          /* Current state of modem */
     slot_t * slots;                 /* Linked list of slot structs */
+    slot_t ** slot_table;           /* The same slots, indexed by slot number */
     struct TDMA_MODE_SETTINGS settings; /* Basic TDMA config parameters */
-    COMP * sample_buffer;           /* Buffer of incoming samples */
-    i32 sample_sync_offset;     /* Offset into the sample buffer where slot 0 starts */
+    COMP * sample_buffer;           /* Circular store of incoming samples, indexed by timestamp modulo
+                                        ring_len and written twice so any ring_len samples are contiguous */
+    size_t ring_len;                /* Number of samples kept in sample_buffer */
+    int64_t ring_end;               /* Timestamp one past the newest sample in sample_buffer */
+    bool ring_started;              /* Have any samples been received yet? */
+    int64_t slot_timestamp;         /* Timestamp where slot slot_cur starts, the next slot to demod */
     int64_t timestamp;             /* Timestamp of oldest sample in samp buffer */
     int64_t loop_delay;             /* Static offset applied to timestamp when scheduling 
                                         TX frames to account for delays in DSP and radio hardware */
@@ -160,6 +174,11 @@ struct TDMA_MODEM {
     size_t master_bit_pos;          /* Where in the frame can we find the master indicator bit? */
     uint8_t uw_types;               /* How many different UWs does this framing format use? pulled from frame_type */
     uint8_t ** uw_list;             /* Pointer to list of valid UWs */
+    struct UW_SEARCH uw_packed[2];  /* The same UWs, packed for tdma_search_uw */
+
+    struct TDMA_RX_JOB * rx_jobs;   /* Demod jobs, one per slot */
+    struct TDMA_POOL * rx_pool;     /* Worker threads for the slot demods, or NULL */
+    u32 rx_batch;                   /* Slots to collect before demodulating */
     
 
 };
@@ -175,11 +194,24 @@ void tdma_destroy(tdma_t * tdma);
 u32 tdma_get_N(tdma_t * tdma);
 
 /**
- Put 1 slot's worth of samples into the TDMA modem
- TODO: I'm still not entirely sure of what I want the semantics of this to look like
+ Put 1 slot's worth of samples into the TDMA modem. timestamp is that of samps[0]
+ and should increase by tdma_nin() each call; a gap leaves stale samples in the
+ store, and slots that fall out of it entirely are skipped. Every slot whose
+ samples have all arrived is demodulated once, in order, so a call may demod
+ zero, one or more slots.
 */
 void tdma_rx(tdma_t * tdma, COMP * samps,u64 timestamp);
 
+/*
+ Demodulate slots on n_threads worker threads as well as the calling thread, or
+ just the calling thread if n_threads is 0. The scheduler waits until batch slots
+ (at most n_slots) are ready and demods them together, so a larger batch gives
+ the workers more to share at the cost of up to batch-1 slots more latency.
+ Frames are still delivered to the RX callback in slot order, from the thread
+ calling tdma_rx(). Returns 0, or -1 if the threads could not be started.
+*/
+int tdma_set_rx_parallel(tdma_t * tdma, u32 n_threads, u32 batch);
+
 /* Set the RX callback function */
 void tdma_set_rx_cb(tdma_t * tdma,tdma_cb_rx_frame rx_callback,void * cb_data);
 
@@ -207,5 +239,9 @@ size_t tdma_nout(tdma_t * tdma);
 /* Convience function to look up a slot from it's index number */
 slot_t * tdma_get_slot(tdma_t * tdma, u32 slot_idx);
 
+/* Pointer to n_samps contiguous samples starting at timestamp, or NULL if they
+   are not all in the sample store */
+COMP * tdma_get_samples(tdma_t * tdma, int64_t timestamp, size_t n_samps);
+
 
 #endif
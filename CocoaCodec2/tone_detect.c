@@ -0,0 +1,187 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: tone_detect.c
+  DATE CREATED: October 2026
+
+  Cheap signal presence detector, see tone_detect.h.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License version 2.1, as
+  published by the Free Software Foundation.  This program is
+  distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "tone_detect.h"
+
+#define NOISE_ALPHA (1.0/16.0)  /* noise floor time constant, in blocks */
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: gamma_tail
+  DATE CREATED: October 2026
+
+  Chance that the sum of k unit mean exponential variables exceeds t,
+  e^-t sum_{i<k} t^i/i!.  With noise only, each Goertzel bin power over
+  the noise floor is one such variable.
+
+\*---------------------------------------------------------------------------*/
+
+static double gamma_tail(int k, double t)
+{
+    double term = 1.0, sum = 1.0;
+    int i;
+
+    for(i=1; i<k; i++) {
+        term *= t/i;
+        sum += term;
+    }
+    return exp(-t)*sum;
+}
+
+/* bisect for the threshold with the requested false alarm rate */
+
+static float pfa_thresh(int k, float pfa)
+{
+    double lo = 0.0, hi = 1.0;
+    int i;
+
+    while(gamma_tail(k, hi) > pfa)
+        hi *= 2.0;
+    for(i=0; i<50; i++) {
+        double mid = 0.5*(lo + hi);
+        if (gamma_tail(k, mid) > pfa)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return hi;
+}
+
+
+struct TONE_DETECT *tone_detect_create(int fs, int n, const float tone_hz[], int ntones,
+                                       const float ref_hz[], int nref, float pfa)
+{
+    struct TONE_DETECT *d;
+    int i;
+
+    assert((fs > 0) && (n > 0));
+    assert((pfa > 0.0) && (pfa < 1.0));
+    if ((ntones < 1) || (ntones > TONE_DETECT_MAX_TONES) || (nref < 1) || (nref > TONE_DETECT_MAX_REF))
+        return NULL;
+
+    d = (struct TONE_DETECT*)malloc(sizeof(struct TONE_DETECT));
+    if (d == NULL)
+        return NULL;
+
+    d->n = n;
+    d->ntones = ntones;
+    d->nref = nref;
+    for(i=0; i<ntones; i++)
+        d->coeff[i] = 2.0*cosf(2.0*M_PI*tone_hz[i]/fs);
+    for(i=0; i<nref; i++)
+        d->coeff[ntones+i] = 2.0*cosf(2.0*M_PI*ref_hz[i]/fs);
+    d->thresh = pfa_thresh(ntones, pfa);
+    d->hang = TONE_DETECT_HANG*fs;
+    tone_detect_reset(d);
+
+    return d;
+}
+
+
+void tone_detect_destroy(struct TONE_DETECT *d)
+{
+    free(d);
+}
+
+
+void tone_detect_reset(struct TONE_DETECT *d)
+{
+    int i;
+
+    for(i=0; i<d->ntones+d->nref; i++)
+        d->s1[i] = d->s2[i] = 0.0;
+    d->count = 0;
+    d->noise = 0.0;
+    d->noise_valid = 0;
+    d->hold = 0;
+    d->detected = 1;
+    d->stat = 0.0;
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: tone_detect_block
+  DATE CREATED: October 2026
+
+  Ends a Goertzel block.  The tone bin powers are summed and scaled by
+  the noise floor, which is then updated from this block's reference
+  bins, so a signal turning up can't raise the floor it is compared to.
+
+\*---------------------------------------------------------------------------*/
+
+static void tone_detect_block(struct TONE_DETECT *d)
+{
+    float p[TONE_DETECT_MAX_TONES+TONE_DETECT_MAX_REF];
+    float tone = 0.0, ref = 0.0;
+    int i;
+
+    for(i=0; i<d->ntones+d->nref; i++) {
+        p[i] = d->s1[i]*d->s1[i] + d->s2[i]*d->s2[i] - d->coeff[i]*d->s1[i]*d->s2[i];
+        d->s1[i] = d->s2[i] = 0.0;
+    }
+    for(i=0; i<d->ntones; i++)
+        tone += p[i];
+    for(i=0; i<d->nref; i++)
+        ref += p[d->ntones+i];
+    ref /= d->nref;
+
+    if (d->noise_valid) {
+        d->stat = tone/(d->noise + 1E-12);
+        if (d->stat > d->thresh)
+            d->hold = d->hang;
+        d->noise = (1.0 - NOISE_ALPHA)*d->noise + NOISE_ALPHA*ref;
+    }
+    else {
+        d->noise = ref;
+        d->noise_valid = 1;
+        d->hold = d->hang;
+    }
+}
+
+
+int tone_detect_update(struct TONE_DETECT *d, const void *in, const struct MODEM_IO *io, int nin)
+{
+    int i, j;
+
+    for(i=0; i<nin; i++) {
+        float x = modem_io_get(io, in, i).real;
+
+        for(j=0; j<d->ntones+d->nref; j++) {
+            float s0 = x + d->coeff[j]*d->s1[j] - d->s2[j];
+            d->s2[j] = d->s1[j];
+            d->s1[j] = s0;
+        }
+        if (++d->count == d->n) {
+            d->count = 0;
+            tone_detect_block(d);
+        }
+        if (d->hold > 0)
+            d->hold--;
+    }
+
+    d->detected = d->hold > 0;
+    return d->detected;
+}
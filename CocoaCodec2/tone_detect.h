@@ -0,0 +1,72 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: tone_detect.h
+  DATE CREATED: October 2026
+
+  Cheap signal presence detector.  Goertzel filters measure the power
+  at a modem's carrier frequencies and at reference frequencies just
+  outside its band, and a signal is declared when the carrier power
+  stands far enough above the noise floor measured at the references.
+  Run ahead of a modem's sync search, it lets an idle channel skip the
+  full acquisition on every frame.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License version 2.1, as
+  published by the Free Software Foundation.  This program is
+  distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __TONE_DETECT__
+#define __TONE_DETECT__
+
+#include "modem_io.h"
+
+#define TONE_DETECT_MAX_TONES 32   /* carrier bins                      */
+#define TONE_DETECT_MAX_REF   8    /* noise reference bins              */
+#define TONE_DETECT_HANG      1.0  /* seconds held after last detection */
+
+struct TONE_DETECT {
+    int   n;                                /* Goertzel block length in samples   */
+    int   ntones, nref;
+    float coeff[TONE_DETECT_MAX_TONES+TONE_DETECT_MAX_REF]; /* tones then refs    */
+    float s1[TONE_DETECT_MAX_TONES+TONE_DETECT_MAX_REF];
+    float s2[TONE_DETECT_MAX_TONES+TONE_DETECT_MAX_REF];
+    int   count;                            /* samples into the current block     */
+    float thresh;                           /* on stat, from the false alarm rate */
+    float noise;                            /* mean power in one reference bin    */
+    int   noise_valid;
+    int   hang, hold;                       /* samples to keep detected           */
+    int   detected;
+    float stat;                             /* last block's tone power over noise */
+};
+
+/*
+ * Detector for tones at tone_hz[] with the noise floor measured at
+ * ref_hz[], both in Hz at sample rate fs, taking n sample blocks.  pfa
+ * is the chance of a false alarm on each block of noise alone.  Returns
+ * NULL if there are too many tones or references.
+ */
+struct TONE_DETECT *tone_detect_create(int fs, int n, const float tone_hz[], int ntones,
+                                       const float ref_hz[], int nref, float pfa);
+void tone_detect_destroy(struct TONE_DETECT *d);
+
+/* Forget the noise floor and any detection */
+void tone_detect_reset(struct TONE_DETECT *d);
+
+/*
+ * Run nin samples in format io (real part only) through the detector.
+ * Returns 1 if a signal was present in any block finished in the last
+ * TONE_DETECT_HANG seconds, and until the noise floor has been measured.
+ */
+int tone_detect_update(struct TONE_DETECT *d, const void *in, const struct MODEM_IO *io, int nin);
+
+#endif
@@ -0,0 +1,174 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: uw_search.c
+  DATE CREATED: October 2026
+
+  Unique word search over unpacked bit streams.  Received bits are
+  shifted into a register as wide as the UW, so each candidate offset
+  costs one shift, XOR and popcount per 64 bits of UW rather than a
+  compare per UW bit.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License version 2.1, as
+  published by the Free Software Foundation.  This program is
+  distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <string.h>
+
+#include "uw_search.h"
+
+static inline int popcount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/* mask of the bits used in the most significant word */
+
+static inline uint64_t top_mask(const struct UW_SEARCH *u) {
+    int nbits = u->len - 64*(u->nwords - 1);
+    return (nbits == 64) ? ~0ULL : (1ULL << nbits) - 1;
+}
+
+/* shift one bit into the bottom of a multi-word register */
+
+static inline void shift_in(uint64_t reg[], int nwords, uint64_t mask, uint8_t bit) {
+    int w;
+    for(w=nwords-1; w>0; w--)
+        reg[w] = (reg[w] << 1) | (reg[w-1] >> 63);
+    reg[0] = (reg[0] << 1) | (bit & 1);
+    reg[nwords-1] &= mask;
+}
+
+static inline int reg_errors(const struct UW_SEARCH *u, const uint64_t reg[]) {
+    int w, errors = 0;
+    for(w=0; w<u->nwords; w++)
+        errors += popcount64(reg[w] ^ u->uw[w]);
+    return errors;
+}
+
+
+void uw_search_init(struct UW_SEARCH *u, const uint8_t uw[], int len)
+{
+    uint64_t mask;
+    int i;
+
+    assert((len > 0) && (len <= UW_SEARCH_MAX_LEN));
+    u->len = len;
+    u->nwords = (len + 63)/64;
+    memset(u->uw, 0, sizeof(u->uw));
+    mask = top_mask(u);
+    for(i=0; i<len; i++) {
+        shift_in(u->uw, u->nwords, mask, uw[i]);
+        u->uw_sign[i] = uw[i] ? 1.0 : -1.0;
+    }
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: uw_search_best
+  DATE CREATED: October 2026
+
+  Slides the UW along bits[], keeping the last len received bits in a
+  register.  Stops early on an exact match, as no later offset can
+  replace it.
+
+\*---------------------------------------------------------------------------*/
+
+int uw_search_best(const struct UW_SEARCH *u, const uint8_t bits[], int n_offsets, int step, int *errors_out)
+{
+    uint64_t reg[UW_SEARCH_MAX_WORDS] = {0};
+    uint64_t mask = top_mask(u);
+    int len = u->len;
+    int best = len, best_offset = 0;
+    int offset, errors, filled = 0;
+
+    assert(step > 0);
+
+    if (u->nwords == 1) {
+        uint64_t r = 0, uw = u->uw[0];
+
+        for(offset=0; offset<n_offsets; offset+=step) {
+            while(filled < offset+len)
+                r = (r << 1) | (bits[filled++] & 1);
+            errors = popcount64((r & mask) ^ uw);
+            if (errors < best) {
+                best = errors;
+                best_offset = offset;
+                if (errors == 0)
+                    break;
+            }
+        }
+    }
+    else {
+        for(offset=0; offset<n_offsets; offset+=step) {
+            while(filled < offset+len)
+                shift_in(reg, u->nwords, mask, bits[filled++]);
+            errors = reg_errors(u, reg);
+            if (errors < best) {
+                best = errors;
+                best_offset = offset;
+                if (errors == 0)
+                    break;
+            }
+        }
+    }
+
+    if (errors_out != NULL)
+        *errors_out = best;
+    return best_offset;
+}
+
+
+int uw_search_tol(const struct UW_SEARCH *u, const uint8_t bits[], int n_offsets, int step, int tol, int *errors_out)
+{
+    int errors;
+    int offset = uw_search_best(u, bits, n_offsets, step, &errors);
+
+    if (errors_out != NULL)
+        *errors_out = errors;
+    return (errors <= tol) ? offset : -1;
+}
+
+
+int uw_search_errors_packed(const struct UW_SEARCH *u, const uint64_t bits[])
+{
+    return reg_errors(u, bits);
+}
+
+
+int uw_search_soft(const struct UW_SEARCH *u, const float sd[], int n_offsets, int step, float *corr_out)
+{
+    int   offset, j, best_offset = 0;
+    float corr, best = 0.0;
+
+    for(offset=0; offset<n_offsets; offset+=step) {
+        corr = 0.0;
+        for(j=0; j<u->len; j++)
+            corr += sd[offset+j]*u->uw_sign[j];
+        if ((offset == 0) || (corr > best)) {
+            best = corr;
+            best_offset = offset;
+        }
+    }
+
+    if (corr_out != NULL)
+        *corr_out = best;
+    return best_offset;
+}
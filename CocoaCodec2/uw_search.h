@@ -0,0 +1,66 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: uw_search.h
+  DATE CREATED: October 2026
+
+  Unique word search over unpacked bit streams, shared by the Horus, TDMA
+  and VHF framing receivers.  The UW is packed into 64 bit words and
+  compared with a shift register of received bits using XOR and popcount.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License version 2.1, as
+  published by the Free Software Foundation.  This program is
+  distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __UW_SEARCH__
+#define __UW_SEARCH__
+
+#include <stdint.h>
+
+#define UW_SEARCH_MAX_LEN   128
+#define UW_SEARCH_MAX_WORDS ((UW_SEARCH_MAX_LEN+63)/64)
+
+struct UW_SEARCH {
+    int      len;                          /* UW length in bits                     */
+    int      nwords;                       /* 64 bit words used in uw[]             */
+    uint64_t uw[UW_SEARCH_MAX_WORDS];      /* first UW bit is the MSB of the last   */
+                                           /* word, the last UW bit is bit 0 of uw[0] */
+    float    uw_sign[UW_SEARCH_MAX_LEN];   /* UW mapped to +/-1, for soft decisions */
+};
+
+/* Pack len unpacked UW bits, len must not exceed UW_SEARCH_MAX_LEN */
+void uw_search_init(struct UW_SEARCH *u, const uint8_t uw[], int len);
+
+/*
+ * Compare the UW with bits[offset ... offset+len-1] for offset = 0, step,
+ * 2*step ... while offset < n_offsets, so bits[] must hold at least
+ * n_offsets+len-1 bits.  Returns the first offset with the fewest bit
+ * errors, or 0 if none has fewer than len, with that number of errors in
+ * *errors_out (if not NULL).
+ */
+int uw_search_best(const struct UW_SEARCH *u, const uint8_t bits[], int n_offsets, int step, int *errors_out);
+
+/* As uw_search_best(), but returns -1 unless the best offset has at most tol errors */
+int uw_search_tol(const struct UW_SEARCH *u, const uint8_t bits[], int n_offsets, int step, int tol, int *errors_out);
+
+/* Bit errors between the UW and bits packed as in struct UW_SEARCH, nwords words */
+int uw_search_errors_packed(const struct UW_SEARCH *u, const uint64_t bits[]);
+
+/*
+ * Soft decision search, sd[] > 0 for a one.  Returns the first offset with
+ * the largest correlation of sd[] with the UW mapped to +/-1, and the
+ * correlation in *corr_out (if not NULL).
+ */
+int uw_search_soft(const struct UW_SEARCH *u, const float sd[], int n_offsets, int step, float *corr_out);
+
+#endif
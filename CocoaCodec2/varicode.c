@@ -28,168 +28,133 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <pthread.h>
 #include "varicode.h"
 #include "varicode_table.h"
 
 
 /*
-  output is an unpacked array of bits of maximum size max_out.  Note
-  unpacked arrays are a more suitable form for modulator input.
-
-  Code 1 covers the entire ASCII char set.
+  Both codes are decoded by one state machine.  Its states are those
+  of the bit serial decoders below (decode_one_bit() and
+  decode_two_bits()), with every partial code that can no longer match
+  a table entry merged into one state per length, which leaves a few
+  hundred states for the two codes together.  The transition tables
+  are built from the bit serial decoders the first time a decoder is
+  initialised, so they cannot drift from them.
+
+  Each entry holds the next state, the number of characters completed
+  and the characters themselves.  The nibble table moves four bits at
+  a time, packed input costs two lookups per byte and no table search.
 */
 
-int varicode_encode1(short varicode_out[], char ascii_in[], int max_out, int n_in) {
-    int            n_out, index, n_zeros, v_len;
-    unsigned short byte1, byte2, packed;
-    char           c;
-    
-    n_out = 0;
+#define VARICODE_DFA_STATES 512
 
-    while(n_in && (n_out < max_out)) {
+#define VARICODE_DFA_NEXT(e)    ((e) & 0x3ff)
+#define VARICODE_DFA_NOUT(e)    (((e) >> 10) & 0x3)
+#define VARICODE_DFA_CHAR(e, i) (((e) >> (12 + 7*(i))) & 0x7f)
 
-        c = *ascii_in;
-        if ((unsigned int)c >= 128) {
-            c = ' ';
-        }
+static uint32_t varicode_dfa_bit[VARICODE_DFA_STATES][2];
+static uint32_t varicode_dfa_nibble[VARICODE_DFA_STATES][16];
+static int      varicode_dfa_idle[3];            /* start state of each code */
 
-        index = 2*(unsigned int)(c);
-        assert(index <= 254);
-        byte1 = varicode_table1[index];
-        byte2 = varicode_table1[index+1];
-        packed = (byte1 << 8) + byte2;
+/* Code words MSB first, and their length including the two zero bits at the end */
 
-        //printf("n_in: %d ascii_in: %c index: %d packed 0x%x\n", n_in, *ascii_in, index, packed);
-        ascii_in++;
+static unsigned short varicode_enc_word[2][256];
+static unsigned char  varicode_enc_len[2][256];
 
-        n_zeros = 0;
-        v_len = 0;
-        while ((n_zeros < 2) && (n_out < max_out) && (v_len <= VARICODE_MAX_BITS)) {
-            if (packed & 0x8000) {
-                *varicode_out = 1;
-                n_zeros = 0;
-            }
-            else {
-                *varicode_out = 0;
-                n_zeros++;
-            }
-            //printf("packed: 0x%x *varicode_out: %d n_zeros: %d v_len: %d\n", packed, *varicode_out, n_zeros,v_len );
-            packed <<= 1;
-            varicode_out++;
-            n_out++;
-            v_len++;
-        }
-        assert(v_len <= VARICODE_MAX_BITS);
+static pthread_once_t varicode_once = PTHREAD_ONCE_INIT;
 
-        n_in--;
-    }
+/* state of the bit serial decoders */
 
-    return n_out;
+struct varicode_ref {
+    int            code_num;
+    int            state;
+    int            n_zeros;
+    int            v_len;
+    unsigned short packed;
+    int            n_in;
+    int            in[2];
+};
+
+static void varicode_ref_init(struct varicode_ref *s, int code_num)
+{
+    s->code_num = code_num;
+    s->state = 0;
+    s->n_zeros = 0;
+    s->v_len = 0;
+    s->packed = 0;
+    s->n_in = 0;
+    s->in[0] = s->in[1] = 0;
 }
 
 
 /*
+  Code word length for each character.  Code 1 covers the entire ASCII
+  char set, characters from 128 up are sent as spaces.
+
   Code 2 covers a subset, but is more efficient that Code 1 (282
-  compared to 1315 bits on unittest) Unsupported characters are
-  replaced by spaces.  We encode/decode two bits at a time.
+  compared to 1315 bits on unittest).  It is sent two bits at a time.
+  Unsupported characters start from varicode_table2[0] unshifted, so
+  are sent as a single pair of zeros.
 */
 
-int varicode_encode2(short varicode_out[], char ascii_in[], int max_out, int n_in) {
-    int            n_out, n_zeros, v_len, i;
-    unsigned short packed;
-
-    n_out = 0;
-
-    while(n_in && (n_out < max_out)) {
+static void varicode_encode_init(void)
+{
+    int            c, i, n_zeros, v_len;
+    unsigned short packed, word;
 
-        packed = varicode_table2[0]; // default to space if char not found
+    for(c=0; c<256; c++) {
+        i = (c < 128) ? c : ' ';
+        packed = (varicode_table1[2*i] << 8) + varicode_table1[2*i+1];
+        word = 0;
+        n_zeros = 0;
+        v_len = 0;
+        while ((n_zeros < 2) && (v_len <= VARICODE_MAX_BITS)) {
+            if (packed & 0x8000) {
+                word |= 0x8000 >> v_len;
+                n_zeros = 0;
+            }
+            else
+                n_zeros++;
+            packed <<= 1;
+            v_len++;
+        }
+        assert(v_len <= VARICODE_MAX_BITS);
+        varicode_enc_word[0][c] = word;
+        varicode_enc_len[0][c] = v_len;
 
-        // see if our character exists
+        packed = varicode_table2[0];
         for(i=0; i<sizeof(varicode_table2); i+=2) {
-            if (varicode_table2[i] == *ascii_in)
+            if (varicode_table2[i] == (char)c)
                 packed = (unsigned short)varicode_table2[i+1] << 8;
         }
-
-        //printf("n_in: %d ascii_in: %c index: %d packed 0x%x\n", n_in, *ascii_in, index, packed);
-        ascii_in++;
-
+        word = 0;
         n_zeros = 0;
         v_len = 0;
-        while ((n_zeros < 2) && (n_out < max_out) && (v_len <= VARICODE_MAX_BITS)) {
-            if (packed & 0x8000)
-                varicode_out[0] = 1;
-            else
-                varicode_out[0] = 0;
-
-            if (packed & 0x4000)
-                varicode_out[1] = 1;
-            else
-                varicode_out[1] = 0;
-
+        while ((n_zeros < 2) && (v_len <= VARICODE_MAX_BITS)) {
+            word |= (packed & 0xc000) >> v_len;
             if (packed & 0xc000)
                 n_zeros = 0;
             else
                 n_zeros += 2;
-
-            //printf("packed: 0x%x *varicode_out: %d n_zeros: %d v_len: %d\n", packed, *varicode_out, n_zeros,v_len );
             packed <<= 2;
-            varicode_out +=2;
-            n_out += 2;
             v_len += 2;
         }
         assert(v_len <= VARICODE_MAX_BITS);
-
-        n_in--;
+        varicode_enc_word[1][c] = word;
+        varicode_enc_len[1][c] = v_len;
     }
-
-    assert((n_out % 2) == 0);  /* outputs two bits at a time */
-
-    return n_out;
-}
-
-
-int varicode_encode(short varicode_out[], char ascii_in[], int max_out, int n_in, int code_num) {
-
-    assert((code_num ==1) || (code_num ==2));
-
-    if (code_num == 1)
-        return varicode_encode1(varicode_out, ascii_in, max_out, n_in);
-    else
-       return  varicode_encode2(varicode_out, ascii_in, max_out, n_in);
-}
-
-
-void varicode_decode_init(struct VARICODE_DEC *dec_states, int code_num)
-{
-    assert((code_num ==1) || (code_num == 2));
-
-    dec_states->state = 0;
-    dec_states->n_zeros = 0;
-    dec_states->v_len = 0;
-    dec_states->packed = 0;
-    dec_states->code_num = code_num;
-    dec_states->n_in = 0;
-    dec_states->in[0] = dec_states->in[1] = 0;
-}
-
-
-void varicode_set_code_num(struct VARICODE_DEC *dec_states, int code_num)
-{
-    assert((code_num == 1) || (code_num == 2));
-    dec_states->code_num = code_num;
 }
 
 
 /* Code 1 decode function, accepts one bit at a time */
 
-static int decode_one_bit(struct VARICODE_DEC *s, char *single_ascii, short varicode_in, int long_code)
+static int decode_one_bit(struct varicode_ref *s, char *single_ascii, short varicode_in)
 {
     int            found=0, i;
     unsigned short byte1, byte2;
 
-    //printf("decode_one_bit : state: %d varicode_in: %d packed: 0x%x n_zeros: %d\n",
-    //       s->state, varicode_in, s->packed, s->n_zeros);
-
     if (s->state == 0) {
         if (!varicode_in)
             return 0;
@@ -215,7 +180,6 @@ static int decode_one_bit(struct VARICODE_DEC *s, char *single_ascii, short vari
                 /* run thru table but note with bit errors we might not actually find a match */
 
                 byte1 = s->packed >> 8;
-                //printf("looking for byte1 : 0x%x ... ", byte1);
                 byte2 = s->packed & 0xff;
 
                 for(i=0; i<128; i++) {
@@ -225,13 +189,13 @@ static int decode_one_bit(struct VARICODE_DEC *s, char *single_ascii, short vari
                     }
                 }
             }
-            varicode_decode_init(s, s->code_num);
+            varicode_ref_init(s, s->code_num);
         }
 
         /* code can run too long if we have a bit error */
 
         if (s->v_len > VARICODE_MAX_BITS)
-            varicode_decode_init(s, s->code_num);
+            varicode_ref_init(s, s->code_num);
     }
 
     return found;
@@ -240,7 +204,7 @@ static int decode_one_bit(struct VARICODE_DEC *s, char *single_ascii, short vari
 
 /* Code 2 decode function, accepts two bits at a time */
 
-static int decode_two_bits(struct VARICODE_DEC *s, char *single_ascii, short varicode_in1, short varicode_in2)
+static int decode_two_bits(struct varicode_ref *s, char *single_ascii, short varicode_in1, short varicode_in2)
 {
     int            found=0, i;
     unsigned short byte1;
@@ -273,92 +237,346 @@ static int decode_two_bits(struct VARICODE_DEC *s, char *single_ascii, short var
                 /* run thru table but note with bit errors we might not actually find a match */
 
                 byte1 = s->packed >> 8;
-                //printf("looking for byte1 : 0x%x ... ", byte1);
                 for(i=0; i<sizeof(varicode_table2); i+=2) {
-                    //printf("byte1: 0x%x 0x%x\n", byte1, (unsigned char)varicode_table2[i+1]);
                     if (byte1 == (unsigned char)varicode_table2[i+1]) {
                         found = 1;
                         *single_ascii = varicode_table2[i];
-                        //printf("found: %d i=%d char=%c ", found, i, *single_ascii);
                     }
                 }
             }
-            varicode_decode_init(s, s->code_num);
+            varicode_ref_init(s, s->code_num);
         }
 
         /* code can run too long if we have a bit error */
 
         if (s->v_len > VARICODE_MAX_BITS)
-            varicode_decode_init(s, s->code_num);
+            varicode_ref_init(s, s->code_num);
     }
 
     return found;
 }
 
 
-int varicode_decode1(struct VARICODE_DEC *dec_states, char ascii_out[], short varicode_in[], int max_out, int n_in) {
-    int            output, n_out;
-    char           single_ascii = 0;
+/* One bit through the bit serial decoder of either code, code 2 keeps a two bit buffer */
 
-    n_out = 0;
+static int varicode_ref_bit(struct varicode_ref *s, char *single_ascii, int bit)
+{
+    if (s->code_num == 1)
+        return decode_one_bit(s, single_ascii, bit);
+
+    s->in[0] = s->in[1];
+    s->in[1] = bit;
+    s->n_in++;
+    if (s->n_in == 2) {
+        s->n_in = 0;
+        return decode_two_bits(s, single_ascii, s->in[0], s->in[1]);
+    }
+    return 0;
+}
 
-    //printf("varicode_decode: n_in: %d\n", n_in);
 
-    while(n_in && (n_out < max_out)) {
-        output = decode_one_bit(dec_states, &single_ascii, varicode_in[0], 0);
-        varicode_in++;
-        n_in--;
+/*
+  Decoder states that behave the same get the same key.  Code 2 only
+  looks at the first byte of a code, and a partial code that matches no
+  table entry can never produce a character, so only its length and
+  trailing zeros matter.
+*/
+
+struct varicode_key {
+    int code_num, state, n_zeros, v_len, n_in, in1, packed;
+};
+
+static void varicode_ref_key(const struct varicode_ref *s, struct varicode_key *k)
+{
+    unsigned short mask, packed;
+    int            i, live;
+
+    memset(k, 0, sizeof(*k));
+    k->code_num = s->code_num;
+    k->n_in = s->n_in;
+    if (s->n_in == 1)
+        k->in1 = (s->in[1] != 0);
+    if (s->state == 0)
+        return;
+
+    k->state = s->state;
+    k->n_zeros = s->n_zeros;
+    k->v_len = s->v_len;
+
+    mask = 0xffff << (16 - s->v_len);
+    live = 0;
+    if (s->code_num == 1) {
+        packed = s->packed;
+        for(i=0; i<128; i++)
+            if ((((varicode_table1[2*i] << 8) | varicode_table1[2*i+1]) & mask) == (packed & mask))
+                live = 1;
+    }
+    else {
+        packed = s->packed & 0xff00;
+        for(i=0; i<sizeof(varicode_table2); i+=2)
+            if ((((unsigned char)varicode_table2[i+1] << 8) & mask) == (packed & mask))
+                live = 1;
+    }
+    k->packed = live ? packed : -1;
+}
+
+static int varicode_dfa_state(struct varicode_ref states[], struct varicode_key keys[], int *n_states,
+                              const struct varicode_ref *s)
+{
+    struct varicode_key k;
+    int                 i;
+
+    varicode_ref_key(s, &k);
+    for(i=0; i<*n_states; i++)
+        if (memcmp(&keys[i], &k, sizeof(k)) == 0)
+            return i;
+
+    assert(*n_states < VARICODE_DFA_STATES);
+    states[i] = *s;
+    keys[i] = k;
+    (*n_states)++;
+    return i;
+}
+
 
-        if (output) {
-            *ascii_out++ = single_ascii;
+/* Explore every state reachable from idle with the bit serial decoders, then chain bits into nibbles */
+
+static void varicode_init(void)
+{
+    struct varicode_ref *states;
+    struct varicode_key *keys;
+    struct varicode_ref  s;
+    int                  n_states, i, bit, code_num, nibble, next, nout;
+    char                 single_ascii;
+    uint32_t             e;
+
+    varicode_encode_init();
+
+    states = (struct varicode_ref*)malloc(sizeof(struct varicode_ref)*VARICODE_DFA_STATES);
+    keys = (struct varicode_key*)malloc(sizeof(struct varicode_key)*VARICODE_DFA_STATES);
+    assert((states != NULL) && (keys != NULL));
+
+    n_states = 0;
+    for(code_num=1; code_num<=2; code_num++) {
+        varicode_ref_init(&s, code_num);
+        varicode_dfa_idle[code_num] = varicode_dfa_state(states, keys, &n_states, &s);
+    }
+
+    for(i=0; i<n_states; i++) {
+        for(bit=0; bit<2; bit++) {
+            s = states[i];
+            single_ascii = 0;
+            nout = varicode_ref_bit(&s, &single_ascii, bit);
+            next = varicode_dfa_state(states, keys, &n_states, &s);
+            varicode_dfa_bit[i][bit] = next | (nout << 10) | ((uint32_t)(single_ascii & 0x7f) << 12);
+        }
+    }
+
+    for(i=0; i<n_states; i++) {
+        for(nibble=0; nibble<16; nibble++) {
+            next = i;
+            nout = 0;
+            e = 0;
+            for(bit=3; bit>=0; bit--) {
+                uint32_t eb = varicode_dfa_bit[next][(nibble >> bit) & 1];
+                if (VARICODE_DFA_NOUT(eb)) {
+                    assert(nout < 2);
+                    e |= VARICODE_DFA_CHAR(eb, 0) << (12 + 7*nout);
+                    nout++;
+                }
+                next = VARICODE_DFA_NEXT(eb);
+            }
+            varicode_dfa_nibble[i][nibble] = e | next | (nout << 10);
+        }
+    }
+
+    free(states);
+    free(keys);
+}
+
+
+/*
+  output is an unpacked array of bits of maximum size max_out.  Note
+  unpacked arrays are a more suitable form for modulator input.
+*/
+
+int varicode_encode1(short varicode_out[], char ascii_in[], int max_out, int n_in) {
+    int            n_out, i, v_len;
+    unsigned short word;
+    unsigned char  c;
+
+    pthread_once(&varicode_once, varicode_init);
+
+    n_out = 0;
+
+    while(n_in && (n_out < max_out)) {
+        c = *ascii_in++;
+        word = varicode_enc_word[0][c];
+        v_len = varicode_enc_len[0][c];
+        for(i=0; (i<v_len) && (n_out < max_out); i++) {
+            *varicode_out++ = (word >> (15 - i)) & 1;
             n_out++;
         }
+        n_in--;
     }
 
     return n_out;
 }
 
 
-int varicode_decode2(struct VARICODE_DEC *dec_states, char ascii_out[], short varicode_in[], int max_out, int n_in) {
-    int            output, n_out;
-    char           single_ascii = 0;
+int varicode_encode2(short varicode_out[], char ascii_in[], int max_out, int n_in) {
+    int            n_out, i, v_len;
+    unsigned short word;
+    unsigned char  c;
+
+    pthread_once(&varicode_once, varicode_init);
 
     n_out = 0;
 
-    //printf("varicode_decode2: n_in: %d varicode_in[0] %d dec_states->n_in: %d\n", n_in, varicode_in[0], dec_states->n_in);
-    //printf("%d ", varicode_in[0]);
     while(n_in && (n_out < max_out)) {
+        c = *ascii_in++;
+        word = varicode_enc_word[1][c];
+        v_len = varicode_enc_len[1][c];
+        for(i=0; (i<v_len) && (n_out < max_out); i+=2) {
+            varicode_out[0] = (word >> (15 - i)) & 1;
+            varicode_out[1] = (word >> (14 - i)) & 1;
+            varicode_out += 2;
+            n_out += 2;
+        }
+        n_in--;
+    }
 
-        // keep two bit buffer so we can process two at a time
+    assert((n_out % 2) == 0);  /* outputs two bits at a time */
 
-        dec_states->in[0] = dec_states->in[1];
-        dec_states->in[1] = varicode_in[0];
-        dec_states->n_in++;
-        varicode_in++;
-        n_in--;
+    return n_out;
+}
 
-        if (dec_states->n_in == 2) {
-            output = decode_two_bits(dec_states, &single_ascii, dec_states->in[0], dec_states->in[1]);
 
-            dec_states->n_in = 0;
+int varicode_encode(short varicode_out[], char ascii_in[], int max_out, int n_in, int code_num) {
 
-            if (output) {
-                //printf("  output: %d single_ascii: 0x%x %c\n", output, (int)single_ascii, single_ascii);
-                *ascii_out++ = single_ascii;
-                n_out++;
-            }
-        }
+    assert((code_num ==1) || (code_num ==2));
+
+    if (code_num == 1)
+        return varicode_encode1(varicode_out, ascii_in, max_out, n_in);
+    else
+       return  varicode_encode2(varicode_out, ascii_in, max_out, n_in);
+}
+
+
+/*
+  As varicode_encode(), but bits are packed MSB first and each code
+  word is written whole.  A code word that does not fit in max_bits is
+  cut short.
+*/
+
+int varicode_encode_packed(unsigned char packed_out[], char ascii_in[], int max_bits, int n_in, int code_num) {
+    int            n_out, v_len, n_bytes, byte, i;
+    unsigned char  c;
+    uint32_t       acc;
+
+    assert((code_num ==1) || (code_num ==2));
+
+    pthread_once(&varicode_once, varicode_init);
+
+    n_bytes = (max_bits + 7)/8;
+    memset(packed_out, 0, n_bytes);
+
+    n_out = 0;
+    while(n_in && (n_out < max_bits)) {
+        c = *ascii_in++;
+        v_len = varicode_enc_len[code_num-1][c];
+        if (v_len > max_bits - n_out)
+            v_len = max_bits - n_out;
+
+        /* code word placed at its bit offset in a 24 bit window */
+
+        acc = ((uint32_t)varicode_enc_word[code_num-1][c] & ((0xffff << (16 - v_len)) & 0xffff)) << 8 >> (n_out & 7);
+        byte = n_out >> 3;
+        for(i=0; (i<3) && (byte+i < n_bytes); i++)
+            packed_out[byte+i] |= (acc >> (16 - 8*i)) & 0xff;
+
+        n_out += v_len;
+        n_in--;
     }
 
     return n_out;
 }
 
 
+void varicode_decode_init(struct VARICODE_DEC *dec_states, int code_num)
+{
+    assert((code_num ==1) || (code_num == 2));
+
+    pthread_once(&varicode_once, varicode_init);
+
+    dec_states->state = varicode_dfa_idle[code_num];
+    dec_states->code_num = code_num;
+}
+
+
+/* A partly received character is dropped when the code changes */
+
+void varicode_set_code_num(struct VARICODE_DEC *dec_states, int code_num)
+{
+    assert((code_num == 1) || (code_num == 2));
+    if (code_num != dec_states->code_num)
+        varicode_decode_init(dec_states, code_num);
+}
+
+
 int varicode_decode(struct VARICODE_DEC *dec_states, char ascii_out[], short varicode_in[], int max_out, int n_in) {
-    if (dec_states->code_num == 1)
-        return varicode_decode1(dec_states, ascii_out, varicode_in, max_out, n_in);
-    else
-        return varicode_decode2(dec_states, ascii_out, varicode_in, max_out, n_in);
+    int      n_out, state;
+    uint32_t e;
+
+    n_out = 0;
+    state = dec_states->state;
+
+    while(n_in && (n_out < max_out)) {
+        e = varicode_dfa_bit[state][varicode_in[0] != 0];
+        varicode_in++;
+        n_in--;
+
+        if (VARICODE_DFA_NOUT(e))
+            ascii_out[n_out++] = VARICODE_DFA_CHAR(e, 0);
+        state = VARICODE_DFA_NEXT(e);
+    }
+
+    dec_states->state = state;
+    return n_out;
+}
+
+
+/*
+  Decodes n_bits bits packed MSB first, a nibble per lookup.  Like
+  varicode_decode() it stops once max_out characters are out, bit by
+  bit when there is room for just one more.
+*/
+
+int varicode_decode_packed(struct VARICODE_DEC *dec_states, char ascii_out[], const unsigned char packed_in[], int max_out, int n_bits) {
+    int      n_out, state, i, k, nout;
+    uint32_t e;
+
+    n_out = 0;
+    state = dec_states->state;
+
+    i = 0;
+    while((i < n_bits) && (n_out < max_out)) {
+        if (((i & 3) == 0) && (i + 4 <= n_bits) && (max_out - n_out >= 2)) {
+            e = varicode_dfa_nibble[state][(packed_in[i >> 3] >> (4 - (i & 4))) & 0xf];
+            i += 4;
+        }
+        else {
+            e = varicode_dfa_bit[state][(packed_in[i >> 3] >> (7 - (i & 7))) & 1];
+            i++;
+        }
+        nout = VARICODE_DFA_NOUT(e);
+        for(k=0; k<nout; k++)
+            ascii_out[n_out++] = VARICODE_DFA_CHAR(e, k);
+        state = VARICODE_DFA_NEXT(e);
+    }
+
+    dec_states->state = state;
+    return n_out;
 }
 
 
@@ -31,18 +31,17 @@ extern "C" {
                                  /* 10 bits for code plus 2 0 bits for inter-character space */
 
 struct VARICODE_DEC {
-    int            state;
-    int            n_zeros;
-    int            v_len;
-    unsigned short packed;
+    int            state;           /* decoder state machine, see varicode.c */
     int            code_num;
-    int            n_in;
-    int            in[2];
 };
 
 int varicode_encode(short varicode_out[], char ascii_in[], int max_out, int n_in, int code_num);
 void varicode_decode_init(struct VARICODE_DEC *dec_states, int code_num);
 int varicode_decode(struct VARICODE_DEC *dec_states, char ascii_out[], short varicode_in[], int max_out, int n_in);
+
+/* Packed versions, bits MSB first.  packed_out[] must hold (max_bits+7)/8 bytes */
+int varicode_encode_packed(unsigned char packed_out[], char ascii_in[], int max_bits, int n_in, int code_num);
+int varicode_decode_packed(struct VARICODE_DEC *dec_states, char ascii_out[], const unsigned char packed_in[], int max_out, int n_bits);
 void varicode_set_code_num(struct VARICODE_DEC *dec_states, int code_num);
 
 #ifdef __cplusplus